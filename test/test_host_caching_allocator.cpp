@@ -0,0 +1,125 @@
+#include <thrust/detail/caching_allocator.h>
+#include <thrust/scan.h>
+#include <thrust/sort.h>
+#include <thrust/system/cpp/execution_policy.h>
+#include <thrust/system/cpp/vector.h>
+
+#include "test_header.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+typedef thrust::detail::host_caching_resource caching_resource;
+
+TEST(HostCachingAllocatorTests, TestHostCachingResource)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    caching_resource resource;
+
+    // blocks are reused within their size class
+    void * a1 = resource.do_allocate(1000, THRUST_MR_DEFAULT_ALIGNMENT);
+    resource.do_deallocate(a1, 1000, THRUST_MR_DEFAULT_ALIGNMENT);
+    ASSERT_GT(resource.cached_bytes(), 0u);
+
+    void * a2 = resource.do_allocate(1010, THRUST_MR_DEFAULT_ALIGNMENT);
+    ASSERT_EQ(a1, a2);
+    ASSERT_EQ(resource.cached_bytes(), 0u);
+
+    void * a3 = resource.do_allocate(4000, THRUST_MR_DEFAULT_ALIGNMENT);
+    ASSERT_NE(a2, a3);
+    resource.do_deallocate(a2, 1010, THRUST_MR_DEFAULT_ALIGNMENT);
+    resource.do_deallocate(a3, 4000, THRUST_MR_DEFAULT_ALIGNMENT);
+
+    // overaligned and oversized requests are not cached
+    std::size_t cached = resource.cached_bytes();
+    void * a4 = resource.do_allocate(64, 256);
+    ASSERT_EQ(reinterpret_cast<std::size_t>(a4) % 256, 0u);
+    resource.do_deallocate(a4, 64, 256);
+    void * a5 = resource.do_allocate(caching_resource::max_block_bytes + 1, THRUST_MR_DEFAULT_ALIGNMENT);
+    resource.do_deallocate(a5, caching_resource::max_block_bytes + 1, THRUST_MR_DEFAULT_ALIGNMENT);
+    ASSERT_EQ(resource.cached_bytes(), cached);
+
+    resource.release();
+    ASSERT_EQ(resource.cached_bytes(), 0u);
+}
+
+TEST(HostCachingAllocatorTests, TestHostCachingResourceLimits)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    caching_resource resource(10);
+    const std::size_t min_block_size = caching_resource::min_block_size;
+    const std::size_t max_cached_bytes = caching_resource::max_cached_bytes;
+    const std::size_t max_block_bytes = caching_resource::max_block_bytes;
+
+    // the memory unused during an interval is given back on deallocation too
+    std::size_t large = max_block_bytes / 2;
+    void * small1 = resource.do_allocate(100, THRUST_MR_DEFAULT_ALIGNMENT);
+    void * small2 = resource.do_allocate(100, THRUST_MR_DEFAULT_ALIGNMENT);
+    void * a1 = resource.do_allocate(large, THRUST_MR_DEFAULT_ALIGNMENT);
+    resource.do_deallocate(a1, large, THRUST_MR_DEFAULT_ALIGNMENT);
+    ASSERT_GE(resource.cached_bytes(), large);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    resource.do_deallocate(small1, 100, THRUST_MR_DEFAULT_ALIGNMENT);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    resource.do_deallocate(small2, 100, THRUST_MR_DEFAULT_ALIGNMENT);
+    ASSERT_EQ(resource.cached_bytes(), min_block_size);
+
+    // the cap applies while blocks are in use
+    std::vector<void *> blocks;
+    for (std::size_t cached = 0; cached <= max_cached_bytes; cached += max_block_bytes)
+    {
+        blocks.push_back(resource.do_allocate(max_block_bytes, THRUST_MR_DEFAULT_ALIGNMENT));
+    }
+    void * in_use = resource.do_allocate(100, THRUST_MR_DEFAULT_ALIGNMENT);
+    for (std::size_t i = 0; i < blocks.size(); ++i)
+    {
+        resource.do_deallocate(blocks[i], max_block_bytes, THRUST_MR_DEFAULT_ALIGNMENT);
+    }
+    ASSERT_LE(resource.cached_bytes(), max_cached_bytes);
+
+    resource.do_deallocate(in_use, 100, THRUST_MR_DEFAULT_ALIGNMENT);
+}
+
+TEST(HostCachingAllocatorTests, TestHostTemporaryBuffers)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    caching_resource & resource = thrust::detail::host_tls_caching_resource();
+    resource.release();
+
+    for (int iteration = 0; iteration < 2; ++iteration)
+    {
+        thrust::cpp::vector<int> keys(100000);
+        thrust::cpp::vector<int> values(100000);
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            keys[i] = static_cast<int>((i * 7919) % 1000);
+            values[i] = static_cast<int>(i);
+        }
+
+        thrust::stable_sort_by_key(thrust::cpp::par, keys.begin(), keys.end(), values.begin());
+        ASSERT_TRUE(thrust::is_sorted(keys.begin(), keys.end()));
+
+        thrust::cpp::vector<int> sums(keys.size());
+        thrust::inclusive_scan(thrust::cpp::par, keys.begin(), keys.end(), sums.begin());
+        ASSERT_EQ(sums[0], 0);
+
+#ifndef THRUST_HOST_NO_CACHING_TEMPORARY_ALLOCATOR
+        // the temporary buffers of the sort are kept by the thread's cache
+        ASSERT_GT(resource.cached_bytes(), 0u);
+#endif
+    }
+
+    // every thread has a cache of its own
+    std::size_t cached = resource.cached_bytes();
+    std::thread worker([] {
+        thrust::cpp::vector<int> data(100000, 1);
+        thrust::stable_sort(thrust::cpp::par, data.begin(), data.end());
+    });
+    worker.join();
+    ASSERT_EQ(resource.cached_bytes(), cached);
+}
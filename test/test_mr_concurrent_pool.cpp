@@ -0,0 +1,220 @@
+#include <thrust/mr/concurrent_pool.h>
+#include <thrust/mr/new.h>
+
+#include "test_header.hpp"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// counts the bytes held by the pool; the pool serializes its upstream calls
+class counting_resource final : public thrust::mr::memory_resource<>
+{
+public:
+    counting_resource() : allocations(0), deallocations(0), bytes_in_use(0)
+    {
+    }
+
+    ~counting_resource()
+    {
+        EXPECT_EQ(bytes_in_use, 0u);
+    }
+
+    virtual void * do_allocate(std::size_t n, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
+    {
+        ++allocations;
+        bytes_in_use += n;
+        return upstream.do_allocate(n, alignment);
+    }
+
+    virtual void do_deallocate(void * p, std::size_t n, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
+    {
+        ++deallocations;
+        bytes_in_use -= n;
+        upstream.do_deallocate(p, n, alignment);
+    }
+
+    std::size_t allocations;
+    std::size_t deallocations;
+    std::size_t bytes_in_use;
+
+private:
+    thrust::mr::new_delete_resource upstream;
+};
+
+typedef thrust::mr::concurrent_pool_resource<counting_resource> concurrent_pool;
+
+TEST(MrConcurrentPoolTests, TestConcurrentPool)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    counting_resource upstream;
+
+    {
+        concurrent_pool pool(&upstream);
+
+        // first allocation
+        void * a1 = pool.do_allocate(12, THRUST_MR_DEFAULT_ALIGNMENT);
+        ASSERT_EQ(upstream.allocations, 1u);
+
+        // due to chunking, the above allocation should be enough for the next one too
+        void * a2 = pool.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT);
+        ASSERT_EQ(upstream.allocations, 1u);
+        ASSERT_NE(a1, a2);
+
+        // deallocating and allocating back should give the same block back
+        pool.do_deallocate(a1, 12, THRUST_MR_DEFAULT_ALIGNMENT);
+        void * a3 = pool.do_allocate(12, THRUST_MR_DEFAULT_ALIGNMENT);
+        ASSERT_EQ(a1, a3);
+
+        // allocating over-aligned memory goes to upstream, and so does deallocating it
+        void * a4 = pool.do_allocate(32, THRUST_MR_DEFAULT_ALIGNMENT * 2);
+        ASSERT_EQ(upstream.allocations, 2u);
+        ASSERT_EQ(reinterpret_cast<std::size_t>(a4) % (THRUST_MR_DEFAULT_ALIGNMENT * 2), 0u);
+
+        pool.do_deallocate(a4, 32, THRUST_MR_DEFAULT_ALIGNMENT * 2);
+        ASSERT_EQ(upstream.deallocations, 1u);
+
+        // release returns everything, including the outstanding oversized blocks
+        void * a5 = pool.do_allocate(std::size_t(1) << 21, THRUST_MR_DEFAULT_ALIGNMENT);
+        ASSERT_NE(a5, static_cast<void *>(NULL));
+
+        pool.release();
+        ASSERT_EQ(upstream.bytes_in_use, 0u);
+
+        // and after that, new memory is allocated from upstream
+        std::size_t allocations = upstream.allocations;
+        void * a6 = pool.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT);
+        ASSERT_EQ(upstream.allocations, allocations + 1);
+        ASSERT_NE(a6, static_cast<void *>(NULL));
+    }
+
+    // destruction also returns memory
+    ASSERT_EQ(upstream.bytes_in_use, 0u);
+}
+
+TEST(MrConcurrentPoolTests, TestConcurrentPoolThreads)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    counting_resource upstream;
+    concurrent_pool pool(&upstream);
+
+    const std::size_t num_threads = 8;
+    const std::size_t num_blocks = 2000;
+
+    // every thread frees the blocks allocated by its neighbour, so that blocks
+    // travel between the threads through the depot
+    std::vector<std::vector<unsigned char *> > blocks(num_threads);
+    std::vector<std::thread> threads;
+    std::vector<int> failures(num_threads, 0);
+
+    for (std::size_t t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&, t]
+        {
+            for (std::size_t i = 0; i < num_blocks; ++i)
+            {
+                std::size_t size = 8 + (i * 37 + t * 11) % 3000;
+                unsigned char * p = static_cast<unsigned char *>(pool.do_allocate(size, THRUST_MR_DEFAULT_ALIGNMENT));
+                std::memset(p, static_cast<int>(t), size);
+                blocks[t].push_back(p);
+            }
+
+            for (std::size_t i = 0; i < num_blocks; ++i)
+            {
+                std::size_t size = 8 + (i * 37 + t * 11) % 3000;
+                for (std::size_t j = 0; j < size; ++j)
+                {
+                    if (blocks[t][i][j] != static_cast<unsigned char>(t))
+                    {
+                        ++failures[t];
+                        break;
+                    }
+                }
+            }
+        });
+    }
+
+    for (std::size_t t = 0; t < num_threads; ++t)
+    {
+        threads[t].join();
+    }
+
+    threads.clear();
+
+    for (std::size_t t = 0; t < num_threads; ++t)
+    {
+        ASSERT_EQ(failures[t], 0);
+    }
+
+    for (std::size_t t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&, t]
+        {
+            std::size_t owner = (t + 1) % num_threads;
+            for (std::size_t i = 0; i < num_blocks; ++i)
+            {
+                std::size_t size = 8 + (i * 37 + owner * 11) % 3000;
+                pool.do_deallocate(blocks[owner][i], size, THRUST_MR_DEFAULT_ALIGNMENT);
+            }
+        });
+    }
+
+    for (std::size_t t = 0; t < num_threads; ++t)
+    {
+        threads[t].join();
+    }
+
+    // every block is free and every thread which cached blocks has exited,
+    // so all the memory has been returned to upstream
+    ASSERT_EQ(upstream.bytes_in_use, 0u);
+}
+
+TEST(MrConcurrentPoolTests, TestConcurrentPoolThreadExit)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    counting_resource upstream;
+    concurrent_pool pool(&upstream);
+
+    void * kept = pool.do_allocate(64, THRUST_MR_DEFAULT_ALIGNMENT);
+
+    std::thread thread([&]
+    {
+        std::vector<void *> ptrs;
+        for (std::size_t i = 0; i < 1000; ++i)
+        {
+            ptrs.push_back(pool.do_allocate(64, THRUST_MR_DEFAULT_ALIGNMENT));
+        }
+        for (std::size_t i = 0; i < ptrs.size(); ++i)
+        {
+            pool.do_deallocate(ptrs[i], 64, THRUST_MR_DEFAULT_ALIGNMENT);
+        }
+    });
+    thread.join();
+
+    // only the chunk holding the block still in use by this thread is kept
+    std::size_t chunk_bytes = upstream.bytes_in_use;
+    ASSERT_GT(chunk_bytes, 0u);
+    ASSERT_LT(chunk_bytes, 1000u * 64u);
+
+    // the blocks freed by the exited thread are reused
+    std::size_t allocations = upstream.allocations;
+    void * p = pool.do_allocate(64, THRUST_MR_DEFAULT_ALIGNMENT);
+    ASSERT_EQ(upstream.allocations, allocations);
+
+    pool.do_deallocate(p, 64, THRUST_MR_DEFAULT_ALIGNMENT);
+    pool.do_deallocate(kept, 64, THRUST_MR_DEFAULT_ALIGNMENT);
+}
+
+TEST(MrConcurrentPoolTests, TestConcurrentGlobalPool)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    typedef thrust::mr::concurrent_pool_resource<
+        thrust::mr::new_delete_resource
+    > Pool;
+
+    ASSERT_EQ(thrust::mr::get_global_resource<Pool>() != NULL, true);
+}
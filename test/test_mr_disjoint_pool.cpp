@@ -1,9 +1,15 @@
 #include <thrust/mr/disjoint_pool.h>
 #include <thrust/mr/disjoint_sync_pool.h>
 #include <thrust/mr/new.h>
+#include <thrust/mr/statistics_resource.h>
 
 #include "test_header.hpp"
 
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
 
 struct alloc_id
 {
@@ -265,6 +271,279 @@ TEST(MrDisjointPoolTests, TestDisjointSynchronizedPoolCachingOversized)
     TestDisjointPoolCachingOversized<thrust::mr::disjoint_synchronized_pool_resource>();
 }
 
+template<template<typename, typename> class PoolTemplate>
+void TestDisjointPoolManyOversized()
+{
+    dummy_resource upstream;
+    thrust::mr::new_delete_resource bookkeeper;
+
+    typedef PoolTemplate<
+        dummy_resource,
+        thrust::mr::new_delete_resource
+    > Pool;
+
+    thrust::mr::pool_options opts = Pool::get_default_options();
+    opts.cache_oversized = true;
+    opts.largest_block_size = 1024;
+
+    const std::size_t n = 500;
+
+    {
+        Pool pool(&upstream, &bookkeeper, opts);
+
+        std::vector<alloc_id> blocks;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            upstream.id_to_allocate = i + 1;
+            blocks.push_back(pool.do_allocate(2048 + 64 * i, 32));
+            ASSERT_EQ(blocks.back().id, i + 1);
+        }
+
+        // return them to the cache in a scrambled order
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            std::size_t j = (i * 7) % n;
+            pool.do_deallocate(blocks[j], 2048 + 64 * j, 32);
+        }
+
+        // every request is served by the cached block fitting it best
+        for (std::size_t i = n; i-- > 0;)
+        {
+            alloc_id a = pool.do_allocate(2000 + 64 * i, 32);
+            ASSERT_EQ(a.id, i + 1);
+        }
+
+        ASSERT_EQ(upstream.id_to_allocate, 0u);
+    }
+
+    opts.cache_oversized = false;
+
+    {
+        Pool pool(&upstream, &bookkeeper, opts);
+
+        std::vector<alloc_id> blocks;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            upstream.id_to_allocate = i + 1;
+            blocks.push_back(pool.do_allocate(2048 + 64 * i, 64));
+        }
+
+        // without caching, every block goes straight back to upstream
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            std::size_t j = (i * 7) % n;
+            upstream.id_to_deallocate = j + 1;
+            pool.do_deallocate(blocks[j], 2048 + 64 * j, 64);
+            ASSERT_EQ(upstream.id_to_deallocate, 0u);
+        }
+    }
+}
+
+TEST(MrDisjointPoolTests, TestDisjointUnsynchronizedPoolManyOversized)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestDisjointPoolManyOversized<thrust::mr::disjoint_unsynchronized_pool_resource>();
+}
+
+TEST(MrDisjointPoolTests, TestDisjointSynchronizedPoolManyOversized)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestDisjointPoolManyOversized<thrust::mr::disjoint_synchronized_pool_resource>();
+}
+
+typedef thrust::mr::statistics_resource<thrust::mr::new_delete_resource> counted_resource;
+
+template<template<typename, typename> class PoolTemplate>
+void TestDisjointPoolTrim()
+{
+    typedef PoolTemplate<
+        counted_resource,
+        thrust::mr::new_delete_resource
+    > Pool;
+
+    counted_resource upstream;
+    thrust::mr::new_delete_resource bookkeeper;
+
+    {
+        Pool pool(&upstream, &bookkeeper);
+
+        // fill several chunks of one size class and one chunk of another, and
+        // cache an oversized block
+        std::vector<void *> blocks;
+        for (std::size_t i = 0; i < 1000; ++i)
+        {
+            blocks.push_back(pool.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT));
+        }
+        void * kept = pool.do_allocate(256, THRUST_MR_DEFAULT_ALIGNMENT);
+
+        void * oversized = pool.do_allocate(std::size_t(1) << 21, THRUST_MR_DEFAULT_ALIGNMENT);
+        pool.do_deallocate(oversized, std::size_t(1) << 21, THRUST_MR_DEFAULT_ALIGNMENT);
+
+        // only the cached block is free
+        std::size_t full = upstream.statistics().bytes_in_use;
+        std::size_t released = pool.trim();
+        ASSERT_EQ(released, std::size_t(1) << 21);
+        ASSERT_EQ(upstream.statistics().bytes_in_use, full - released);
+
+        // free the blocks in a scrambled order
+        for (std::size_t i = 0; i < blocks.size(); ++i)
+        {
+            std::size_t j = (i * 7) % blocks.size();
+            pool.do_deallocate(blocks[j], 16, THRUST_MR_DEFAULT_ALIGNMENT);
+        }
+
+        // trimming stops as soon as the target is met
+        std::size_t before = upstream.statistics().bytes_in_use;
+        released = pool.trim(before - 1);
+        ASSERT_GT(released, 0u);
+        ASSERT_LT(released, before - 1024);
+
+        // and otherwise returns every fully free chunk
+        released = pool.trim();
+        ASSERT_GT(released, 0u);
+
+        thrust::mr::pool_statistics stats = pool.statistics();
+        ASSERT_EQ(stats.upstream_allocations - stats.upstream_deallocations, 1u);
+        ASSERT_EQ(stats.upstream_bytes, upstream.statistics().bytes_in_use);
+
+        // the pool remains usable, and the block in use is untouched
+        std::memset(kept, 1, 256);
+        void * a = pool.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT);
+        std::memset(a, 2, 16);
+        ASSERT_EQ(static_cast<unsigned char *>(kept)[255], 1);
+
+        pool.do_deallocate(a, 16, THRUST_MR_DEFAULT_ALIGNMENT);
+        pool.do_deallocate(kept, 256, THRUST_MR_DEFAULT_ALIGNMENT);
+    }
+
+    ASSERT_EQ(upstream.statistics().bytes_in_use, 0u);
+}
+
+TEST(MrDisjointPoolTests, TestDisjointUnsynchronizedPoolTrim)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestDisjointPoolTrim<thrust::mr::disjoint_unsynchronized_pool_resource>();
+}
+
+TEST(MrDisjointPoolTests, TestDisjointSynchronizedPoolTrim)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestDisjointPoolTrim<thrust::mr::disjoint_synchronized_pool_resource>();
+}
+
+template<template<typename, typename> class PoolTemplate>
+void TestDisjointPoolCaps()
+{
+    typedef PoolTemplate<
+        counted_resource,
+        thrust::mr::new_delete_resource
+    > Pool;
+
+    counted_resource upstream;
+    thrust::mr::new_delete_resource bookkeeper;
+
+    thrust::mr::pool_options opts = Pool::get_default_options();
+    opts.soft_cap_bytes = 4 * 1024;
+    opts.hard_cap_bytes = 8 * 1024;
+
+    Pool pool(&upstream, &bookkeeper, opts);
+
+    std::vector<unsigned int *> blocks;
+    for (unsigned int i = 0; i < 1000; ++i)
+    {
+        blocks.push_back(static_cast<unsigned int *>(pool.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT)));
+        *blocks.back() = i;
+    }
+
+    // the pool stays under the hard cap, and serves the rest from upstream
+    thrust::mr::pool_statistics stats = pool.statistics();
+    ASSERT_GT(stats.fallback_allocations, 0u);
+    ASSERT_GT(stats.fallback_bytes, 0u);
+    ASSERT_LE(stats.upstream_bytes - stats.fallback_bytes, opts.hard_cap_bytes);
+
+    for (unsigned int i = 0; i < blocks.size(); ++i)
+    {
+        ASSERT_EQ(*blocks[i], i);
+        pool.do_deallocate(blocks[i], 16, THRUST_MR_DEFAULT_ALIGNMENT);
+    }
+
+    // once the memory is free, the pool trims itself under the soft cap
+    stats = pool.statistics();
+    ASSERT_EQ(stats.fallback_bytes, 0u);
+    ASSERT_LE(stats.upstream_bytes, opts.soft_cap_bytes);
+}
+
+TEST(MrDisjointPoolTests, TestDisjointUnsynchronizedPoolCaps)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestDisjointPoolCaps<thrust::mr::disjoint_unsynchronized_pool_resource>();
+}
+
+TEST(MrDisjointPoolTests, TestDisjointSynchronizedPoolCaps)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestDisjointPoolCaps<thrust::mr::disjoint_synchronized_pool_resource>();
+}
+
+template<template<typename, typename> class PoolTemplate>
+void TestDisjointPoolDecay()
+{
+    typedef PoolTemplate<
+        counted_resource,
+        thrust::mr::new_delete_resource
+    > Pool;
+
+    counted_resource upstream;
+    thrust::mr::new_delete_resource bookkeeper;
+
+    thrust::mr::pool_options opts = Pool::get_default_options();
+    opts.decay_interval_ms = 1;
+
+    Pool pool(&upstream, &bookkeeper, opts);
+
+    std::vector<void *> blocks;
+    for (std::size_t i = 0; i < 1000; ++i)
+    {
+        blocks.push_back(pool.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT));
+    }
+    for (std::size_t i = 0; i < blocks.size(); ++i)
+    {
+        pool.do_deallocate(blocks[i], 16, THRUST_MR_DEFAULT_ALIGNMENT);
+    }
+
+    std::size_t peak = pool.statistics().upstream_bytes;
+
+    // after two idle intervals, the memory of the burst has been returned
+    for (int i = 0; i < 2; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        void * p = pool.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT);
+        pool.do_deallocate(p, 16, THRUST_MR_DEFAULT_ALIGNMENT);
+    }
+
+    ASSERT_LT(pool.statistics().upstream_bytes, peak / 4);
+}
+
+TEST(MrDisjointPoolTests, TestDisjointUnsynchronizedPoolDecay)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestDisjointPoolDecay<thrust::mr::disjoint_unsynchronized_pool_resource>();
+}
+
+TEST(MrDisjointPoolTests, TestDisjointSynchronizedPoolDecay)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestDisjointPoolDecay<thrust::mr::disjoint_synchronized_pool_resource>();
+}
+
 template<template<typename, typename> class PoolTemplate>
 void TestDisjointGlobalPool()
 {
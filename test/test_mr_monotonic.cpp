@@ -0,0 +1,198 @@
+#include <thrust/mr/monotonic.h>
+#include <thrust/mr/new.h>
+#include <thrust/host_vector.h>
+#include <thrust/reduce.h>
+#include <thrust/sort.h>
+#include <thrust/system/cpp/execution_policy.h>
+
+#include "test_header.hpp"
+
+class counting_resource final : public thrust::mr::memory_resource<>
+{
+public:
+    counting_resource() : allocations(0), deallocations(0), bytes_in_use(0)
+    {
+    }
+
+    ~counting_resource()
+    {
+        EXPECT_EQ(bytes_in_use, 0u);
+    }
+
+    virtual void * do_allocate(std::size_t n, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
+    {
+        ++allocations;
+        bytes_in_use += n;
+        return upstream.do_allocate(n, alignment);
+    }
+
+    virtual void do_deallocate(void * p, std::size_t n, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
+    {
+        ++deallocations;
+        bytes_in_use -= n;
+        upstream.do_deallocate(p, n, alignment);
+    }
+
+    std::size_t allocations;
+    std::size_t deallocations;
+    std::size_t bytes_in_use;
+
+private:
+    thrust::mr::new_delete_resource upstream;
+};
+
+typedef thrust::mr::monotonic_buffer_resource<counting_resource> arena;
+
+TEST(MrMonotonicTests, TestMonotonicBuffer)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    counting_resource upstream;
+
+    {
+        arena resource(&upstream);
+        ASSERT_EQ(upstream.allocations, 0u);
+
+        // allocations are consecutive and aligned
+        char * a1 = static_cast<char *>(resource.do_allocate(3, 1));
+        char * a2 = static_cast<char *>(resource.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT));
+        ASSERT_EQ(upstream.allocations, 1u);
+        ASSERT_EQ(reinterpret_cast<std::size_t>(a1) % THRUST_MR_DEFAULT_ALIGNMENT, 0u);
+        ASSERT_EQ(a2, a1 + THRUST_MR_DEFAULT_ALIGNMENT);
+
+        char * a3 = static_cast<char *>(resource.do_allocate(8, 256));
+        ASSERT_EQ(reinterpret_cast<std::size_t>(a3) % 256, 0u);
+
+        // the most recent allocation is given back, and the others are not
+        resource.do_deallocate(a3, 8, 256);
+        char * a4 = static_cast<char *>(resource.do_allocate(8, 256));
+        ASSERT_EQ(a3, a4);
+
+        resource.do_deallocate(a1, 3, 1);
+        char * a5 = static_cast<char *>(resource.do_allocate(3, 1));
+        ASSERT_NE(a1, a5);
+
+        // requests larger than a chunk get a chunk of their own
+        void * a6 = resource.do_allocate(arena::default_initial_size * 3, THRUST_MR_DEFAULT_ALIGNMENT);
+        ASSERT_NE(a6, static_cast<void *>(NULL));
+        ASSERT_EQ(upstream.allocations, 2u);
+        ASSERT_GE(resource.capacity(), arena::default_initial_size * 4);
+
+        resource.release();
+        ASSERT_EQ(upstream.bytes_in_use, 0u);
+        ASSERT_EQ(resource.capacity(), 0u);
+
+        void * a7 = resource.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT);
+        ASSERT_NE(a7, static_cast<void *>(NULL));
+        ASSERT_EQ(upstream.allocations, 3u);
+    }
+
+    // destruction returns the chunks
+    ASSERT_EQ(upstream.bytes_in_use, 0u);
+}
+
+TEST(MrMonotonicTests, TestMonotonicBufferRewind)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    counting_resource upstream;
+    arena resource(1024, &upstream);
+    ASSERT_EQ(upstream.allocations, 1u);
+
+    void * kept = resource.do_allocate(100, THRUST_MR_DEFAULT_ALIGNMENT);
+    arena::marker m = resource.position();
+    std::size_t used = resource.bytes_used();
+
+    // overflow the first chunk
+    void * first = resource.do_allocate(500, THRUST_MR_DEFAULT_ALIGNMENT);
+    for (int i = 0; i < 8; ++i)
+    {
+        (void)resource.do_allocate(500, THRUST_MR_DEFAULT_ALIGNMENT);
+    }
+    std::size_t allocations = upstream.allocations;
+    ASSERT_GT(allocations, 1u);
+
+    // rewinding returns everything allocated since the marker, and the same
+    // sequence of allocations then reuses the chunks
+    resource.rewind(m);
+    ASSERT_EQ(resource.bytes_used(), used);
+
+    ASSERT_EQ(resource.do_allocate(500, THRUST_MR_DEFAULT_ALIGNMENT), first);
+    for (int i = 0; i < 8; ++i)
+    {
+        (void)resource.do_allocate(500, THRUST_MR_DEFAULT_ALIGNMENT);
+    }
+    ASSERT_EQ(upstream.allocations, allocations);
+
+    // the memory allocated before the marker is untouched
+    ASSERT_LT(static_cast<char *>(kept), static_cast<char *>(first));
+
+    // reset replaces the chunks by a single one holding all of them
+    std::size_t capacity = resource.capacity();
+    resource.reset();
+    ASSERT_EQ(resource.bytes_used(), 0u);
+    ASSERT_EQ(resource.capacity(), capacity);
+    ASSERT_EQ(upstream.allocations, allocations + 1);
+    ASSERT_EQ(upstream.deallocations, allocations);
+
+    allocations = upstream.allocations;
+    (void)resource.do_allocate(100, THRUST_MR_DEFAULT_ALIGNMENT);
+    for (int i = 0; i < 9; ++i)
+    {
+        (void)resource.do_allocate(500, THRUST_MR_DEFAULT_ALIGNMENT);
+    }
+    ASSERT_EQ(upstream.allocations, allocations);
+}
+
+TEST(MrMonotonicTests, TestMonotonicBufferPolicy)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    counting_resource upstream;
+    arena resource(&upstream);
+
+    std::size_t allocations = 0;
+
+    for (int iteration = 0; iteration < 4; ++iteration)
+    {
+        thrust::host_vector<int> keys(10000);
+        thrust::host_vector<int> values(10000);
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            keys[i] = static_cast<int>((i * 7919) % 100);
+            values[i] = 1;
+        }
+
+        thrust::stable_sort_by_key(thrust::cpp::par(&resource), keys.begin(), keys.end(), values.begin());
+
+        thrust::host_vector<int> unique_keys(100);
+        thrust::host_vector<int> counts(100);
+        thrust::reduce_by_key(thrust::cpp::par(&resource),
+                              keys.begin(), keys.end(), values.begin(),
+                              unique_keys.begin(), counts.begin());
+
+        for (int k = 0; k < 100; ++k)
+        {
+            ASSERT_EQ(unique_keys[k], k);
+            ASSERT_EQ(counts[k], 100);
+        }
+
+        resource.reset();
+
+        // the temporary storage comes from the arena, and after the first
+        // iteration, it holds enough memory for the whole workload, so that
+        // upstream is not called anymore
+        if (iteration == 0)
+        {
+            ASSERT_GT(upstream.allocations, 0u);
+        }
+        else if (iteration == 1)
+        {
+            allocations = upstream.allocations;
+        }
+        else if (iteration > 1)
+        {
+            ASSERT_EQ(upstream.allocations, allocations);
+        }
+    }
+}
@@ -1,10 +1,16 @@
 #include <thrust/mr/pool.h>
 #include <thrust/mr/sync_pool.h>
 #include <thrust/mr/new.h>
+#include <thrust/mr/statistics_resource.h>
 
 
 #include "test_header.hpp"
 
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
 template<typename T>
 struct reference
 {
@@ -331,6 +337,186 @@ TEST(MrPoolTests, TestSynchronizedPoolCachingOversized)
     TestPoolCachingOversized<thrust::mr::synchronized_pool_resource>();
 }
 
+typedef thrust::mr::statistics_resource<thrust::mr::new_delete_resource> counted_resource;
+
+template<template<typename> class PoolTemplate>
+void TestPoolTrim()
+{
+    typedef PoolTemplate<counted_resource> Pool;
+
+    counted_resource upstream;
+
+    {
+        Pool pool(&upstream);
+
+        // the memory the pool allocated for itself on construction
+        const std::size_t baseline = upstream.statistics().bytes_in_use;
+
+        // fill several chunks of one size class and one chunk of another, and
+        // cache an oversized block
+        std::vector<void *> blocks;
+        for (std::size_t i = 0; i < 1000; ++i)
+        {
+            blocks.push_back(pool.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT));
+        }
+        void * kept = pool.do_allocate(256, THRUST_MR_DEFAULT_ALIGNMENT);
+
+        void * oversized = pool.do_allocate(std::size_t(1) << 21, THRUST_MR_DEFAULT_ALIGNMENT);
+        pool.do_deallocate(oversized, std::size_t(1) << 21, THRUST_MR_DEFAULT_ALIGNMENT);
+
+        // only the cached block is free
+        std::size_t full = upstream.statistics().bytes_in_use;
+        std::size_t released = pool.trim();
+        ASSERT_GE(released, std::size_t(1) << 21);
+        ASSERT_EQ(upstream.statistics().bytes_in_use, full - released);
+
+        for (std::size_t i = 0; i < blocks.size(); ++i)
+        {
+            pool.do_deallocate(blocks[i], 16, THRUST_MR_DEFAULT_ALIGNMENT);
+        }
+
+        // trimming stops as soon as the target is met
+        std::size_t before = upstream.statistics().bytes_in_use;
+        released = pool.trim(before - baseline - 1);
+        ASSERT_GT(released, 0u);
+        ASSERT_LT(released, before - baseline - 1024);
+
+        // and otherwise returns every fully free chunk
+        released = pool.trim();
+        ASSERT_GT(released, 0u);
+
+        thrust::mr::pool_statistics stats = pool.statistics();
+        ASSERT_EQ(stats.upstream_allocations - stats.upstream_deallocations, 1u);
+        ASSERT_EQ(stats.upstream_bytes, upstream.statistics().bytes_in_use - baseline);
+
+        // the pool remains usable, and the block in use is untouched
+        std::memset(kept, 1, 256);
+        void * a = pool.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT);
+        std::memset(a, 2, 16);
+        ASSERT_EQ(static_cast<unsigned char *>(kept)[255], 1);
+
+        pool.do_deallocate(a, 16, THRUST_MR_DEFAULT_ALIGNMENT);
+        pool.do_deallocate(kept, 256, THRUST_MR_DEFAULT_ALIGNMENT);
+    }
+
+    ASSERT_EQ(upstream.statistics().bytes_in_use, 0u);
+}
+
+TEST(MrPoolTests, TestUnsynchronizedPoolTrim)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestPoolTrim<thrust::mr::unsynchronized_pool_resource>();
+}
+
+TEST(MrPoolTests, TestSynchronizedPoolTrim)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestPoolTrim<thrust::mr::synchronized_pool_resource>();
+}
+
+template<template<typename> class PoolTemplate>
+void TestPoolCaps()
+{
+    typedef PoolTemplate<counted_resource> Pool;
+
+    counted_resource upstream;
+
+    thrust::mr::pool_options opts = Pool::get_default_options();
+    opts.soft_cap_bytes = 8 * 1024;
+    opts.hard_cap_bytes = 16 * 1024;
+
+    Pool pool(&upstream, opts);
+
+    std::vector<unsigned int *> blocks;
+    for (unsigned int i = 0; i < 1000; ++i)
+    {
+        blocks.push_back(static_cast<unsigned int *>(pool.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT)));
+        *blocks.back() = i;
+    }
+
+    // the pool stays under the hard cap, and serves the rest from upstream
+    thrust::mr::pool_statistics stats = pool.statistics();
+    ASSERT_GT(stats.fallback_allocations, 0u);
+    ASSERT_GT(stats.fallback_bytes, 0u);
+    ASSERT_LE(stats.upstream_bytes - stats.fallback_bytes, opts.hard_cap_bytes);
+
+    for (unsigned int i = 0; i < blocks.size(); ++i)
+    {
+        ASSERT_EQ(*blocks[i], i);
+        pool.do_deallocate(blocks[i], 16, THRUST_MR_DEFAULT_ALIGNMENT);
+    }
+
+    // once the memory is free, the pool trims itself under the soft cap
+    stats = pool.statistics();
+    ASSERT_EQ(stats.fallback_bytes, 0u);
+    ASSERT_LE(stats.upstream_bytes, opts.soft_cap_bytes);
+}
+
+TEST(MrPoolTests, TestUnsynchronizedPoolCaps)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestPoolCaps<thrust::mr::unsynchronized_pool_resource>();
+}
+
+TEST(MrPoolTests, TestSynchronizedPoolCaps)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestPoolCaps<thrust::mr::synchronized_pool_resource>();
+}
+
+template<template<typename> class PoolTemplate>
+void TestPoolDecay()
+{
+    typedef PoolTemplate<counted_resource> Pool;
+
+    counted_resource upstream;
+
+    thrust::mr::pool_options opts = Pool::get_default_options();
+    opts.decay_interval_ms = 1;
+
+    Pool pool(&upstream, opts);
+
+    std::vector<void *> blocks;
+    for (std::size_t i = 0; i < 1000; ++i)
+    {
+        blocks.push_back(pool.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT));
+    }
+    for (std::size_t i = 0; i < blocks.size(); ++i)
+    {
+        pool.do_deallocate(blocks[i], 16, THRUST_MR_DEFAULT_ALIGNMENT);
+    }
+
+    std::size_t peak = pool.statistics().upstream_bytes;
+
+    // after two idle intervals, the memory of the burst has been returned
+    for (int i = 0; i < 2; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        void * p = pool.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT);
+        pool.do_deallocate(p, 16, THRUST_MR_DEFAULT_ALIGNMENT);
+    }
+
+    ASSERT_LT(pool.statistics().upstream_bytes, peak / 4);
+}
+
+TEST(MrPoolTests, TestUnsynchronizedPoolDecay)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestPoolDecay<thrust::mr::unsynchronized_pool_resource>();
+}
+
+TEST(MrPoolTests, TestSynchronizedPoolDecay)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestPoolDecay<thrust::mr::synchronized_pool_resource>();
+}
+
 template<template<typename> class PoolTemplate>
 void TestGlobalPool()
 {
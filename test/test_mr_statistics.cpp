@@ -0,0 +1,125 @@
+#include <thrust/mr/statistics_resource.h>
+#include <thrust/mr/pool.h>
+#include <thrust/mr/disjoint_pool.h>
+#include <thrust/mr/new.h>
+
+#include "test_header.hpp"
+
+#include <string>
+
+typedef thrust::mr::statistics_resource<thrust::mr::new_delete_resource> counted_resource;
+
+TEST(MrStatisticsTests, TestStatisticsResource)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    counted_resource resource;
+
+    void * a1 = resource.do_allocate(100, THRUST_MR_DEFAULT_ALIGNMENT);
+    void * a2 = resource.do_allocate(300, THRUST_MR_DEFAULT_ALIGNMENT);
+    resource.do_deallocate(a1, 100, THRUST_MR_DEFAULT_ALIGNMENT);
+    void * a3 = resource.do_allocate(50, THRUST_MR_DEFAULT_ALIGNMENT);
+
+    thrust::mr::resource_statistics stats = resource.statistics();
+    ASSERT_EQ(stats.allocations, 3u);
+    ASSERT_EQ(stats.deallocations, 1u);
+    ASSERT_EQ(stats.bytes_allocated, 450u);
+    ASSERT_EQ(stats.bytes_in_use, 350u);
+    ASSERT_EQ(stats.peak_bytes_in_use, 400u);
+    ASSERT_EQ(stats.largest_allocation, 300u);
+
+    resource.reset_peak();
+    ASSERT_EQ(resource.statistics().peak_bytes_in_use, 350u);
+
+    resource.do_deallocate(a2, 300, THRUST_MR_DEFAULT_ALIGNMENT);
+    resource.do_deallocate(a3, 50, THRUST_MR_DEFAULT_ALIGNMENT);
+    ASSERT_EQ(resource.statistics().bytes_in_use, 0u);
+
+    std::string json = thrust::mr::to_json(resource.statistics());
+    ASSERT_EQ(json.find("\"allocations\":3"), 1u);
+    ASSERT_NE(json.find("\"peak_bytes_in_use\":350"), std::string::npos);
+}
+
+template<typename Pool>
+void TestPoolStatistics(Pool & pool, counted_resource & upstream)
+{
+    // the memory the pool allocated for itself on construction
+    const std::size_t baseline = upstream.statistics().bytes_in_use;
+
+    // the first allocation of a size class misses, the following ones hit
+    void * a1 = pool.do_allocate(12, THRUST_MR_DEFAULT_ALIGNMENT);
+    void * a2 = pool.do_allocate(16, THRUST_MR_DEFAULT_ALIGNMENT);
+
+    thrust::mr::pool_statistics stats = pool.statistics();
+    ASSERT_EQ(stats.size_classes[0].block_size, 16u);
+    ASSERT_EQ(stats.size_classes[0].misses, 1u);
+    ASSERT_EQ(stats.size_classes[0].hits, 1u);
+    ASSERT_EQ(stats.bytes_in_use, 32u);
+    ASSERT_EQ(stats.upstream_allocations, 1u);
+
+    // the pool and the resource under it agree on what the pool holds
+    ASSERT_EQ(stats.upstream_bytes, upstream.statistics().bytes_in_use - baseline);
+
+    pool.do_deallocate(a1, 12, THRUST_MR_DEFAULT_ALIGNMENT);
+    pool.do_deallocate(a2, 16, THRUST_MR_DEFAULT_ALIGNMENT);
+
+    ASSERT_EQ(pool.statistics().bytes_in_use, 0u);
+    ASSERT_EQ(pool.statistics().peak_bytes_in_use, 32u);
+
+    // oversized blocks miss the cache once, and then hit it
+    void * a3 = pool.do_allocate(4096, THRUST_MR_DEFAULT_ALIGNMENT);
+    pool.do_deallocate(a3, 4096, THRUST_MR_DEFAULT_ALIGNMENT);
+    void * a4 = pool.do_allocate(4000, THRUST_MR_DEFAULT_ALIGNMENT);
+
+    stats = pool.statistics();
+    ASSERT_EQ(stats.oversized_misses, 1u);
+    ASSERT_EQ(stats.oversized_hits, 1u);
+    ASSERT_EQ(stats.oversized_hit_rate(), 0.5);
+    ASSERT_EQ(stats.bytes_in_use, 4096u);
+    ASSERT_EQ(stats.upstream_allocations, 2u);
+    ASSERT_EQ(stats.upstream_bytes, upstream.statistics().bytes_in_use - baseline);
+
+    pool.do_deallocate(a4, 4000, THRUST_MR_DEFAULT_ALIGNMENT);
+
+    // release returns everything, and the cumulative counts survive it
+    pool.release();
+
+    stats = pool.statistics();
+    ASSERT_EQ(stats.upstream_bytes, 0u);
+    ASSERT_EQ(stats.upstream_deallocations, 2u);
+    ASSERT_EQ(stats.size_classes[0].misses, 1u);
+    ASSERT_EQ(upstream.statistics().bytes_in_use, baseline);
+
+    std::string json = thrust::mr::to_json(stats);
+    ASSERT_NE(json.find("\"oversized_hit_rate\":0.5"), std::string::npos);
+    ASSERT_NE(json.find("{\"block_size\":16,\"hits\":1,\"misses\":1}"), std::string::npos);
+}
+
+TEST(MrStatisticsTests, TestUnsynchronizedPoolStatistics)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    counted_resource upstream;
+
+    thrust::mr::pool_options opts = thrust::mr::unsynchronized_pool_resource<counted_resource>::get_default_options();
+    opts.largest_block_size = 1024;
+
+    thrust::mr::unsynchronized_pool_resource<counted_resource> pool(&upstream, opts);
+    TestPoolStatistics(pool, upstream);
+}
+
+TEST(MrStatisticsTests, TestDisjointUnsynchronizedPoolStatistics)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    counted_resource upstream;
+    thrust::mr::new_delete_resource bookkeeper;
+
+    typedef thrust::mr::disjoint_unsynchronized_pool_resource<counted_resource, thrust::mr::new_delete_resource> Pool;
+
+    thrust::mr::pool_options opts = Pool::get_default_options();
+    opts.largest_block_size = 1024;
+
+    Pool pool(&upstream, &bookkeeper, opts);
+    TestPoolStatistics(pool, upstream);
+}
@@ -762,3 +762,55 @@ TEST(ScanTests, TestInclusiveScanWithUserDefinedType)
 
     ASSERT_EQ(static_cast<Int>(vec.back()).i, 5);
 }
+
+TEST(ScanTests, TestScanHostTiles)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    using T = int;
+
+    for(auto size : get_host_tile_sizes())
+    {
+        SCOPED_TRACE(testing::Message() << "with size= " << size);
+
+        for(auto seed : get_seeds())
+        {
+            SCOPED_TRACE(testing::Message() << "with seed= " << seed);
+
+            thrust::host_vector<T> h_input = get_random_data<T>(size, -100, 100, seed);
+
+            std::vector<T> inclusive(size);
+            std::vector<T> exclusive(size);
+            std::vector<T> maximums(size);
+            T sum = 13;
+            T max = std::numeric_limits<T>::min();
+            for(size_t i = 0; i < size; i++)
+            {
+                exclusive[i] = sum;
+                sum += h_input[i];
+                inclusive[i] = sum - 13;
+                max = std::max(max, h_input[i]);
+                maximums[i] = max;
+            }
+
+            thrust::host_vector<T> h_output(size);
+
+            thrust::inclusive_scan(thrust::host, h_input.begin(), h_input.end(), h_output.begin());
+            ASSERT_EQ(h_output, inclusive);
+
+            thrust::exclusive_scan(thrust::host, h_input.begin(), h_input.end(), h_output.begin(), T(13));
+            ASSERT_EQ(h_output, exclusive);
+
+            thrust::inclusive_scan(thrust::host,
+                                   h_input.begin(),
+                                   h_input.end(),
+                                   h_output.begin(),
+                                   max_functor<T>());
+            ASSERT_EQ(h_output, maximums);
+
+            // in place
+            thrust::inclusive_scan(thrust::host, h_input.begin(), h_input.end(), h_input.begin());
+            ASSERT_EQ(h_input, inclusive);
+        }
+    }
+}
@@ -0,0 +1,260 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <thrust/functional.h>
+#include <thrust/reduce.h>
+#include <thrust/soa_vector.h>
+#include <thrust/sort.h>
+
+#include "test_header.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+typedef thrust::tuple<int, float, double> Particle;
+
+TEST(SoaVectorTests, TestSoaVectorPushBackAndColumns)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    thrust::device_soa_vector<Particle> v;
+
+    ASSERT_EQ(v.empty(), true);
+
+    for(int i = 0; i < 100; i++)
+    {
+        v.push_back(thrust::make_tuple(i, 2.0f * i, 0.5 * i));
+    }
+
+    ASSERT_EQ(v.size(), 100);
+    ASSERT_GE(v.capacity(), 100);
+    ASSERT_EQ(v.end() - v.begin(), 100);
+
+    Particle p = v[42];
+    ASSERT_EQ(thrust::get<0>(p), 42);
+    ASSERT_EQ(thrust::get<1>(p), 84.0f);
+    ASSERT_EQ(thrust::get<2>(p), 21.0);
+
+    // the columns are contiguous, and alias the elements
+    thrust::soa_span<thrust::device_ptr<float>> floats = v.column<1>();
+    ASSERT_EQ(floats.size(), 100);
+    ASSERT_EQ(floats.end() - floats.begin(), 100);
+    ASSERT_EQ(floats.data(), floats.begin());
+    ASSERT_EQ(floats[10], 20.0f);
+
+    floats[10] = -1.0f;
+    p = v[10];
+    ASSERT_EQ(thrust::get<1>(p), -1.0f);
+
+    ASSERT_EQ(thrust::reduce(v.column<0>().begin(), v.column<0>().end()), 4950);
+
+    v.pop_back();
+    ASSERT_EQ(v.size(), 99);
+    ASSERT_EQ(v.column<2>().size(), 99);
+}
+
+TEST(SoaVectorTests, TestSoaVectorResize)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    thrust::host_soa_vector<Particle> v(3);
+
+    Particle p = v[2];
+    ASSERT_EQ(p, thrust::make_tuple(0, 0.0f, 0.0));
+
+    v.resize(10, thrust::make_tuple(7, 8.0f, 9.0));
+    ASSERT_EQ(v.size(), 10);
+    p = v[9];
+    ASSERT_EQ(p, thrust::make_tuple(7, 8.0f, 9.0));
+
+    v.reserve(100);
+    ASSERT_GE(v.capacity(), 100);
+
+    v.resize(5);
+    v.shrink_to_fit();
+    ASSERT_EQ(v.size(), 5);
+    ASSERT_EQ(v.capacity(), 5);
+
+    thrust::host_soa_vector<Particle> w(2, thrust::make_tuple(1, 1.0f, 1.0));
+    v.swap(w);
+    ASSERT_EQ(v.size(), 2);
+    ASSERT_EQ(w.size(), 5);
+
+    v.clear();
+    ASSERT_EQ(v.empty(), true);
+    ASSERT_EQ(v.column<0>().empty(), true);
+}
+
+TEST(SoaVectorTests, TestSoaVectorCopyBetweenSpaces)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    thrust::host_soa_vector<Particle> h;
+    for(int i = 0; i < 10; i++)
+    {
+        h.push_back(thrust::make_tuple(i, 1.0f * i, 2.0 * i));
+    }
+
+    thrust::device_soa_vector<Particle> d(h);
+    ASSERT_EQ(d.size(), 10);
+
+    Particle p = d[3];
+    ASSERT_EQ(p, thrust::make_tuple(3, 3.0f, 6.0));
+
+    thrust::universal_soa_vector<Particle> u;
+    u = d;
+    p = u[9];
+    ASSERT_EQ(p, thrust::make_tuple(9, 9.0f, 18.0));
+}
+
+template <class SoaVector, class KeyVector>
+void TestSortByKeySoaVectorImpl()
+{
+    for(auto size : get_sizes())
+    {
+        SCOPED_TRACE(testing::Message() << "with size= " << size);
+
+        for(auto seed : get_seeds())
+        {
+            SCOPED_TRACE(testing::Message() << "with seed= " << seed);
+
+            // few distinct keys, to exercise the stability of the sort
+            thrust::host_vector<int> h_keys = get_random_data<int>(size, 0, 100, seed);
+
+            // the row of every element, and the order a stable sort puts them in
+            thrust::host_vector<int> h_rows(size);
+            std::iota(h_rows.begin(), h_rows.end(), 0);
+            std::stable_sort(h_rows.begin(), h_rows.end(), [&](int a, int b) {
+                return h_keys[a] < h_keys[b];
+            });
+
+            thrust::host_soa_vector<Particle> h;
+            h.reserve(size);
+            for(size_t i = 0; i < size; i++)
+            {
+                h.push_back(thrust::make_tuple(int(i), 0.5f * i, double(h_keys[i])));
+            }
+
+            SoaVector v = h;
+            KeyVector d_keys = h_keys;
+            thrust::stable_sort_by_key(d_keys.begin(), d_keys.end(), v.begin());
+
+            thrust::host_vector<int>    rows(v.template column<0>().begin(), v.template column<0>().end());
+            thrust::host_vector<float>  halves(v.template column<1>().begin(), v.template column<1>().end());
+            thrust::host_vector<double> keys(v.template column<2>().begin(), v.template column<2>().end());
+
+            ASSERT_EQ(rows, h_rows);
+            for(size_t i = 0; i < size; i++)
+            {
+                ASSERT_EQ(halves[i], 0.5f * rows[i]);
+                ASSERT_EQ(keys[i], double(h_keys[rows[i]]));
+            }
+
+            // descending, with the columns of each element kept together
+            v      = h;
+            d_keys = h_keys;
+            thrust::sort_by_key(d_keys.begin(), d_keys.end(), v.begin(), thrust::greater<int>());
+
+            thrust::host_vector<int> sorted_keys = d_keys;
+            rows = thrust::host_vector<int>(v.template column<0>().begin(), v.template column<0>().end());
+            keys = thrust::host_vector<double>(v.template column<2>().begin(), v.template column<2>().end());
+
+            ASSERT_EQ(thrust::is_sorted(sorted_keys.begin(), sorted_keys.end(), thrust::greater<int>()), true);
+            for(size_t i = 0; i < size; i++)
+            {
+                ASSERT_EQ(keys[i], double(sorted_keys[i]));
+                ASSERT_EQ(h_keys[rows[i]], sorted_keys[i]);
+            }
+        }
+    }
+}
+
+TEST(SoaVectorTests, TestSortByKeySoaVectorHost)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestSortByKeySoaVectorImpl<thrust::host_soa_vector<Particle>, thrust::host_vector<int>>();
+}
+
+TEST(SoaVectorTests, TestSortByKeySoaVectorDevice)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    TestSortByKeySoaVectorImpl<thrust::device_soa_vector<Particle>, thrust::device_vector<int>>();
+}
+
+template <typename RandomAccessIterator1, typename RandomAccessIterator2>
+void sort_by_key(my_system& system,
+                 RandomAccessIterator1,
+                 RandomAccessIterator1,
+                 RandomAccessIterator2)
+{
+    system.validate_dispatch();
+}
+
+TEST(SoaVectorTests, TestSortByKeySoaVectorDispatchExplicit)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    thrust::device_soa_vector<Particle> v(2);
+    thrust::device_vector<int>          keys(2);
+
+    // the columns of a soa_vector do not bypass the sort_by_key of a system
+    my_system sys(0);
+    thrust::sort_by_key(sys, keys.begin(), keys.end(), v.begin());
+
+    ASSERT_EQ(true, sys.is_valid());
+}
+
+struct sum_particles
+{
+    __host__ __device__
+    Particle operator()(const Particle& a, const Particle& b) const
+    {
+        return thrust::make_tuple(thrust::get<0>(a) + thrust::get<0>(b),
+                                  thrust::get<1>(a) + thrust::get<1>(b),
+                                  thrust::get<2>(a) + thrust::get<2>(b));
+    }
+};
+
+TEST(SoaVectorTests, TestReduceByKeySoaVector)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    thrust::device_soa_vector<Particle> v;
+    thrust::device_vector<int>          keys;
+    for(int i = 0; i < 9; i++)
+    {
+        v.push_back(thrust::make_tuple(i, 1.0f, 0.5));
+        keys.push_back(i / 3);
+    }
+
+    thrust::device_soa_vector<Particle> sums(3);
+    thrust::device_vector<int>          unique_keys(3);
+
+    thrust::reduce_by_key(keys.begin(),
+                          keys.end(),
+                          v.begin(),
+                          unique_keys.begin(),
+                          sums.begin(),
+                          thrust::equal_to<int>(),
+                          sum_particles());
+
+    Particle p = sums[1];
+    ASSERT_EQ(p, thrust::make_tuple(12, 3.0f, 1.5));
+    ASSERT_EQ(unique_keys[2], 2);
+}
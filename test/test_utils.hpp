@@ -142,6 +142,17 @@ std::vector<size_t> get_sizes()
     return sizes;
 }
 
+// sizes around the 4096 element tiles of the parallel algorithms of the OpenMP
+// and TBB systems, and around the 64K and 128K elements above which they sort
+// with a parallel radix or merge sort
+std::vector<size_t> get_host_tile_sizes()
+{
+    std::vector<size_t> sizes = {
+        4095, 4096, 4097, 3 * 4096 + 17, (1 << 16) - 1, (1 << 16) + 1, (1 << 17) + 3, 300007
+    };
+    return sizes;
+}
+
 std::vector<seed_type> get_seeds()
 {
     std::vector<seed_type> seeds;
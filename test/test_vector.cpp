@@ -17,8 +17,10 @@
 
 #include <thrust/device_malloc_allocator.h>
 #include <thrust/device_vector.h>
+#include <thrust/growth_policy.h>
 #include <thrust/memory.h>
 #include <thrust/sequence.h>
+#include <thrust/type_traits/is_trivially_relocatable.h>
 
 #include "test_header.hpp"
 
@@ -793,6 +795,240 @@ TYPED_TEST(VectorTests, TestVectorReserving)
     ASSERT_EQ(v.capacity(), old_capacity);
 }
 
+TYPED_TEST(VectorTests, TestVectorDefaultInit)
+{
+    using Vector = typename TestFixture::input_type;
+    using T      = typename Vector::value_type;
+
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    Vector v(3, thrust::default_init);
+
+    ASSERT_EQ(v.size(), 3);
+
+    thrust::sequence(v.begin(), v.end());
+
+    v.resize(5, thrust::default_init);
+
+    ASSERT_EQ(v.size(), 5);
+
+    ASSERT_EQ(v[0], T(0));
+    ASSERT_EQ(v[1], T(1));
+    ASSERT_EQ(v[2], T(2));
+
+    v[3] = T(3);
+    v[4] = T(4);
+
+    // growing beyond the capacity keeps the elements
+    v.resize(100, thrust::default_init);
+
+    ASSERT_EQ(v.size(), 100);
+
+    ASSERT_EQ(v[3], T(3));
+    ASSERT_EQ(v[4], T(4));
+
+    v.resize(2, thrust::default_init);
+
+    ASSERT_EQ(v.size(), 2);
+
+    ASSERT_EQ(v[0], T(0));
+    ASSERT_EQ(v[1], T(1));
+}
+
+struct default_init_nontrivial
+{
+    default_init_nontrivial() : value(42) {}
+
+    int value;
+};
+
+TEST(VectorTests, TestVectorDefaultInitNontrivial)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    // the default constructor still runs for types which have one
+    thrust::host_vector<default_init_nontrivial> v(3, thrust::default_init);
+
+    v.resize(50, thrust::default_init);
+
+    for(size_t i = 0; i < v.size(); ++i)
+    {
+        ASSERT_EQ(v[i].value, 42);
+    }
+}
+
+struct relocatable_counter
+{
+    static int copies;
+
+    relocatable_counter() : value(0) {}
+    relocatable_counter(int value) : value(value) {}
+    relocatable_counter(const relocatable_counter& other) : value(other.value) { ++copies; }
+    relocatable_counter& operator=(const relocatable_counter& other) = default;
+    ~relocatable_counter() {}
+
+    int value;
+};
+
+int relocatable_counter::copies = 0;
+
+THRUST_PROCLAIM_TRIVIALLY_RELOCATABLE(relocatable_counter)
+
+TEST(VectorTests, TestVectorGrowthRelocates)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    thrust::host_vector<relocatable_counter> v(10);
+    for(int i = 0; i < 10; ++i)
+    {
+        v[i].value = i;
+    }
+
+    // growing moves the elements bytewise, without copy constructing them
+    relocatable_counter::copies = 0;
+
+    v.reserve(100);
+    v.resize(1000);
+
+    ASSERT_EQ(relocatable_counter::copies, 0);
+
+    // only the inserted elements are copy constructed, and not the 1000
+    // elements moved to the new storage
+    v.insert(v.begin() + 5, 2000, relocatable_counter(-1));
+
+    ASSERT_LT(relocatable_counter::copies, 2000 + 1000);
+
+    ASSERT_EQ(v.size(), 3000);
+    for(int i = 0; i < 5; ++i)
+    {
+        ASSERT_EQ(v[i].value, i);
+        ASSERT_EQ(v[2005 + i].value, 5 + i);
+    }
+    ASSERT_EQ(v[5].value, -1);
+    ASSERT_EQ(v[2004].value, -1);
+}
+
+TYPED_TEST(VectorTests, TestVectorAppend)
+{
+    using Vector = typename TestFixture::input_type;
+    using T      = typename Vector::value_type;
+
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    std::vector<T> source(100);
+    for(size_t i = 0; i < source.size(); ++i)
+    {
+        source[i] = T(i % 100);
+    }
+
+    Vector v(3, T(1));
+
+    // growing reallocates once, to the exact size
+    v.append(source.begin(), source.end());
+
+    ASSERT_EQ(v.size(), 103);
+    ASSERT_EQ(v.capacity(), 103);
+    ASSERT_EQ(v[2], T(1));
+    ASSERT_EQ(v[3], T(0));
+    ASSERT_EQ(v[102], T(99));
+
+    // appending within the capacity does not reallocate
+    v.reserve(1000);
+    v.append(source.begin(), source.begin() + 10);
+
+    ASSERT_EQ(v.size(), 113);
+    ASSERT_EQ(v.capacity(), 1000);
+    ASSERT_EQ(v[112], T(9));
+
+    // the appended range may be the vector itself
+    v.shrink_to_fit();
+    v.append(v.begin(), v.end());
+
+    ASSERT_EQ(v.size(), 226);
+    ASSERT_EQ(v[113], T(1));
+    ASSERT_EQ(v[225], T(9));
+
+    v.append(v.end(), v.end());
+
+    ASSERT_EQ(v.size(), 226);
+}
+
+TEST(VectorTests, TestVectorGrowthPolicy)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    ASSERT_EQ((thrust::geometric_growth<>::next_capacity<int>(size_t(10), size_t(11))), 20);
+    ASSERT_EQ((thrust::geometric_growth<3, 2>::next_capacity<int>(size_t(10), size_t(11))), 15);
+    ASSERT_EQ((thrust::geometric_growth<3, 2>::next_capacity<int>(size_t(10), size_t(40))), 40);
+
+    // 100 ints at a time
+    ASSERT_EQ((thrust::capped_growth<400>::next_capacity<int>(size_t(10), size_t(11))), 20);
+    ASSERT_EQ((thrust::capped_growth<400>::next_capacity<int>(size_t(1000), size_t(1001))), 1100);
+    ASSERT_EQ((thrust::capped_growth<400>::next_capacity<int>(size_t(1000), size_t(5000))), 5000);
+
+    // the vectors double their capacity by default
+    thrust::host_vector<int> v(10);
+    v.push_back(1);
+
+    ASSERT_EQ(v.capacity(), 20);
+
+    thrust::host_vector<int, thrust::growth_policy_allocator<std::allocator<int>, thrust::geometric_growth<3, 2>>> w(10);
+    w.push_back(1);
+
+    ASSERT_EQ(w.capacity(), 15);
+
+    w.insert(w.begin(), 4, 2);
+    w.push_back(3);
+
+    ASSERT_EQ(w.capacity(), 22);
+    ASSERT_EQ(w[0], 2);
+    ASSERT_EQ(w[15], 3);
+
+    thrust::device_vector<int, thrust::growth_policy_allocator<thrust::device_allocator<int>, thrust::capped_growth<64>>> d(100);
+    d.push_back(1);
+
+    ASSERT_EQ(d.capacity(), 116);
+
+    thrust::host_vector<int> h(d);
+
+    ASSERT_EQ(h[100], 1);
+}
+
+TEST(VectorTests, TestVectorGrowthPolicyAllocatorShortcuts)
+{
+    SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
+
+    typedef thrust::growth_policy_allocator<std::allocator<int>, thrust::geometric_growth<3, 2>> int_allocator;
+    typedef thrust::growth_policy_allocator<std::allocator<relocatable_counter>, thrust::geometric_growth<3, 2>>
+        counter_allocator;
+
+    // the allocator constructs and destroys as std::allocator does, so default_init
+    // leaves trivial elements uninitialized, and growth relocates them bytewise
+    ASSERT_FALSE((thrust::detail::allocator_traits_detail::needs_default_construct_via_allocator<int_allocator, int>::value));
+    ASSERT_FALSE((thrust::detail::allocator_traits_detail::needs_copy_construct_via_allocator<int_allocator, int>::value));
+    ASSERT_FALSE((thrust::detail::allocator_traits_detail::has_effectful_member_destroy<int_allocator, int>::value));
+    ASSERT_TRUE((thrust::detail::is_trivially_relocatable_with_allocator<int_allocator, int>::value));
+    ASSERT_TRUE((thrust::detail::is_trivially_relocatable_with_allocator<counter_allocator, relocatable_counter>::value));
+
+    thrust::host_vector<int, int_allocator> v(10, thrust::default_init);
+    thrust::sequence(v.begin(), v.end());
+    v.resize(1000, thrust::default_init);
+
+    ASSERT_EQ(v.size(), 1000);
+    ASSERT_EQ(v[9], 9);
+
+    thrust::host_vector<relocatable_counter, counter_allocator> w(10);
+    w[9].value = 9;
+
+    relocatable_counter::copies = 0;
+
+    w.reserve(100);
+    w.resize(1000);
+
+    ASSERT_EQ(relocatable_counter::copies, 0);
+    ASSERT_EQ(w[9].value, 9);
+}
+
 TEST(VectorTests, TestVectorUninitialisedCopy)
 {
     SCOPED_TRACE(testing::Message() << "with device_id= " << test::set_device_from_ctest());
@@ -1,5 +1,6 @@
 /*
  *  Copyright 2008-2013 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -81,15 +82,39 @@ template<typename U, typename T>
 {};
 
 
+// the allocator's system succeeds the system of the source range if it can
+// use the source iterators itself, while the source system cannot use its
+// ones, as the omp and tbb systems succeed cpp. The allocator's system then
+// constructs the new elements, so that the pages of the storage are first
+// touched by the threads which will later work on them
+template<typename FromSystem, typename ToSystem>
+  struct is_successor_system
+    : integral_constant<
+        bool,
+        (is_convertible<ToSystem,FromSystem>::value && !is_convertible<FromSystem,ToSystem>::value)
+      >
+{};
+
+
+// the allocator's system constructs the new elements itself when it can use
+// the source iterators
+template<typename FromSystem, typename ToSystem>
+  struct constructs_in_allocator_system
+    : integral_constant<
+        bool,
+        (is_convertible<FromSystem,ToSystem>::value || is_successor_system<FromSystem,ToSystem>::value)
+      >
+{};
+
+
 // XXX it's regrettable that this implementation is copied almost
 //     exactly from system::detail::generic::uninitialized_copy
 //     perhaps generic::uninitialized_copy could call this routine
 //     with a default allocator
 template<typename Allocator, typename FromSystem, typename ToSystem, typename InputIterator, typename Pointer>
 __host__ __device__
-  typename enable_if_convertible<
-    FromSystem,
-    ToSystem,
+  typename enable_if<
+    constructs_in_allocator_system<FromSystem,ToSystem>::value,
     Pointer
   >::type
     uninitialized_copy_with_allocator(Allocator &a,
@@ -129,9 +154,8 @@ __host__ __device__
 //     with a default allocator
 template<typename Allocator, typename FromSystem, typename ToSystem, typename InputIterator, typename Size, typename Pointer>
 __host__ __device__
-  typename enable_if_convertible<
-    FromSystem,
-    ToSystem,
+  typename enable_if<
+    constructs_in_allocator_system<FromSystem,ToSystem>::value,
     Pointer
   >::type
     uninitialized_copy_with_allocator_n(Allocator &a,
@@ -162,9 +186,8 @@ __host__ __device__
 
 template<typename Allocator, typename FromSystem, typename ToSystem, typename InputIterator, typename Pointer>
 __host__ __device__
-  typename disable_if_convertible<
-    FromSystem,
-    ToSystem,
+  typename disable_if<
+    constructs_in_allocator_system<FromSystem,ToSystem>::value,
     Pointer
   >::type
     uninitialized_copy_with_allocator(Allocator &,
@@ -182,9 +205,8 @@ __host__ __device__
 
 template<typename Allocator, typename FromSystem, typename ToSystem, typename InputIterator, typename Size, typename Pointer>
 __host__ __device__
-  typename disable_if_convertible<
-    FromSystem,
-    ToSystem,
+  typename disable_if<
+    constructs_in_allocator_system<FromSystem,ToSystem>::value,
     Pointer
   >::type
     uninitialized_copy_with_allocator_n(Allocator &,
@@ -200,6 +222,72 @@ __host__ __device__
 } // end uninitialized_copy_with_allocator_n()
 
 
+template<typename FromSystem, typename ToSystem, typename InputIterator, typename Pointer>
+__host__ __device__
+  typename enable_if<
+    is_successor_system<FromSystem,ToSystem>::value,
+    Pointer
+  >::type
+    trivial_copy_construct(const thrust::execution_policy<FromSystem> &,
+                           const thrust::execution_policy<ToSystem> &to_system,
+                           InputIterator first,
+                           InputIterator last,
+                           Pointer result)
+{
+  // copy in the allocator's system, rather than in the source's one, which
+  // two_system_copy would select
+  return thrust::copy(to_system, first, last, result);
+}
+
+
+template<typename FromSystem, typename ToSystem, typename InputIterator, typename Pointer>
+__host__ __device__
+  typename disable_if<
+    is_successor_system<FromSystem,ToSystem>::value,
+    Pointer
+  >::type
+    trivial_copy_construct(const thrust::execution_policy<FromSystem> &from_system,
+                           const thrust::execution_policy<ToSystem> &to_system,
+                           InputIterator first,
+                           InputIterator last,
+                           Pointer result)
+{
+  return thrust::detail::two_system_copy(from_system, to_system, first, last, result);
+}
+
+
+template<typename FromSystem, typename ToSystem, typename InputIterator, typename Size, typename Pointer>
+__host__ __device__
+  typename enable_if<
+    is_successor_system<FromSystem,ToSystem>::value,
+    Pointer
+  >::type
+    trivial_copy_construct_n(const thrust::execution_policy<FromSystem> &,
+                             const thrust::execution_policy<ToSystem> &to_system,
+                             InputIterator first,
+                             Size n,
+                             Pointer result)
+{
+  return thrust::copy_n(to_system, first, n, result);
+}
+
+
+template<typename FromSystem, typename ToSystem, typename InputIterator, typename Size, typename Pointer>
+__host__ __device__
+  typename disable_if<
+    is_successor_system<FromSystem,ToSystem>::value,
+    Pointer
+  >::type
+    trivial_copy_construct_n(const thrust::execution_policy<FromSystem> &from_system,
+                             const thrust::execution_policy<ToSystem> &to_system,
+                             InputIterator first,
+                             Size n,
+                             Pointer result)
+{
+  return thrust::detail::two_system_copy_n(from_system, to_system, first, n, result);
+}
+
+
 template<typename FromSystem, typename Allocator, typename InputIterator, typename Pointer>
 __host__ __device__
   typename disable_if<
@@ -215,8 +303,7 @@ __host__ __device__
                          InputIterator last,
                          Pointer result)
 {
-  // just call two_system_copy
-  return thrust::detail::two_system_copy(from_system, allocator_system<Allocator>::get(a), first, last, result);
+  return trivial_copy_construct(from_system, allocator_system<Allocator>::get(a), first, last, result);
 }
 
 
@@ -235,8 +322,7 @@ __host__ __device__
                            Size n,
                            Pointer result)
 {
-  // just call two_system_copy_n
-  return thrust::detail::two_system_copy_n(from_system, allocator_system<Allocator>::get(a), first, n, result);
+  return trivial_copy_construct_n(from_system, allocator_system<Allocator>::get(a), first, n, result);
 }
 
 
@@ -1,5 +1,6 @@
 /*
  *  Copyright 2008-2013 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -28,6 +29,13 @@ __host__ __device__
 inline void default_construct_range(Allocator &a, Pointer p, Size n);
 
 
+// like default_construct_range, but leaves the elements uninitialized when
+// neither their type nor the allocator has anything to do to construct them
+template<typename Allocator, typename Pointer, typename Size>
+__host__ __device__
+inline void default_init_range(Allocator &a, Pointer p, Size n);
+
+
 } // end detail
 THRUST_NAMESPACE_END
 
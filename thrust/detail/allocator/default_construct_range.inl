@@ -1,5 +1,6 @@
 /*
  *  Copyright 2008-2013 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -96,6 +97,34 @@ __host__ __device__
 }
 
 
+template<typename Allocator, typename Pointer, typename Size>
+__host__ __device__
+  typename enable_if<
+    needs_default_construct_via_allocator<
+      Allocator,
+      typename pointer_element<Pointer>::type
+    >::value
+  >::type
+    default_init_range(Allocator &a, Pointer p, Size n)
+{
+  allocator_traits_detail::default_construct_range(a, p, n);
+}
+
+
+template<typename Allocator, typename Pointer, typename Size>
+__host__ __device__
+  typename disable_if<
+    needs_default_construct_via_allocator<
+      Allocator,
+      typename pointer_element<Pointer>::type
+    >::value
+  >::type
+    default_init_range(Allocator &, Pointer, Size)
+{
+  // default initialization of a trivially constructible type does nothing
+}
+
+
 } // end allocator_traits_detail
 
 
@@ -107,6 +136,14 @@ __host__ __device__
 }
 
 
+template<typename Allocator, typename Pointer, typename Size>
+__host__ __device__
+  void default_init_range(Allocator &a, Pointer p, Size n)
+{
+  return allocator_traits_detail::default_init_range(a,p,n);
+}
+
+
 } // end detail
 THRUST_NAMESPACE_END
 
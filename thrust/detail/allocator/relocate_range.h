@@ -0,0 +1,45 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <thrust/detail/config.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace detail
+{
+
+
+// true when the elements of an Allocator can be moved to new storage by
+// copying their bytes, which requires a trivially relocatable type, and an
+// allocator which has nothing to do to construct or destroy them
+template<typename Allocator, typename T>
+  struct is_trivially_relocatable_with_allocator;
+
+
+// moves the n elements starting at first to the uninitialized storage starting
+// at result by copying their bytes; the elements left at first must not be
+// destroyed afterwards
+template<typename Allocator, typename Pointer, typename Size>
+__host__ __device__
+inline void trivially_relocate_range(Allocator &a, Pointer first, Size n, Pointer result);
+
+
+} // end detail
+THRUST_NAMESPACE_END
+
+#include <thrust/detail/allocator/relocate_range.inl>
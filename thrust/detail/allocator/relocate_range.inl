@@ -0,0 +1,78 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/detail/allocator/relocate_range.h>
+#include <thrust/detail/allocator/allocator_traits.h>
+#include <thrust/detail/allocator/destroy_range.h>
+#include <thrust/detail/alignment.h>
+#include <thrust/detail/copy.h>
+#include <thrust/detail/memory_wrapper.h>
+#include <thrust/detail/raw_pointer_cast.h>
+#include <thrust/detail/type_traits.h>
+#include <thrust/detail/type_traits/pointer_traits.h>
+#include <thrust/type_traits/is_trivially_relocatable.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace detail
+{
+
+
+template<typename Allocator, typename T>
+  struct is_trivially_relocatable_with_allocator
+    : integral_constant<
+        bool,
+        (is_trivially_relocatable<T>::value &&
+         !allocator_traits_detail::has_member_construct2<Allocator,T,T>::value &&
+         !allocator_traits_detail::has_effectful_member_destroy<Allocator,T>::value)
+      >
+{};
+
+
+// std::allocator::construct and destroy only invoke T's constructor and
+// destructor, which relocation is allowed to skip
+template<typename U, typename T>
+  struct is_trivially_relocatable_with_allocator<std::allocator<U>, T>
+    : integral_constant<
+        bool,
+        is_trivially_relocatable<T>::value
+      >
+{};
+
+
+template<typename Allocator, typename Pointer, typename Size>
+__host__ __device__
+  void trivially_relocate_range(Allocator &a, Pointer first, Size n, Pointer result)
+{
+  typedef typename pointer_element<Pointer>::type T;
+
+  // T itself may have a non-trivial copy constructor, so copy the elements as
+  // blocks of bytes of the same size and alignment
+  typedef typename aligned_storage<sizeof(T), alignment_of<T>::value>::type block;
+  typedef typename pointer_traits<Pointer>::template rebind<block>::other block_pointer;
+
+  block_pointer from(reinterpret_cast<block *>(thrust::raw_pointer_cast(first)));
+  block_pointer to(reinterpret_cast<block *>(thrust::raw_pointer_cast(result)));
+
+  thrust::copy(allocator_system<Allocator>::get(a), from, from + n, to);
+}
+
+
+} // end detail
+THRUST_NAMESPACE_END
@@ -1,5 +1,6 @@
 /*
  *  Copyright 2020 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -17,6 +18,7 @@
 #pragma once
 
 #include <thrust/detail/config.h>
+#include <thrust/detail/host_caching_allocator.h>
 #include <thrust/mr/allocator.h>
 #include <thrust/mr/disjoint_tls_pool.h>
 #include <thrust/mr/new.h>
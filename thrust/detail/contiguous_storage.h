@@ -1,5 +1,6 @@
 /*
  *  Copyright 2008-2018 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -115,6 +116,9 @@ template<typename T, typename Alloc>
     __host__ __device__
     void default_construct_n(iterator first, size_type n);
 
+    __host__ __device__
+    void default_init_n(iterator first, size_type n);
+
     __host__ __device__
     void uninitialized_fill_n(iterator first, size_type n, const value_type &value);
 
@@ -143,6 +147,19 @@ template<typename T, typename Alloc>
     __host__ __device__
     void destroy(iterator first, iterator last);
 
+    // moves [first,last) to the uninitialized storage starting at result,
+    // which comes from an allocator equal to this one; the elements are
+    // copied bytewise when they are trivially relocatable, and copy
+    // constructed otherwise
+    __host__ __device__
+    iterator uninitialized_relocate(iterator first, iterator last, iterator result);
+
+    // destroys the elements left behind by uninitialized_relocate, unless
+    // they were copied bytewise, in which case their lifetime has moved along
+    // with their bytes
+    __host__ __device__
+    void destroy_relocated(iterator first, iterator last);
+
     __host__ __device__
     void deallocate_on_allocator_mismatch(const contiguous_storage &other);
 
@@ -209,6 +226,18 @@ template<typename T, typename Alloc>
     void destroy_on_allocator_mismatch_dispatch(false_type, const contiguous_storage &other,
         iterator first, iterator last);
 
+    __host__ __device__
+    iterator uninitialized_relocate_dispatch(true_type, iterator first, iterator last, iterator result);
+
+    __host__ __device__
+    iterator uninitialized_relocate_dispatch(false_type, iterator first, iterator last, iterator result);
+
+    __host__ __device__
+    void destroy_relocated_dispatch(true_type, iterator first, iterator last);
+
+    __host__ __device__
+    void destroy_relocated_dispatch(false_type, iterator first, iterator last);
+
     __host__ __device__
     void propagate_allocator_dispatch(true_type, const contiguous_storage &other);
 
@@ -25,6 +25,7 @@
 #include <thrust/detail/allocator/default_construct_range.h>
 #include <thrust/detail/allocator/destroy_range.h>
 #include <thrust/detail/allocator/fill_construct_range.h>
+#include <thrust/detail/allocator/relocate_range.h>
 
 #include <thrust/detail/nv_target.h>
 
@@ -257,6 +258,14 @@ __host__ __device__
   default_construct_range(m_allocator, first.base(), n);
 } // end contiguous_storage::default_construct_n()
 
+template<typename T, typename Alloc>
+__host__ __device__
+  void contiguous_storage<T,Alloc>
+    ::default_init_n(iterator first, size_type n)
+{
+  default_init_range(m_allocator, first.base(), n);
+} // end contiguous_storage::default_init_n()
+
 template<typename T, typename Alloc>
 __host__ __device__
   void contiguous_storage<T,Alloc>
@@ -319,6 +328,27 @@ __host__ __device__
   destroy_range(m_allocator, first.base(), last - first);
 } // end contiguous_storage::destroy()
 
+template<typename T, typename Alloc>
+__host__ __device__
+  typename contiguous_storage<T,Alloc>::iterator
+    contiguous_storage<T,Alloc>
+      ::uninitialized_relocate(iterator first, iterator last, iterator result)
+{
+  typename is_trivially_relocatable_with_allocator<Alloc,T>::type c;
+
+  return uninitialized_relocate_dispatch(c, first, last, result);
+} // end contiguous_storage::uninitialized_relocate()
+
+template<typename T, typename Alloc>
+__host__ __device__
+  void contiguous_storage<T,Alloc>
+    ::destroy_relocated(iterator first, iterator last)
+{
+  typename is_trivially_relocatable_with_allocator<Alloc,T>::type c;
+
+  destroy_relocated_dispatch(c, first, last);
+} // end contiguous_storage::destroy_relocated()
+
 template<typename T, typename Alloc>
 __host__ __device__
   void contiguous_storage<T,Alloc>
@@ -504,6 +534,43 @@ __host__ __device__
 {
 } // end contiguous_storage::destroy_on_allocator_mismatch()
 
+template<typename T, typename Alloc>
+__host__ __device__
+  typename contiguous_storage<T,Alloc>::iterator
+    contiguous_storage<T,Alloc>
+      ::uninitialized_relocate_dispatch(true_type, iterator first, iterator last, iterator result)
+{
+  const size_type n = last - first;
+
+  trivially_relocate_range(m_allocator, first.base(), n, result.base());
+
+  return result + n;
+} // end contiguous_storage::uninitialized_relocate()
+
+template<typename T, typename Alloc>
+__host__ __device__
+  typename contiguous_storage<T,Alloc>::iterator
+    contiguous_storage<T,Alloc>
+      ::uninitialized_relocate_dispatch(false_type, iterator first, iterator last, iterator result)
+{
+  return uninitialized_copy(first, last, result);
+} // end contiguous_storage::uninitialized_relocate()
+
+template<typename T, typename Alloc>
+__host__ __device__
+  void contiguous_storage<T,Alloc>
+    ::destroy_relocated_dispatch(true_type, iterator, iterator)
+{
+} // end contiguous_storage::destroy_relocated()
+
+template<typename T, typename Alloc>
+__host__ __device__
+  void contiguous_storage<T,Alloc>
+    ::destroy_relocated_dispatch(false_type, iterator first, iterator last)
+{
+  destroy(first, last);
+} // end contiguous_storage::destroy_relocated()
+
 __thrust_exec_check_disable__
 template<typename T, typename Alloc>
 __host__ __device__
@@ -0,0 +1,249 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/detail/integer_math.h>
+#include <thrust/mr/allocator.h>
+#include <thrust/mr/memory_resource.h>
+#include <thrust/mr/new.h>
+#include <thrust/mr/detail/pool_decay.h>
+
+#include <cstddef>
+#include <vector>
+
+// the most bytes a thread keeps cached, and the largest block it caches
+#ifndef THRUST_HOST_CACHING_ALLOCATOR_MAX_CACHED_BYTES
+  #define THRUST_HOST_CACHING_ALLOCATOR_MAX_CACHED_BYTES (32 << 20)
+#endif
+#ifndef THRUST_HOST_CACHING_ALLOCATOR_MAX_BLOCK_BYTES
+  #define THRUST_HOST_CACHING_ALLOCATOR_MAX_BLOCK_BYTES (8 << 20)
+#endif
+
+THRUST_NAMESPACE_BEGIN
+
+namespace detail
+{
+
+// the host counterpart of the pool behind single_device_tls_caching_allocator,
+// which the host systems allocate their temporary buffers from. It is included
+// by the temporary buffer functions of those systems, and thus cannot use the
+// pools of thrust/mr, which are built on host_vector; instead, it caches whole
+// blocks, in size classes four to a power of two, on plain std::vectors.
+//
+// Blocks are not tied to the thread which allocated them: they all come from
+// new and delete, so a block returned on another thread is simply cached there.
+class host_caching_resource final : public thrust::mr::memory_resource<>
+{
+public:
+    // the size of the smallest size class
+    static const std::size_t min_block_size = 256;
+    // at most this many bytes are kept cached, whether or not blocks are in use
+    static const std::size_t max_cached_bytes = THRUST_HOST_CACHING_ALLOCATOR_MAX_CACHED_BYTES;
+    // larger requests are not cached at all
+    static const std::size_t max_block_bytes = THRUST_HOST_CACHING_ALLOCATOR_MAX_BLOCK_BYTES;
+    // the memory not needed during this many milliseconds, if not zero, is given
+    // back at the next allocation or deallocation, so that a burst does not pin
+    // memory for the lifetime of the thread
+    static const std::size_t decay_interval_ms = 1000;
+
+    explicit host_caching_resource(std::size_t decay_ms = decay_interval_ms)
+        : m_upstream(thrust::mr::get_global_resource<thrust::mr::new_delete_resource>()),
+        m_free(),
+        m_bytes_in_use(0),
+        m_cached_bytes(0),
+        m_decay(decay_ms)
+    {
+    }
+
+    ~host_caching_resource()
+    {
+        release();
+    }
+
+    host_caching_resource(const host_caching_resource &) = delete;
+    host_caching_resource & operator=(const host_caching_resource &) = delete;
+
+    // the number of bytes in the blocks kept for reuse
+    std::size_t cached_bytes() const
+    {
+        return m_cached_bytes;
+    }
+
+    // gives every cached block back to upstream
+    void release()
+    {
+        trim(0);
+    }
+
+    THRUST_NODISCARD virtual void * do_allocate(std::size_t bytes, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
+    {
+        if (!cacheable(bytes, alignment))
+        {
+            decay();
+
+            return m_upstream->do_allocate(bytes, alignment);
+        }
+
+        std::size_t block_size;
+        std::size_t size_class = get_size_class(bytes, block_size);
+
+        void * ret;
+        if (size_class < m_free.size() && !m_free[size_class].empty())
+        {
+            ret = m_free[size_class].back();
+            m_free[size_class].pop_back();
+            m_cached_bytes -= block_size;
+        }
+        else
+        {
+            ret = m_upstream->do_allocate(block_size, THRUST_MR_DEFAULT_ALIGNMENT);
+        }
+
+        m_bytes_in_use += block_size;
+
+        decay();
+
+        return ret;
+    }
+
+    virtual void do_deallocate(void * p, std::size_t bytes, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
+    {
+        if (!cacheable(bytes, alignment))
+        {
+            m_upstream->do_deallocate(p, bytes, alignment);
+            return;
+        }
+
+        std::size_t block_size;
+        std::size_t size_class = get_size_class(bytes, block_size);
+
+        if (size_class >= m_free.size())
+        {
+            m_free.resize(size_class + 1);
+        }
+        m_free[size_class].push_back(p);
+
+        // blocks returned on a thread other than the one which allocated them
+        // are not counted as in use here
+        m_bytes_in_use -= block_size < m_bytes_in_use ? block_size : m_bytes_in_use;
+        m_cached_bytes += block_size;
+
+        if (m_cached_bytes > max_cached_bytes)
+        {
+            trim(max_cached_bytes);
+        }
+
+        decay();
+    }
+
+private:
+    static bool cacheable(std::size_t bytes, std::size_t alignment)
+    {
+        return bytes <= max_block_bytes && alignment <= THRUST_MR_DEFAULT_ALIGNMENT;
+    }
+
+    // at the end of a decay interval, keeps cached only what the peak of the
+    // interval needed on top of the blocks now in use
+    void decay()
+    {
+        std::size_t target;
+        if (m_decay.enabled() && m_decay.tick(m_bytes_in_use, target))
+        {
+            trim(target > m_bytes_in_use ? target - m_bytes_in_use : 0);
+        }
+    }
+
+    // returns the size class of a request, and the size of its blocks; for
+    // 2^k < bytes <= 2^(k+1), the blocks are 1.25, 1.5, 1.75 or 2 times 2^k
+    // bytes, wasting at most a fifth of the block
+    static std::size_t get_size_class(std::size_t bytes, std::size_t & block_size)
+    {
+        if (bytes <= min_block_size)
+        {
+            block_size = min_block_size;
+            return 0;
+        }
+
+        std::size_t k = log2(bytes - 1);
+        std::size_t base = static_cast<std::size_t>(1) << k;
+        std::size_t step = base / 4;
+        std::size_t sub = (bytes - 1 - base) / step;
+
+        block_size = base + (sub + 1) * step;
+
+        return 4 * (k - log2(static_cast<std::size_t>(min_block_size))) + sub + 1;
+    }
+
+    // gives cached blocks back to upstream, the largest first, until at most
+    // target_bytes are cached
+    void trim(std::size_t target_bytes)
+    {
+        for (std::size_t i = m_free.size(); i > 0 && m_cached_bytes > target_bytes; --i)
+        {
+            std::size_t size_class = i - 1;
+            std::size_t block_size = size_class_block_size(size_class);
+
+            while (!m_free[size_class].empty() && m_cached_bytes > target_bytes)
+            {
+                m_upstream->do_deallocate(m_free[size_class].back(), block_size, THRUST_MR_DEFAULT_ALIGNMENT);
+                m_free[size_class].pop_back();
+                m_cached_bytes -= block_size;
+            }
+        }
+    }
+
+    static std::size_t size_class_block_size(std::size_t size_class)
+    {
+        if (size_class == 0)
+        {
+            return min_block_size;
+        }
+
+        std::size_t base = static_cast<std::size_t>(min_block_size) << ((size_class - 1) / 4);
+        return base + ((size_class - 1) % 4 + 1) * (base / 4);
+    }
+
+    thrust::mr::new_delete_resource * m_upstream;
+
+    std::vector<std::vector<void *> > m_free;
+    std::size_t m_bytes_in_use;
+    std::size_t m_cached_bytes;
+
+    pool_decay m_decay;
+};
+
+__host__
+inline host_caching_resource & host_tls_caching_resource()
+{
+    static thread_local host_caching_resource resource;
+
+    return resource;
+}
+
+__host__
+inline
+thrust::mr::allocator<
+    char,
+    host_caching_resource
+> single_host_tls_caching_allocator()
+{
+    return { &host_tls_caching_resource() };
+}
+}
+
+THRUST_NAMESPACE_END
@@ -1,5 +1,6 @@
 /*
  *  Copyright 2008-2018 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -28,10 +29,41 @@
 #include <thrust/detail/type_traits.h>
 #include <thrust/detail/config.h>
 #include <thrust/detail/contiguous_storage.h>
+#include <thrust/growth_policy.h>
 #include <vector>
 
 THRUST_NAMESPACE_BEGIN
 
+/*! \addtogroup container_classes Container Classes
+ *  \{
+ */
+
+/*! \p default_init_t is the type of \p default_init, a tag which requests
+ *  the new elements of a vector to be default-initialized rather than
+ *  value-initialized: elements of a type whose default constructor does
+ *  nothing, such as \c int, are left uninitialized, which saves a pass over
+ *  memory when they are about to be overwritten anyway.
+ */
+struct default_init_t {};
+
+/*! \p default_init is passed to the constructors and to \p resize of
+ *  \p host_vector, \p device_vector and \p universal_vector to leave the new
+ *  elements uninitialized when their type is trivially constructible.
+ *
+ *  \code
+ *  #include <thrust/host_vector.h>
+ *  #include <thrust/sequence.h>
+ *  ...
+ *  // the elements are written once, by sequence
+ *  thrust::host_vector<int> v(1 << 30, thrust::default_init);
+ *  thrust::sequence(v.begin(), v.end());
+ *  \endcode
+ */
+THRUST_INLINE_CONSTANT default_init_t default_init = default_init_t{};
+
+/*! \} // container_classes
+ */
+
 namespace detail
 {
 
@@ -80,6 +112,21 @@ template<typename T, typename Alloc>
      */
     explicit vector_base(size_type n, const Alloc &alloc);
 
+    /*! This constructor creates a vector_base with default-initialized
+     *  elements, which are left uninitialized if \c T is trivially
+     *  constructible.
+     *  \param n The number of elements to create.
+     */
+    vector_base(size_type n, default_init_t);
+
+    /*! This constructor creates a vector_base with default-initialized
+     *  elements, which are left uninitialized if \c T is trivially
+     *  constructible.
+     *  \param n The number of elements to create.
+     *  \param alloc The allocator to use by this vector_base.
+     */
+    vector_base(size_type n, default_init_t, const Alloc &alloc);
+
     /*! This constructor creates a vector_base with copies
      *  of an exemplar element.
      *  \param n The number of elements to initially create.
@@ -204,6 +251,18 @@ template<typename T, typename Alloc>
      */
     void resize(size_type new_size, const value_type &x);
 
+    /*! \brief Resizes this vector_base to the specified number of elements.
+     *  \param new_size Number of elements this vector_base should contain.
+     *  \throw std::length_error If n exceeds max_size().
+     *
+     *  This method will resize this vector_base to the specified number of
+     *  elements. If the number is smaller than this vector_base's current
+     *  size this vector_base is truncated, otherwise this vector_base is
+     *  extended and new elements are default-initialized, which leaves them
+     *  uninitialized if \c T is trivially constructible.
+     */
+    void resize(size_type new_size, default_init_t);
+
     /*! Returns the number of elements in this vector_base.
      */
     size_type size(void) const;
@@ -427,6 +486,19 @@ template<typename T, typename Alloc>
     template<typename InputIterator>
     void insert(iterator position, InputIterator first, InputIterator last);
 
+    /*! This method appends a copy of an input range to the end of this
+     *  vector_base. Unlike \p insert at \p end(), it constructs the new
+     *  elements in place with the algorithms of the allocator's system, and
+     *  reallocates at most once, to the capacity the growth policy of the
+     *  allocator gives.
+     *  \param first The beginning of the range to copy.
+     *  \param last  The end of the range to copy.
+     *
+     *  \tparam InputIterator is a model of <a href="https://en.cppreference.com/w/cpp/named_req/InputIterator">Input Iterator</a>.
+     */
+    template<typename InputIterator>
+    void append(InputIterator first, InputIterator last);
+
     /*! This version of \p assign replicates a given exemplar
      *  \p n times into this vector_base.
      *  \param n The number of times to copy \p x.
@@ -456,6 +528,9 @@ template<typename T, typename Alloc>
     size_type m_size;
 
   private:
+    // the growth policy of the allocator, which gives the capacity of new storage
+    typedef typename allocator_growth_policy<Alloc>::type growth_policy;
+
     // these methods resolve the ambiguity of the constructor template of form (Iterator, Iterator)
     template<typename IteratorOrIntegralType>
       void init_dispatch(IteratorOrIntegralType begin, IteratorOrIntegralType end, false_type);
@@ -472,7 +547,7 @@ template<typename T, typename Alloc>
     template<typename ForwardIterator>
       void range_init(ForwardIterator first, ForwardIterator last, thrust::random_access_traversal_tag);
 
-    void default_init(size_type n);
+    void default_init(size_type n, bool leave_uninitialized = false);
 
     void fill_init(size_type n, const T &x);
 
@@ -484,8 +559,25 @@ template<typename T, typename Alloc>
     template<typename InputIteratorOrIntegralType>
       void insert_dispatch(iterator position, InputIteratorOrIntegralType n, InputIteratorOrIntegralType x, true_type);
 
-    // this method appends n default-constructed elements at the end
-    void append(size_type n);
+    // this method appends n default-constructed elements at the end, or
+    // default-initialized ones if leave_uninitialized is true
+    void append(size_type n, bool leave_uninitialized = false);
+
+    // this method constructs the n elements at first as default_init and
+    // append do
+    void default_construct_n(storage_type &storage, iterator first, size_type n, bool leave_uninitialized);
+
+    // this method returns the capacity to reallocate to when the vector must
+    // hold required_capacity elements
+    size_type next_capacity(size_type required_capacity) const;
+
+    // this method performs appending from a range of RandomAccessIterators
+    template<typename RandomAccessIterator>
+      void range_append(RandomAccessIterator first, RandomAccessIterator last, thrust::random_access_traversal_tag);
+
+    // this method performs appending from a range of InputIterators
+    template<typename InputIterator>
+      void range_append(InputIterator first, InputIterator last, thrust::incrementable_traversal_tag);
 
     // this method performs insertion from a fill value
     void fill_insert(iterator position, size_type n, const T &x);
@@ -1,5 +1,6 @@
 /*
  *  Copyright 2008-2018 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -71,6 +72,24 @@ template<typename T, typename Alloc>
   default_init(n);
 } // end vector_base::vector_base()
 
+template<typename T, typename Alloc>
+  vector_base<T,Alloc>
+    ::vector_base(size_type n, default_init_t)
+      :m_storage(),
+       m_size(0)
+{
+  default_init(n, true);
+} // end vector_base::vector_base()
+
+template<typename T, typename Alloc>
+  vector_base<T,Alloc>
+    ::vector_base(size_type n, default_init_t, const Alloc &alloc)
+      :m_storage(alloc),
+       m_size(0)
+{
+  default_init(n, true);
+} // end vector_base::vector_base()
+
 template<typename T, typename Alloc>
   vector_base<T,Alloc>
     ::vector_base(size_type n, const value_type &value)
@@ -207,17 +226,31 @@ template<typename T, typename Alloc>
 
 template<typename T, typename Alloc>
   void vector_base<T,Alloc>
-    ::default_init(size_type n)
+    ::default_init(size_type n, bool leave_uninitialized)
 {
   if(n > 0)
   {
     m_storage.allocate(n);
     m_size = n;
 
-    m_storage.default_construct_n(begin(), size());
+    default_construct_n(m_storage, begin(), size(), leave_uninitialized);
   } // end if
 } // end vector_base::default_init()
 
+template<typename T, typename Alloc>
+  void vector_base<T,Alloc>
+    ::default_construct_n(storage_type &storage, iterator first, size_type n, bool leave_uninitialized)
+{
+  if(leave_uninitialized)
+  {
+    storage.default_init_n(first, n);
+  } // end if
+  else
+  {
+    storage.default_construct_n(first, n);
+  } // end else
+} // end vector_base::default_construct_n()
+
 template<typename T, typename Alloc>
   void vector_base<T,Alloc>
     ::fill_init(size_type n, const T &x)
@@ -338,6 +371,22 @@ template<typename T, typename Alloc>
   } // end else
 } // end vector_base::resize()
 
+template<typename T, typename Alloc>
+  void vector_base<T,Alloc>
+    ::resize(size_type new_size, default_init_t)
+{
+  if(new_size < size())
+  {
+    iterator new_end = begin();
+    thrust::advance(new_end, new_size);
+    erase(new_end, end());
+  } // end if
+  else
+  {
+    append(new_size - size(), true);
+  } // end else
+} // end vector_base::resize()
+
 template<typename T, typename Alloc>
   typename vector_base<T,Alloc>::size_type
     vector_base<T,Alloc>
@@ -374,8 +423,8 @@ template<typename T, typename Alloc>
 
     try
     {
-      // construct copy all elements into the newly allocated storage
-      new_end = m_storage.uninitialized_copy(begin(), end(), new_storage.begin());
+      // move all elements into the newly allocated storage
+      new_end = m_storage.uninitialized_relocate(begin(), end(), new_storage.begin());
     } // end try
     catch(...)
     {
@@ -387,8 +436,8 @@ template<typename T, typename Alloc>
       throw;
     } // end catch
 
-    // call destructors on the elements in the old storage
-    m_storage.destroy(begin(), end());
+    // call destructors on the elements left in the old storage
+    m_storage.destroy_relocated(begin(), end());
 
     // record the vector's new state
     m_storage.swap(new_storage);
@@ -812,13 +861,7 @@ template<typename T, typename Alloc>
       const size_type old_size = size();
 
       // compute the new capacity after the allocation
-      size_type new_capacity = old_size + thrust::max THRUST_PREVENT_MACRO_SUBSTITUTION (old_size, num_new_elements);
-
-      // allocate exponentially larger new storage
-      new_capacity = thrust::max THRUST_PREVENT_MACRO_SUBSTITUTION <size_type>(new_capacity, 2 * capacity());
-
-      // do not exceed maximum storage
-      new_capacity = thrust::min THRUST_PREVENT_MACRO_SUBSTITUTION <size_type>(new_capacity, max_size());
+      size_type new_capacity = next_capacity(old_size + num_new_elements);
 
       if(new_capacity > max_size())
       {
@@ -827,34 +870,38 @@ template<typename T, typename Alloc>
 
       storage_type new_storage(copy_allocator_t(), m_storage, new_capacity);
 
-      // record how many constructors we invoke in the try block below
+      // record how many elements we move and construct in the try block below
+      iterator relocated_end = new_storage.begin();
       iterator new_end = new_storage.begin();
 
       try
       {
-        // construct copy elements before the insertion to the beginning of the newly
+        // move elements before the insertion to the beginning of the newly
         // allocated storage
-        new_end = m_storage.uninitialized_copy(begin(), position, new_storage.begin());
+        new_end = m_storage.uninitialized_relocate(begin(), position, new_storage.begin());
+        relocated_end = new_end;
 
         // construct copy elements to insert
         new_end = m_storage.uninitialized_copy(first, last, new_end);
 
-        // construct copy displaced elements from the old storage to the new storage
+        // move displaced elements from the old storage to the new storage
         // remember [position, end()) refers to the old storage
-        new_end = m_storage.uninitialized_copy(position, end(), new_end);
+        new_end = m_storage.uninitialized_relocate(position, end(), new_end);
       } // end try
       catch(...)
       {
-        // something went wrong, so destroy & deallocate the new storage
-        m_storage.destroy(new_storage.begin(), new_end);
+        // something went wrong, so destroy & deallocate the new storage; the
+        // old storage still owns the elements moved there bytewise
+        m_storage.destroy_relocated(new_storage.begin(), relocated_end);
+        m_storage.destroy(relocated_end, new_end);
         new_storage.deallocate();
 
         // rethrow
         throw;
       } // end catch
 
-      // call destructors on the elements in the old storage
-      m_storage.destroy(begin(), end());
+      // call destructors on the elements left in the old storage
+      m_storage.destroy_relocated(begin(), end());
 
       // record the vector's new state
       m_storage.swap(new_storage);
@@ -865,7 +912,7 @@ template<typename T, typename Alloc>
 
 template<typename T, typename Alloc>
   void vector_base<T,Alloc>
-    ::append(size_type n)
+    ::append(size_type n, bool leave_uninitialized)
 {
   if(n != 0)
   {
@@ -874,7 +921,7 @@ template<typename T, typename Alloc>
       // we've got room for all of them
 
       // default construct new elements at the end of the vector
-      m_storage.default_construct_n(end(), n);
+      default_construct_n(m_storage, end(), n, leave_uninitialized);
 
       // extend the size
       m_size += n;
@@ -884,41 +931,39 @@ template<typename T, typename Alloc>
       const size_type old_size = size();
 
       // compute the new capacity after the allocation
-      size_type new_capacity = old_size + thrust::max THRUST_PREVENT_MACRO_SUBSTITUTION (old_size, n);
-
-      // allocate exponentially larger new storage
-      new_capacity = thrust::max THRUST_PREVENT_MACRO_SUBSTITUTION <size_type>(new_capacity, 2 * capacity());
-
-      // do not exceed maximum storage
-      new_capacity = thrust::min THRUST_PREVENT_MACRO_SUBSTITUTION <size_type>(new_capacity, max_size());
+      size_type new_capacity = next_capacity(old_size + n);
 
       // create new storage
       storage_type new_storage(copy_allocator_t(), m_storage, new_capacity);
 
-      // record how many constructors we invoke in the try block below
+      // record how many elements we move and construct in the try block below
+      iterator relocated_end = new_storage.begin();
       iterator new_end = new_storage.begin();
 
       try
       {
-        // construct copy all elements into the newly allocated storage
-        new_end = m_storage.uninitialized_copy(begin(), end(), new_storage.begin());
+        // move all elements into the newly allocated storage
+        new_end = m_storage.uninitialized_relocate(begin(), end(), new_storage.begin());
+        relocated_end = new_end;
 
         // construct new elements to insert
-        new_storage.default_construct_n(new_end, n);
+        default_construct_n(new_storage, new_end, n, leave_uninitialized);
         new_end += n;
       } // end try
       catch(...)
       {
-        // something went wrong, so destroy & deallocate the new storage
-        new_storage.destroy(new_storage.begin(), new_end);
+        // something went wrong, so destroy & deallocate the new storage; the
+        // old storage still owns the elements moved there bytewise
+        new_storage.destroy_relocated(new_storage.begin(), relocated_end);
+        new_storage.destroy(relocated_end, new_end);
         new_storage.deallocate();
 
         // rethrow
         throw;
       } // end catch
 
-      // call destructors on the elements in the old storage
-      m_storage.destroy(begin(), end());
+      // call destructors on the elements left in the old storage
+      m_storage.destroy_relocated(begin(), end());
 
       // record the vector's new state
       m_storage.swap(new_storage);
@@ -927,6 +972,110 @@ template<typename T, typename Alloc>
   } // end if
 } // end vector_base::append()
 
+template<typename T, typename Alloc>
+  template<typename InputIterator>
+    void vector_base<T,Alloc>
+      ::append(InputIterator first, InputIterator last)
+{
+  // dispatch on traversal
+  range_append(first, last,
+    typename thrust::iterator_traversal<InputIterator>::type());
+} // end vector_base::append()
+
+template<typename T, typename Alloc>
+  template<typename InputIterator>
+    void vector_base<T,Alloc>
+      ::range_append(InputIterator first,
+                     InputIterator last,
+                     thrust::incrementable_traversal_tag)
+{
+  for(; first != last; ++first)
+    push_back(*first);
+} // end vector_base::range_append()
+
+template<typename T, typename Alloc>
+  template<typename RandomAccessIterator>
+    void vector_base<T,Alloc>
+      ::range_append(RandomAccessIterator first,
+                     RandomAccessIterator last,
+                     thrust::random_access_traversal_tag)
+{
+  const size_type n = thrust::distance(first, last);
+
+  if(n != 0)
+  {
+    if(capacity() - size() >= n)
+    {
+      // we've got room for all of them
+
+      // construct copy the new elements at the end of the vector
+      m_storage.uninitialized_copy(first, last, end());
+
+      // extend the size
+      m_size += n;
+    } // end if
+    else
+    {
+      const size_type old_size = size();
+
+      if(n > max_size() - old_size)
+      {
+        throw std::length_error("append(): appending exceeds max_size().");
+      } // end if
+
+      // compute the new capacity after the allocation
+      size_type new_capacity = next_capacity(old_size + n);
+
+      // create new storage
+      storage_type new_storage(copy_allocator_t(), m_storage, new_capacity);
+
+      // record how many elements we move and construct in the try block below
+      iterator relocated_end = new_storage.begin();
+      iterator new_end = new_storage.begin();
+
+      try
+      {
+        // move all elements into the newly allocated storage
+        new_end = m_storage.uninitialized_relocate(begin(), end(), new_storage.begin());
+        relocated_end = new_end;
+
+        // construct copy the new elements after them; [first, last) may
+        // refer to the old storage, which still holds the elements
+        new_end = m_storage.uninitialized_copy(first, last, new_end);
+      } // end try
+      catch(...)
+      {
+        // something went wrong, so destroy & deallocate the new storage; the
+        // old storage still owns the elements moved there bytewise
+        new_storage.destroy_relocated(new_storage.begin(), relocated_end);
+        new_storage.destroy(relocated_end, new_end);
+        new_storage.deallocate();
+
+        // rethrow
+        throw;
+      } // end catch
+
+      // call destructors on the elements left in the old storage
+      m_storage.destroy_relocated(begin(), end());
+
+      // record the vector's new state
+      m_storage.swap(new_storage);
+      m_size    = old_size + n;
+    } // end else
+  } // end if
+} // end vector_base::range_append()
+
+template<typename T, typename Alloc>
+  typename vector_base<T,Alloc>::size_type
+    vector_base<T,Alloc>
+      ::next_capacity(size_type required_capacity) const
+{
+  size_type new_capacity = growth_policy::template next_capacity<T>(capacity(), required_capacity);
+
+  // do not exceed maximum storage
+  return thrust::min THRUST_PREVENT_MACRO_SUBSTITUTION <size_type>(new_capacity, max_size());
+} // end vector_base::next_capacity()
+
 template<typename T, typename Alloc>
   void vector_base<T,Alloc>
     ::fill_insert(iterator position, size_type n, const T &x)
@@ -980,13 +1129,7 @@ template<typename T, typename Alloc>
       const size_type old_size = size();
 
       // compute the new capacity after the allocation
-      size_type new_capacity = old_size + thrust::max THRUST_PREVENT_MACRO_SUBSTITUTION (old_size, n);
-
-      // allocate exponentially larger new storage
-      new_capacity = thrust::max THRUST_PREVENT_MACRO_SUBSTITUTION <size_type>(new_capacity, 2 * capacity());
-
-      // do not exceed maximum storage
-      new_capacity = thrust::min THRUST_PREVENT_MACRO_SUBSTITUTION <size_type>(new_capacity, max_size());
+      size_type new_capacity = next_capacity(old_size + n);
 
       if(new_capacity > max_size())
       {
@@ -995,35 +1138,39 @@ template<typename T, typename Alloc>
 
       storage_type new_storage(copy_allocator_t(), m_storage, new_capacity);
 
-      // record how many constructors we invoke in the try block below
+      // record how many elements we move and construct in the try block below
+      iterator relocated_end = new_storage.begin();
       iterator new_end = new_storage.begin();
 
       try
       {
-        // construct copy elements before the insertion to the beginning of the newly
+        // move elements before the insertion to the beginning of the newly
         // allocated storage
-        new_end = m_storage.uninitialized_copy(begin(), position, new_storage.begin());
+        new_end = m_storage.uninitialized_relocate(begin(), position, new_storage.begin());
+        relocated_end = new_end;
 
         // construct new elements to insert
         m_storage.uninitialized_fill_n(new_end, n, x);
         new_end += n;
 
-        // construct copy displaced elements from the old storage to the new storage
+        // move displaced elements from the old storage to the new storage
         // remember [position, end()) refers to the old storage
-        new_end = m_storage.uninitialized_copy(position, end(), new_end);
+        new_end = m_storage.uninitialized_relocate(position, end(), new_end);
       } // end try
       catch(...)
       {
-        // something went wrong, so destroy & deallocate the new storage
-        m_storage.destroy(new_storage.begin(), new_end);
+        // something went wrong, so destroy & deallocate the new storage; the
+        // old storage still owns the elements moved there bytewise
+        m_storage.destroy_relocated(new_storage.begin(), relocated_end);
+        m_storage.destroy(relocated_end, new_end);
         new_storage.deallocate();
 
         // rethrow
         throw;
       } // end catch
 
-      // call destructors on the elements in the old storage
-      m_storage.destroy(begin(), end());
+      // call destructors on the elements left in the old storage
+      m_storage.destroy_relocated(begin(), end());
 
       // record the vector's new state
       m_storage.swap(new_storage);
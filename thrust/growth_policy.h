@@ -0,0 +1,244 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file growth_policy.h
+ *  \brief Policies deciding how much the vectors grow their storage by when
+ *         they run out of capacity.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/detail/allocator/allocator_traits.h>
+#include <thrust/detail/allocator/copy_construct_range.h>
+#include <thrust/detail/allocator/default_construct_range.h>
+#include <thrust/detail/allocator/destroy_range.h>
+#include <thrust/detail/allocator/fill_construct_range.h>
+#include <thrust/detail/allocator/relocate_range.h>
+#include <thrust/detail/static_assert.h>
+#include <thrust/detail/type_traits.h>
+#include <thrust/detail/type_traits/has_nested_type.h>
+
+#include <cstddef>
+
+THRUST_NAMESPACE_BEGIN
+
+/*! \addtogroup container_classes Container Classes
+ *  \{
+ */
+
+/*! \p geometric_growth is a growth policy which multiplies the capacity of a
+ *  vector by <tt>Numerator / Denominator</tt> whenever it runs out of room,
+ *  which keeps the cost of appending elements one at a time amortized
+ *  constant. The default, a factor of 2, is the growth of \p host_vector and
+ *  \p device_vector; smaller factors, such as 3/2, waste less memory on large
+ *  vectors.
+ *
+ *  A growth policy is a type with a static member function template
+ *  <tt>next_capacity<T>(capacity, required_capacity)</tt>, returning the
+ *  capacity to allocate for a vector of elements of type \c T, whose current
+ *  capacity is \p capacity, to hold \p required_capacity elements. The vectors
+ *  use the growth policy of their allocator, which \p growth_policy_allocator
+ *  sets.
+ *
+ *  \tparam Numerator The numerator of the growth factor.
+ *  \tparam Denominator The denominator of the growth factor.
+ *
+ *  \see growth_policy_allocator
+ */
+template<std::size_t Numerator = 2, std::size_t Denominator = 1>
+  struct geometric_growth
+{
+  THRUST_STATIC_ASSERT_MSG(Numerator > Denominator, "the growth factor must be greater than 1");
+
+  /*! \return The capacity to allocate to hold \p required_capacity elements.
+   */
+  template<typename T, typename Size>
+  __host__ __device__
+  static Size next_capacity(Size capacity, Size required_capacity)
+  {
+    // capacity * Numerator / Denominator, without overflowing before it has to
+    const Size grown = capacity + capacity / Denominator * (Numerator - Denominator)
+                     + capacity % Denominator * (Numerator - Denominator) / Denominator;
+
+    return grown > required_capacity ? grown : required_capacity;
+  }
+};
+
+/*! \p capped_growth is a growth policy which grows the capacity of a vector
+ *  geometrically, like \p geometric_growth, until a single step would add more
+ *  than \p MaxStepBytes bytes; from then on, it adds \p MaxStepBytes bytes at
+ *  a time. It bounds the memory a large vector wastes at the cost of more
+ *  frequent reallocations: appending elements one at a time is then no longer
+ *  amortized constant, and \p MaxStepBytes should be large compared to the
+ *  size of a typical append.
+ *
+ *  \tparam MaxStepBytes The largest number of bytes a single growth adds.
+ *  \tparam Numerator The numerator of the growth factor.
+ *  \tparam Denominator The denominator of the growth factor.
+ */
+template<std::size_t MaxStepBytes, std::size_t Numerator = 2, std::size_t Denominator = 1>
+  struct capped_growth
+{
+  THRUST_STATIC_ASSERT_MSG(MaxStepBytes > 0, "the growth step must not be empty");
+
+  /*! \return The capacity to allocate to hold \p required_capacity elements.
+   */
+  template<typename T, typename Size>
+  __host__ __device__
+  static Size next_capacity(Size capacity, Size required_capacity)
+  {
+    const Size max_step = MaxStepBytes / sizeof(T) > 0 ? static_cast<Size>(MaxStepBytes / sizeof(T)) : Size(1);
+
+    Size grown = geometric_growth<Numerator, Denominator>::template next_capacity<T>(capacity, Size(0));
+    if(grown - capacity > max_step)
+    {
+      grown = capacity + max_step;
+    }
+
+    return grown > required_capacity ? grown : required_capacity;
+  }
+};
+
+/*! \p default_growth is the growth policy of the vectors whose allocator does
+ *  not name one, which doubles their capacity.
+ */
+typedef geometric_growth<> default_growth;
+
+/*! \p growth_policy_allocator adapts an allocator to give the vectors using
+ *  it the growth policy \p GrowthPolicy. It allocates through \p Alloc, and
+ *  differs from it only by its nested \c growth_policy type.
+ *
+ *  \code
+ *  #include <thrust/growth_policy.h>
+ *  #include <thrust/host_vector.h>
+ *  ...
+ *  // grow by half the capacity, and by at most 256 MiB at a time
+ *  typedef thrust::growth_policy_allocator<
+ *    std::allocator<float>,
+ *    thrust::capped_growth<(std::size_t(256) << 20), 3, 2>
+ *  > allocator;
+ *
+ *  thrust::host_vector<float, allocator> v;
+ *  \endcode
+ *
+ *  \tparam Alloc The allocator to adapt.
+ *  \tparam GrowthPolicy The growth policy, such as \p geometric_growth or
+ *          \p capped_growth.
+ */
+template<typename Alloc, typename GrowthPolicy>
+  class growth_policy_allocator : public Alloc
+{
+  public:
+    /*! The growth policy of the vectors using this allocator. */
+    typedef GrowthPolicy growth_policy;
+
+    /*! The \p growth_policy_allocator of another element type, with the same
+     *  growth policy.
+     */
+    template<typename U>
+      struct rebind
+    {
+      typedef growth_policy_allocator<
+        typename thrust::detail::allocator_traits_detail::rebind_alloc<Alloc, U>::type,
+        GrowthPolicy
+      > other;
+    };
+
+    /*! Default constructor adapts a default constructed \p Alloc.
+     */
+    __host__ __device__
+    growth_policy_allocator() : Alloc() {}
+
+    /*! This constructor adapts a copy of an existing allocator.
+     *  \param alloc The allocator to adapt.
+     */
+    __host__ __device__
+    growth_policy_allocator(const Alloc &alloc) : Alloc(alloc) {}
+
+    /*! Converting constructor from the \p growth_policy_allocator of another
+     *  element type.
+     */
+    template<typename OtherAlloc>
+    __host__ __device__
+    growth_policy_allocator(const growth_policy_allocator<OtherAlloc, GrowthPolicy> &other)
+      : Alloc(static_cast<const OtherAlloc &>(other))
+    {}
+};
+
+/*! \} // container_classes
+ */
+
+namespace detail
+{
+
+__THRUST_DEFINE_HAS_NESTED_TYPE(has_growth_policy, growth_policy)
+
+template<typename Alloc>
+  struct nested_growth_policy
+{
+  typedef typename Alloc::growth_policy type;
+};
+
+// the growth policy of the vectors using an allocator: its nested
+// growth_policy type if it has one, and default_growth otherwise
+template<typename Alloc>
+  struct allocator_growth_policy
+    : eval_if<
+        has_growth_policy<Alloc>::value,
+        nested_growth_policy<Alloc>,
+        identity_<thrust::default_growth>
+      >
+{};
+
+// growth_policy_allocator only adds a growth policy to Alloc, so its construct
+// and destroy members have the effects of those of Alloc; in particular, the
+// shortcuts the vectors take for std::allocator, such as leaving the elements
+// of default_init uninitialized and relocating them bytewise, still apply
+template<typename Alloc, typename GrowthPolicy, typename T>
+  struct is_trivially_relocatable_with_allocator<growth_policy_allocator<Alloc, GrowthPolicy>, T>
+    : is_trivially_relocatable_with_allocator<Alloc, T>
+{};
+
+namespace allocator_traits_detail
+{
+
+template<typename Alloc, typename GrowthPolicy, typename T>
+  struct needs_default_construct_via_allocator<growth_policy_allocator<Alloc, GrowthPolicy>, T>
+    : needs_default_construct_via_allocator<Alloc, T>
+{};
+
+template<typename Alloc, typename GrowthPolicy, typename T>
+  struct needs_copy_construct_via_allocator<growth_policy_allocator<Alloc, GrowthPolicy>, T>
+    : needs_copy_construct_via_allocator<Alloc, T>
+{};
+
+template<typename Alloc, typename GrowthPolicy, typename T, typename Arg1>
+  struct has_effectful_member_construct2<growth_policy_allocator<Alloc, GrowthPolicy>, T, Arg1>
+    : has_effectful_member_construct2<Alloc, T, Arg1>
+{};
+
+template<typename Alloc, typename GrowthPolicy, typename T>
+  struct has_effectful_member_destroy<growth_policy_allocator<Alloc, GrowthPolicy>, T>
+    : has_effectful_member_destroy<Alloc, T>
+{};
+
+} // end allocator_traits_detail
+
+} // end detail
+
+THRUST_NAMESPACE_END
@@ -1,5 +1,6 @@
 /*
  *  Copyright 2008-2018 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -99,6 +100,25 @@ template<typename T, typename Alloc = std::allocator<T> >
     explicit host_vector(size_type n, const Alloc &alloc)
       :Parent(n,alloc) {}
 
+    /*! This constructor creates a \p host_vector with the given size, whose
+     *  elements are default-initialized: they are left uninitialized if
+     *  \c T is trivially constructible.
+     *  \param n The number of elements to initially create.
+     */
+    __host__
+    host_vector(size_type n, default_init_t)
+      :Parent(n,default_init_t()) {}
+
+    /*! This constructor creates a \p host_vector with the given size, whose
+     *  elements are default-initialized: they are left uninitialized if
+     *  \c T is trivially constructible.
+     *  \param n The number of elements to initially create.
+     *  \param alloc The allocator to use by this host_vector.
+     */
+    __host__
+    host_vector(size_type n, default_init_t, const Alloc &alloc)
+      :Parent(n,default_init_t(),alloc) {}
+
     /*! This constructor creates a \p host_vector with copies
      *  of an exemplar element.
      *  \param n The number of elements to initially create.
@@ -251,6 +271,18 @@ template<typename T, typename Alloc = std::allocator<T> >
      */
     void resize(size_type new_size, const value_type &x = value_type());
 
+    /*! \brief Resizes this vector to the specified number of elements.
+     *  \param new_size Number of elements this vector should contain.
+     *  \throw std::length_error If n exceeds max_size().
+     *
+     *  This method will resize this vector to the specified number of
+     *  elements.  If the number is smaller than this vector's current
+     *  size this vector is truncated, otherwise this vector is
+     *  extended and new elements are default-initialized, which leaves
+     *  them uninitialized if \c T is trivially constructible.
+     */
+    void resize(size_type new_size, default_init_t);
+
     /*! Returns the number of elements in this vector.
      */
     size_type size(void) const;
@@ -474,6 +506,21 @@ template<typename T, typename Alloc = std::allocator<T> >
     template<typename InputIterator>
     void insert(iterator position, InputIterator first, InputIterator last);
 
+    /*! This method appends a copy of an input range to the end of this
+     *  vector. Unlike \p insert at \p end(), it constructs the new elements
+     *  in place with the algorithms of the allocator's system, and
+     *  reallocates at most once, to the capacity the growth policy of the
+     *  allocator gives.
+     *  \param first The beginning of the range to copy.
+     *  \param last  The end of the range to copy.
+     *
+     *  \tparam InputIterator is a model of <a href="https://en.cppreference.com/w/cpp/named_req/InputIterator">Input Iterator</a>.
+     *
+     *  \see growth_policy_allocator
+     */
+    template<typename InputIterator>
+    void append(InputIterator first, InputIterator last);
+
     /*! This version of \p assign replicates a given exemplar
      *  \p n times into this vector.
      *  \param n The number of times to copy \p x.
@@ -0,0 +1,768 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file concurrent_pool.h
+ *  \brief A thread-safe pooling memory resource adaptor with per-thread caches
+ *  of blocks and a lock-free depot shared between the threads.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/detail/cpp11_required.h>
+
+#if THRUST_CPP_DIALECT >= 2011
+
+#include <thrust/detail/algorithm_wrapper.h>
+#include <thrust/detail/integer_math.h>
+
+#include <thrust/mr/memory_resource.h>
+#include <thrust/mr/pool.h>
+#include <thrust/mr/pool_options.h>
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+THRUST_NAMESPACE_BEGIN
+namespace mr
+{
+
+/*! \addtogroup memory_resources Memory Resources
+ *  \ingroup memory_management
+ *  \{
+ */
+
+/*! A thread-safe memory resource adaptor pooling and caching allocations from \p Upstream, meant for many threads
+ *      allocating and deallocating concurrently.
+ *
+ *  \p synchronized_pool_resource serializes every allocation and deallocation on a single mutex, and \p tls_pool
+ *      gives every thread a private pool which never hands the blocks freed by one thread to another one. This resource
+ *      sits in between: every thread caches up to two magazines, i.e. fixed-capacity stacks of free blocks, for every
+ *      size class of the pool, and allocates from and deallocates to them without any synchronization. Only when both
+ *      magazines of a size class run empty (or full) does a thread exchange a whole magazine with a lock-free depot
+ *      shared by all threads, so that blocks freed by one thread are reused by the others in batches.
+ *
+ *  The blocks of a size class are carved out of chunks allocated from \p Upstream, sized the same way as in
+ *      \p unsynchronized_pool_resource. When a thread exits, the blocks it has cached are returned to the depot, and
+ *      every chunk none of whose blocks is then in use is returned to \p Upstream.
+ *
+ *  The bookkeeping is kept on the host, disjoint from the blocks, so the memory allocated from \p Upstream is never
+ *      accessed, and may as well be device memory. All the calls to \p Upstream are serialized, so \p Upstream itself
+ *      does not need to be thread-safe.
+ *
+ *  Oversized and overaligned requests bypass the size classes. They are forwarded to \p Upstream and returned to it
+ *      on deallocation; \p pool_options::cache_oversized is not honored. Neither are the caps and the decay interval:
+ *      the chunks are returned to \p Upstream when the threads caching their blocks exit.
+ *
+ *  \tparam Upstream the type of memory resources that will be used for allocating memory blocks
+ */
+template<typename Upstream>
+class concurrent_pool_resource final
+    : public memory_resource<typename Upstream::pointer>,
+        private validator<Upstream>
+{
+    typedef typename Upstream::pointer void_ptr;
+    typedef typename thrust::detail::pointer_traits<void_ptr>::template rebind<char>::other char_ptr;
+
+    typedef std::lock_guard<std::mutex> lock_t;
+
+public:
+    /*! Get the default options for a pool. These are meant to be a sensible set of values for many use cases,
+     *      and as such, may be tuned in the future. This function is exposed so that creating a set of options that are
+     *      just a slight departure from the defaults is easy.
+     */
+    static pool_options get_default_options()
+    {
+        return unsynchronized_pool_resource<Upstream>::get_default_options();
+    }
+
+    /*! Constructor.
+     *
+     *  \param upstream the upstream memory resource for allocations
+     *  \param options pool options to use
+     */
+    concurrent_pool_resource(Upstream * upstream, pool_options options = get_default_options())
+        : m_upstream(upstream),
+        m_options(options),
+        m_smallest_block_log2(detail::log2_ri(m_options.smallest_block_size)),
+        m_id(next_id()),
+        m_pools(),
+        m_pool_count(0),
+        m_magazine_count(0)
+    {
+        assert(m_options.validate());
+
+        m_pool_count = detail::log2_ri(m_options.largest_block_size) - m_smallest_block_log2 + 1;
+        m_pools.reset(new pool[m_pool_count]);
+
+        for (std::size_t i = 0; i < m_pool_count; ++i)
+        {
+            std::size_t capacity = magazine_bytes >> (m_smallest_block_log2 + i);
+            m_pools[i].magazine_capacity = (std::min)((std::max)(capacity, static_cast<std::size_t>(1)), static_cast<std::size_t>(max_magazine_size));
+        }
+
+        for (std::size_t i = 0; i < max_segments; ++i)
+        {
+            m_segments[i].store(NULL, std::memory_order_relaxed);
+        }
+    }
+
+    /*! Constructor. The upstream resource is obtained by calling \p get_global_resource<Upstream>.
+     *
+     *  \param options pool options to use
+     */
+    concurrent_pool_resource(pool_options options = get_default_options())
+        : concurrent_pool_resource(get_global_resource<Upstream>(), options)
+    {
+    }
+
+    /*! Destructor. Releases all held memory to upstream. Threads which still cache blocks of this resource drop
+     *      them when they exit.
+     */
+    ~concurrent_pool_resource()
+    {
+        std::vector<std::shared_ptr<thread_cache> > caches;
+
+        {
+            lock_t lock(m_mutex);
+            caches.swap(m_caches);
+        }
+
+        for (std::size_t i = 0; i < caches.size(); ++i)
+        {
+            lock_t lock(caches[i]->mutex);
+            caches[i]->owner = NULL;
+        }
+
+        release();
+
+        for (std::size_t i = 0; i < max_segments; ++i)
+        {
+            delete[] m_segments[i].load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    // the bigger the blocks of a size class, the fewer of them a magazine holds,
+    // which bounds the memory a single thread may keep to itself
+    static const std::size_t max_magazine_size = 64;
+    static const std::size_t magazine_bytes = 64 * 1024;
+
+    // magazines are never freed before the resource itself is destroyed, and are
+    // addressed by index, so that the depot can tag its head against ABA
+    static const std::size_t first_segment_size = 16;
+    static const std::size_t max_segments = 32;
+
+    struct magazine
+    {
+        std::uint32_t index;
+        std::atomic<std::uint32_t> next;
+        std::size_t size;
+        void_ptr blocks[max_magazine_size];
+    };
+
+    // a lock-free stack of magazines; the head holds the index of the top
+    // magazine plus one in its lower half and a version tag in its upper half
+    class magazine_stack
+    {
+    public:
+        magazine_stack() : m_head(0)
+        {
+        }
+
+        void push(magazine * m)
+        {
+            std::uint64_t head = m_head.load(std::memory_order_relaxed);
+            std::uint64_t new_head;
+
+            do
+            {
+                m->next.store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+                new_head = next_tag(head) | (static_cast<std::uint64_t>(m->index) + 1);
+            }
+            while (!m_head.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        magazine * pop(concurrent_pool_resource & pool)
+        {
+            std::uint64_t head = m_head.load(std::memory_order_acquire);
+
+            while (true)
+            {
+                std::uint32_t top = static_cast<std::uint32_t>(head);
+                if (top == 0)
+                {
+                    return NULL;
+                }
+
+                magazine * m = pool.magazine_at(top - 1);
+                std::uint64_t new_head = next_tag(head) | m->next.load(std::memory_order_relaxed);
+
+                if (m_head.compare_exchange_weak(head, new_head, std::memory_order_acquire, std::memory_order_acquire))
+                {
+                    return m;
+                }
+            }
+        }
+
+    private:
+        static std::uint64_t next_tag(std::uint64_t head)
+        {
+            return ((head >> 32) + 1) << 32;
+        }
+
+        std::atomic<std::uint64_t> m_head;
+    };
+
+    struct chunk
+    {
+        void_ptr pointer;
+        std::size_t blocks;
+        std::size_t free_blocks;
+    };
+
+    struct pool
+    {
+        pool() : magazine_capacity(0), previous_allocated_count(0)
+        {
+        }
+
+        std::size_t magazine_capacity;
+        magazine_stack full;
+
+        // guarded by m_mutex
+        std::size_t previous_allocated_count;
+        std::vector<chunk> chunks;
+    };
+
+    struct oversized_block
+    {
+        void_ptr pointer;
+        std::size_t size;
+        std::size_t alignment;
+    };
+
+    // the magazines of one thread; owner is reset when the resource is destroyed
+    // before the thread exits
+    struct thread_cache
+    {
+        struct slot
+        {
+            magazine * loaded;
+            magazine * previous;
+        };
+
+        explicit thread_cache(concurrent_pool_resource * owner) : owner(owner), id(owner->m_id)
+        {
+        }
+
+        std::mutex mutex;
+        concurrent_pool_resource * owner;
+        const std::uint64_t id;
+        std::vector<slot> slots;
+    };
+
+    // the thread caches of every resource the calling thread has used; they are
+    // flushed back to their resources when the thread exits
+    struct thread_registry
+    {
+        ~thread_registry()
+        {
+            for (std::size_t i = 0; i < caches.size(); ++i)
+            {
+                lock_t lock(caches[i]->mutex);
+                if (caches[i]->owner)
+                {
+                    caches[i]->owner->detach(*caches[i]);
+                    caches[i]->owner = NULL;
+                }
+            }
+        }
+
+        thread_registry() : last(NULL)
+        {
+        }
+
+        std::vector<std::shared_ptr<thread_cache> > caches;
+        thread_cache * last;
+    };
+
+    typedef std::map<char *, oversized_block> oversized_map;
+
+    Upstream * m_upstream;
+
+    pool_options m_options;
+    std::size_t m_smallest_block_log2;
+
+    const std::uint64_t m_id;
+
+    std::unique_ptr<pool[]> m_pools;
+    std::size_t m_pool_count;
+    magazine_stack m_empty;
+
+    std::atomic<magazine *> m_segments[max_segments];
+
+    // guards the calls to upstream and everything below
+    std::mutex m_mutex;
+    std::size_t m_magazine_count;
+    oversized_map m_oversized;
+    std::vector<std::shared_ptr<thread_cache> > m_caches;
+
+    static std::uint64_t next_id()
+    {
+        static std::atomic<std::uint64_t> id(0);
+        return ++id;
+    }
+
+    static thread_registry & local_registry()
+    {
+        static thread_local thread_registry registry;
+        return registry;
+    }
+
+    static char * raw_address(void_ptr p)
+    {
+        return static_cast<char *>(static_cast<void *>(detail::pointer_traits<void_ptr>::get(p)));
+    }
+
+    magazine * magazine_at(std::uint32_t index) const
+    {
+        std::size_t segment = detail::log2(index / first_segment_size + 1);
+        std::size_t offset = index - first_segment_size * ((static_cast<std::size_t>(1) << segment) - 1);
+
+        return m_segments[segment].load(std::memory_order_acquire) + offset;
+    }
+
+    // requires m_mutex
+    magazine * new_magazine()
+    {
+        std::uint32_t index = static_cast<std::uint32_t>(m_magazine_count);
+        std::size_t segment = detail::log2(index / first_segment_size + 1);
+        std::size_t offset = index - first_segment_size * ((static_cast<std::size_t>(1) << segment) - 1);
+
+        assert(segment < max_segments);
+
+        if (offset == 0)
+        {
+            m_segments[segment].store(new magazine[first_segment_size << segment], std::memory_order_release);
+        }
+
+        magazine * m = m_segments[segment].load(std::memory_order_relaxed) + offset;
+        m->index = index;
+        m->size = 0;
+
+        ++m_magazine_count;
+        return m;
+    }
+
+    magazine * acquire_empty()
+    {
+        magazine * m = m_empty.pop(*this);
+        if (m)
+        {
+            return m;
+        }
+
+        lock_t lock(m_mutex);
+        return new_magazine();
+    }
+
+    thread_cache & local_cache()
+    {
+        thread_registry & registry = local_registry();
+        if (registry.last && registry.last->id == m_id)
+        {
+            return *registry.last;
+        }
+
+        for (std::size_t i = 0; i < registry.caches.size(); ++i)
+        {
+            if (registry.caches[i]->id == m_id)
+            {
+                registry.last = registry.caches[i].get();
+                return *registry.last;
+            }
+        }
+
+        // drop the caches of the resources destroyed in the meantime
+        for (std::size_t i = 0; i < registry.caches.size();)
+        {
+            bool dead;
+            {
+                lock_t lock(registry.caches[i]->mutex);
+                dead = registry.caches[i]->owner == NULL;
+            }
+
+            if (dead)
+            {
+                registry.caches.erase(registry.caches.begin() + i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        std::shared_ptr<thread_cache> cache = std::make_shared<thread_cache>(this);
+        cache->slots.resize(m_pool_count);
+        for (std::size_t i = 0; i < m_pool_count; ++i)
+        {
+            cache->slots[i].loaded = acquire_empty();
+            cache->slots[i].previous = acquire_empty();
+        }
+
+        {
+            lock_t lock(m_mutex);
+            m_caches.push_back(cache);
+        }
+
+        registry.caches.push_back(cache);
+        registry.last = cache.get();
+        return *cache;
+    }
+
+    // allocates a new chunk for the bucket from upstream and splits it into
+    // blocks, which fill the empty magazine m; the rest goes to the depot
+    void refill(std::size_t bucket_idx, magazine * m)
+    {
+        pool & bucket = m_pools[bucket_idx];
+        std::size_t bytes_log2 = bucket_idx + m_smallest_block_log2;
+        magazine * const first = m;
+
+        lock_t lock(m_mutex);
+
+        std::size_t n = bucket.previous_allocated_count;
+        if (n == 0)
+        {
+            n = m_options.min_blocks_per_chunk;
+            if (n < (m_options.min_bytes_per_chunk >> bytes_log2))
+            {
+                n = m_options.min_bytes_per_chunk >> bytes_log2;
+            }
+        }
+        else
+        {
+            n = n * 3 / 2;
+            if (n > (m_options.max_bytes_per_chunk >> bytes_log2))
+            {
+                n = m_options.max_bytes_per_chunk >> bytes_log2;
+            }
+            if (n > m_options.max_blocks_per_chunk)
+            {
+                n = m_options.max_blocks_per_chunk;
+            }
+        }
+
+        n = (std::max)(n, static_cast<std::size_t>(1));
+        bucket.previous_allocated_count = n;
+
+        void_ptr allocated = m_upstream->do_allocate(n << bytes_log2, m_options.alignment);
+
+        chunk c = { allocated, n, 0 };
+        bucket.chunks.push_back(c);
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (m->size == bucket.magazine_capacity)
+            {
+                if (m != first)
+                {
+                    bucket.full.push(m);
+                }
+
+                m = m_empty.pop(*this);
+                if (m == NULL)
+                {
+                    m = new_magazine();
+                }
+            }
+
+            m->blocks[m->size++] = static_cast<void_ptr>(
+                static_cast<char_ptr>(allocated) + (i << bytes_log2)
+            );
+        }
+
+        if (m != first)
+        {
+            bucket.full.push(m);
+        }
+    }
+
+    // returns the magazines of an exiting thread to the depot, and then the
+    // chunks which are left without any block in use to upstream
+    void detach(thread_cache & cache)
+    {
+        for (std::size_t i = 0; i < cache.slots.size(); ++i)
+        {
+            magazine * loaded = cache.slots[i].loaded;
+            magazine * previous = cache.slots[i].previous;
+
+            (loaded->size > 0 ? m_pools[i].full : m_empty).push(loaded);
+            (previous->size > 0 ? m_pools[i].full : m_empty).push(previous);
+        }
+
+        cache.slots.clear();
+
+        lock_t lock(m_mutex);
+
+        for (std::size_t i = 0; i < m_caches.size(); ++i)
+        {
+            if (m_caches[i].get() == &cache)
+            {
+                m_caches.erase(m_caches.begin() + i);
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i < m_pool_count; ++i)
+        {
+            reclaim(i);
+        }
+    }
+
+    struct chunk_address_less
+    {
+        bool operator()(const chunk & lhs, const chunk & rhs) const
+        {
+            return raw_address(lhs.pointer) < raw_address(rhs.pointer);
+        }
+
+        bool operator()(char * lhs, const chunk & rhs) const
+        {
+            return lhs < raw_address(rhs.pointer);
+        }
+    };
+
+    // requires m_mutex
+    // counts the free blocks of every chunk of the bucket among the magazines in
+    // the depot; the blocks still cached by the other threads count as used
+    void reclaim(std::size_t bucket_idx)
+    {
+        pool & bucket = m_pools[bucket_idx];
+        std::size_t bytes_log2 = bucket_idx + m_smallest_block_log2;
+
+        if (bucket.chunks.empty())
+        {
+            return;
+        }
+
+        std::vector<magazine *> magazines;
+        while (magazine * m = bucket.full.pop(*this))
+        {
+            magazines.push_back(m);
+        }
+
+        std::sort(bucket.chunks.begin(), bucket.chunks.end(), chunk_address_less());
+
+        for (std::size_t i = 0; i < bucket.chunks.size(); ++i)
+        {
+            bucket.chunks[i].free_blocks = 0;
+        }
+
+        for (std::size_t i = 0; i < magazines.size(); ++i)
+        {
+            for (std::size_t j = 0; j < magazines[i]->size; ++j)
+            {
+                typename std::vector<chunk>::iterator it = std::upper_bound(
+                    bucket.chunks.begin(), bucket.chunks.end(), raw_address(magazines[i]->blocks[j]), chunk_address_less());
+                assert(it != bucket.chunks.begin());
+                ++(it - 1)->free_blocks;
+            }
+        }
+
+        // drop the blocks of the chunks about to be freed from the magazines
+        for (std::size_t i = 0; i < magazines.size(); ++i)
+        {
+            magazine * m = magazines[i];
+
+            std::size_t size = 0;
+            for (std::size_t j = 0; j < m->size; ++j)
+            {
+                typename std::vector<chunk>::iterator it = std::upper_bound(
+                    bucket.chunks.begin(), bucket.chunks.end(), raw_address(m->blocks[j]), chunk_address_less());
+                if ((it - 1)->free_blocks != (it - 1)->blocks)
+                {
+                    m->blocks[size++] = m->blocks[j];
+                }
+            }
+            m->size = size;
+
+            (m->size > 0 ? bucket.full : m_empty).push(m);
+        }
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < bucket.chunks.size(); ++i)
+        {
+            chunk & c = bucket.chunks[i];
+            if (c.free_blocks == c.blocks)
+            {
+                m_upstream->do_deallocate(c.pointer, c.blocks << bytes_log2, m_options.alignment);
+            }
+            else
+            {
+                bucket.chunks[kept++] = c;
+            }
+        }
+        bucket.chunks.resize(kept);
+
+        if (kept == 0)
+        {
+            bucket.previous_allocated_count = 0;
+        }
+    }
+
+public:
+    /*! Releases all held memory to upstream. Must not be called concurrently with allocations or deallocations.
+     */
+    void release()
+    {
+        lock_t lock(m_mutex);
+
+        for (std::size_t i = 0; i < m_caches.size(); ++i)
+        {
+            for (std::size_t j = 0; j < m_caches[i]->slots.size(); ++j)
+            {
+                m_caches[i]->slots[j].loaded->size = 0;
+                m_caches[i]->slots[j].previous->size = 0;
+            }
+        }
+
+        for (std::size_t i = 0; i < m_pool_count; ++i)
+        {
+            pool & bucket = m_pools[i];
+            std::size_t bytes_log2 = i + m_smallest_block_log2;
+
+            while (magazine * m = bucket.full.pop(*this))
+            {
+                m->size = 0;
+                m_empty.push(m);
+            }
+
+            for (std::size_t j = 0; j < bucket.chunks.size(); ++j)
+            {
+                m_upstream->do_deallocate(bucket.chunks[j].pointer, bucket.chunks[j].blocks << bytes_log2, m_options.alignment);
+            }
+
+            bucket.chunks.clear();
+            bucket.previous_allocated_count = 0;
+        }
+
+        for (typename oversized_map::iterator it = m_oversized.begin(); it != m_oversized.end(); ++it)
+        {
+            m_upstream->do_deallocate(it->second.pointer, it->second.size, it->second.alignment);
+        }
+
+        m_oversized.clear();
+    }
+
+    THRUST_NODISCARD virtual void_ptr do_allocate(std::size_t bytes, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
+    {
+        bytes = (std::max)(bytes, m_options.smallest_block_size);
+        assert(detail::is_power_of_2(alignment));
+
+        // an oversized and/or overaligned allocation requested; needs to be allocated separately
+        if (bytes > m_options.largest_block_size || alignment > m_options.alignment)
+        {
+            lock_t lock(m_mutex);
+
+            void_ptr allocated = m_upstream->do_allocate(bytes, alignment);
+
+            oversized_block block = { allocated, bytes, alignment };
+            m_oversized.insert(std::make_pair(raw_address(allocated), block));
+
+            return allocated;
+        }
+
+        std::size_t bucket_idx = thrust::detail::log2_ri(bytes) - m_smallest_block_log2;
+        typename thread_cache::slot & slot = local_cache().slots[bucket_idx];
+
+        if (slot.loaded->size == 0)
+        {
+            if (slot.previous->size > 0)
+            {
+                std::swap(slot.loaded, slot.previous);
+            }
+            else if (magazine * full = m_pools[bucket_idx].full.pop(*this))
+            {
+                m_empty.push(slot.previous);
+                slot.previous = slot.loaded;
+                slot.loaded = full;
+            }
+            else
+            {
+                refill(bucket_idx, slot.loaded);
+            }
+        }
+
+        return slot.loaded->blocks[--slot.loaded->size];
+    }
+
+    virtual void do_deallocate(void_ptr p, std::size_t n, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
+    {
+        n = (std::max)(n, m_options.smallest_block_size);
+        assert(detail::is_power_of_2(alignment));
+
+        // verify that the pointer is at least as aligned as claimed
+        assert(reinterpret_cast<detail::intmax_t>(detail::pointer_traits<void_ptr>::get(p)) % alignment == 0);
+
+        // the deallocated block is oversized and/or overaligned
+        if (n > m_options.largest_block_size || alignment > m_options.alignment)
+        {
+            lock_t lock(m_mutex);
+
+            typename oversized_map::iterator it = m_oversized.find(raw_address(p));
+            assert(it != m_oversized.end());
+
+            m_upstream->do_deallocate(it->second.pointer, it->second.size, it->second.alignment);
+            m_oversized.erase(it);
+
+            return;
+        }
+
+        std::size_t bucket_idx = thrust::detail::log2_ri(n) - m_smallest_block_log2;
+        pool & bucket = m_pools[bucket_idx];
+        typename thread_cache::slot & slot = local_cache().slots[bucket_idx];
+
+        if (slot.loaded->size == bucket.magazine_capacity)
+        {
+            if (slot.previous->size == 0)
+            {
+                std::swap(slot.loaded, slot.previous);
+            }
+            else
+            {
+                bucket.full.push(slot.previous);
+                slot.previous = slot.loaded;
+                slot.loaded = acquire_empty();
+            }
+        }
+
+        slot.loaded->blocks[slot.loaded->size++] = p;
+    }
+};
+
+/*! \} // memory_resources
+ */
+
+} // end mr
+THRUST_NAMESPACE_END
+
+#endif // THRUST_CPP_DIALECT >= 2011
@@ -0,0 +1,489 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file oversized_index.h
+ *  \brief Indexes of the oversized and overaligned blocks of the disjoint pool
+ *  resource, kept in memory obtained from its bookkeeping resource.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+
+#include <thrust/host_vector.h>
+#include <thrust/detail/integer_math.h>
+#include <thrust/detail/type_traits/pointer_traits.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace detail
+{
+
+// an open-addressing hash table of blocks, keyed by their pointers
+//
+// the hash is taken from the raw address of a pointer, but the keys are
+// compared with operator==, so fancy pointers sharing a raw address are still
+// told apart (only slower)
+template<typename Block, typename Allocator>
+class oversized_block_table
+{
+public:
+    typedef std::size_t size_type;
+
+    static const size_type npos = static_cast<size_type>(-1);
+
+    explicit oversized_block_table(const Allocator & alloc)
+        : m_slots(slot_allocator(alloc)),
+        m_size(0),
+        m_shift(0)
+    {
+    }
+
+    size_type size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    // the number of slots; occupied slots are visited with occupied() and operator[]
+    size_type capacity() const
+    {
+        return m_slots.size();
+    }
+
+    bool occupied(size_type i) const
+    {
+        return m_slots[i].occupied;
+    }
+
+    const Block & operator[](size_type i) const
+    {
+        return m_slots[i].block;
+    }
+
+    template<typename Pointer>
+    size_type find(const Pointer & p) const
+    {
+        if (m_size == 0)
+        {
+            return npos;
+        }
+
+        const size_type mask = m_slots.size() - 1;
+
+        for (size_type i = hash(p); m_slots[i].occupied; i = (i + 1) & mask)
+        {
+            if (m_slots[i].block.pointer == p)
+            {
+                return i;
+            }
+        }
+
+        return npos;
+    }
+
+    void insert(const Block & block)
+    {
+        if (2 * (m_size + 1) > m_slots.size())
+        {
+            rehash((std::max)(static_cast<size_type>(16), 2 * m_slots.size()));
+        }
+
+        const size_type mask = m_slots.size() - 1;
+
+        size_type i = hash(block.pointer);
+        while (m_slots[i].occupied)
+        {
+            i = (i + 1) & mask;
+        }
+
+        m_slots[i].occupied = true;
+        m_slots[i].block = block;
+        ++m_size;
+    }
+
+    // removes the block in slot i, shifting back the blocks of its probe
+    // sequence, so that no tombstones are needed
+    void erase(size_type i)
+    {
+        const size_type mask = m_slots.size() - 1;
+
+        m_slots[i].occupied = false;
+        --m_size;
+
+        for (size_type j = (i + 1) & mask; m_slots[j].occupied; j = (j + 1) & mask)
+        {
+            const size_type home = hash(m_slots[j].block.pointer);
+
+            // the block in slot j stays if its home slot is cyclically within (i, j]
+            const bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+            if (stays)
+            {
+                continue;
+            }
+
+            m_slots[i] = m_slots[j];
+            m_slots[j].occupied = false;
+            i = j;
+        }
+    }
+
+    void clear()
+    {
+        m_slots.clear();
+        m_size = 0;
+        m_shift = 0;
+    }
+
+private:
+    struct slot
+    {
+        bool occupied;
+        Block block;
+    };
+
+    typedef typename Allocator::template rebind<slot>::other slot_allocator;
+    typedef thrust::host_vector<slot, slot_allocator> slot_vector;
+
+    template<typename Pointer>
+    size_type hash(const Pointer & p) const
+    {
+        // Fibonacci hashing of the address; the low bits are dropped, since they
+        // are zero for every block aligned beyond the pool's alignment
+        const unsigned long long address = reinterpret_cast<std::size_t>(pointer_traits<Pointer>::get(p));
+        return static_cast<size_type>(((address >> 4) * 11400714819323198485ull) >> m_shift);
+    }
+
+    void rehash(size_type capacity)
+    {
+        slot empty_slot;
+        empty_slot.occupied = false;
+        empty_slot.block = Block();
+
+        slot_vector slots(capacity, empty_slot, m_slots.get_allocator());
+        slots.swap(m_slots);
+
+        m_shift = 8 * sizeof(unsigned long long) - log2(capacity);
+        m_size = 0;
+
+        for (size_type i = 0; i < slots.size(); ++i)
+        {
+            if (slots[i].occupied)
+            {
+                insert(slots[i].block);
+            }
+        }
+    }
+
+    slot_vector m_slots;
+    size_type m_size;
+    size_type m_shift;
+};
+
+
+// a treap of cached blocks ordered by size and then alignment, giving the
+// best fitting block for a request in logarithmic expected time
+//
+// every node also keeps the largest alignment found in its subtree, so that
+// subtrees without any sufficiently aligned block are skipped by best_fit
+template<typename Block, typename Allocator>
+class cached_block_tree
+{
+public:
+    typedef std::size_t size_type;
+
+    static const size_type npos = static_cast<size_type>(-1);
+
+    explicit cached_block_tree(const Allocator & alloc)
+        : m_nodes(node_allocator(alloc)),
+        m_root(npos),
+        m_free(npos),
+        m_size(0),
+        m_seed(2463534242u)
+    {
+    }
+
+    size_type size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    const Block & operator[](size_type n) const
+    {
+        return m_nodes[n].block;
+    }
+
+    // returns the node of the inserted block, valid until it is erased
+    size_type insert(const Block & block)
+    {
+        size_type n = m_free;
+        if (n != npos)
+        {
+            m_free = m_nodes[n].left;
+        }
+        else
+        {
+            n = m_nodes.size();
+            m_nodes.push_back(node());
+        }
+
+        m_nodes[n].block = block;
+        m_nodes[n].priority = next_priority();
+        m_nodes[n].left = npos;
+        m_nodes[n].right = npos;
+        m_nodes[n].max_alignment = block.alignment;
+
+        m_root = insert_at(m_root, n);
+        ++m_size;
+
+        return n;
+    }
+
+    void erase(size_type n)
+    {
+        m_root = erase_at(m_root, n);
+        --m_size;
+
+        m_nodes[n].left = m_free;
+        m_free = n;
+    }
+
+    // the smallest block, by size and then alignment, of at least the given
+    // size and alignment, or npos if there is none
+    size_type best_fit(std::size_t size, std::size_t alignment) const
+    {
+        return best_fit_at(m_root, size, alignment);
+    }
+
+    // the largest block, or npos if the tree is empty
+    size_type largest() const
+    {
+        size_type n = m_root;
+        while (n != npos && m_nodes[n].right != npos)
+        {
+            n = m_nodes[n].right;
+        }
+        return n;
+    }
+
+    void clear()
+    {
+        m_nodes.clear();
+        m_root = npos;
+        m_free = npos;
+        m_size = 0;
+    }
+
+private:
+    struct node
+    {
+        Block block;
+        unsigned int priority;
+        size_type left;
+        size_type right;
+        std::size_t max_alignment;
+    };
+
+    typedef typename Allocator::template rebind<node>::other node_allocator;
+    typedef thrust::host_vector<node, node_allocator> node_vector;
+
+    unsigned int next_priority()
+    {
+        // xorshift32
+        m_seed ^= m_seed << 13;
+        m_seed ^= m_seed >> 17;
+        m_seed ^= m_seed << 5;
+        return m_seed;
+    }
+
+    // orders the nodes by size, alignment and then by node, so that equal blocks
+    // are still distinct keys
+    bool less(size_type a, size_type b) const
+    {
+        const Block & x = m_nodes[a].block;
+        const Block & y = m_nodes[b].block;
+
+        if (x.size != y.size) return x.size < y.size;
+        if (x.alignment != y.alignment) return x.alignment < y.alignment;
+        return a < b;
+    }
+
+    void update(size_type t)
+    {
+        std::size_t max_alignment = m_nodes[t].block.alignment;
+
+        if (m_nodes[t].left != npos)
+        {
+            max_alignment = (std::max)(max_alignment, m_nodes[m_nodes[t].left].max_alignment);
+        }
+        if (m_nodes[t].right != npos)
+        {
+            max_alignment = (std::max)(max_alignment, m_nodes[m_nodes[t].right].max_alignment);
+        }
+
+        m_nodes[t].max_alignment = max_alignment;
+    }
+
+    // splits the subtree t into the nodes ordered before n and the rest
+    void split(size_type t, size_type n, size_type & left, size_type & right)
+    {
+        if (t == npos)
+        {
+            left = npos;
+            right = npos;
+            return;
+        }
+
+        size_type l, r;
+        if (less(t, n))
+        {
+            split(m_nodes[t].right, n, l, r);
+            m_nodes[t].right = l;
+            update(t);
+            left = t;
+            right = r;
+        }
+        else
+        {
+            split(m_nodes[t].left, n, l, r);
+            m_nodes[t].left = r;
+            update(t);
+            left = l;
+            right = t;
+        }
+    }
+
+    // merges the subtrees a and b, every node of a being ordered before b
+    size_type merge(size_type a, size_type b)
+    {
+        if (a == npos) return b;
+        if (b == npos) return a;
+
+        if (m_nodes[a].priority > m_nodes[b].priority)
+        {
+            size_type r = merge(m_nodes[a].right, b);
+            m_nodes[a].right = r;
+            update(a);
+            return a;
+        }
+
+        size_type l = merge(a, m_nodes[b].left);
+        m_nodes[b].left = l;
+        update(b);
+        return b;
+    }
+
+    size_type insert_at(size_type t, size_type n)
+    {
+        if (t == npos)
+        {
+            return n;
+        }
+
+        if (m_nodes[n].priority > m_nodes[t].priority)
+        {
+            size_type l, r;
+            split(t, n, l, r);
+            m_nodes[n].left = l;
+            m_nodes[n].right = r;
+            update(n);
+            return n;
+        }
+
+        if (less(n, t))
+        {
+            size_type l = insert_at(m_nodes[t].left, n);
+            m_nodes[t].left = l;
+        }
+        else
+        {
+            size_type r = insert_at(m_nodes[t].right, n);
+            m_nodes[t].right = r;
+        }
+
+        update(t);
+        return t;
+    }
+
+    size_type erase_at(size_type t, size_type n)
+    {
+        if (t == n)
+        {
+            return merge(m_nodes[t].left, m_nodes[t].right);
+        }
+
+        if (less(n, t))
+        {
+            size_type l = erase_at(m_nodes[t].left, n);
+            m_nodes[t].left = l;
+        }
+        else
+        {
+            size_type r = erase_at(m_nodes[t].right, n);
+            m_nodes[t].right = r;
+        }
+
+        update(t);
+        return t;
+    }
+
+    size_type best_fit_at(size_type t, std::size_t size, std::size_t alignment) const
+    {
+        if (t == npos || m_nodes[t].max_alignment < alignment)
+        {
+            return npos;
+        }
+
+        const Block & block = m_nodes[t].block;
+
+        // t and its left subtree are ordered before the request
+        if (block.size < size || (block.size == size && block.alignment < alignment))
+        {
+            return best_fit_at(m_nodes[t].right, size, alignment);
+        }
+
+        size_type n = best_fit_at(m_nodes[t].left, size, alignment);
+        if (n != npos)
+        {
+            return n;
+        }
+
+        if (block.alignment >= alignment)
+        {
+            return t;
+        }
+
+        return best_fit_at(m_nodes[t].right, size, alignment);
+    }
+
+    node_vector m_nodes;
+    size_type m_root;
+    // erased nodes, linked through their left children
+    size_type m_free;
+    size_type m_size;
+    unsigned int m_seed;
+};
+
+} // end detail
+THRUST_NAMESPACE_END
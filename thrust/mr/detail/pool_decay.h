@@ -0,0 +1,83 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file pool_decay.h
+ *  \brief The idle decay policy of the pooling resource adaptors.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+
+#include <chrono>
+#include <cstddef>
+
+THRUST_NAMESPACE_BEGIN
+namespace detail
+{
+
+// splits the lifetime of a pool into intervals of a fixed length, and keeps the
+// highest number of bytes in use within the current one; at the end of an
+// interval, the pool trims itself down to that peak, returning the memory it
+// did not need during the whole interval
+class pool_decay
+{
+    typedef std::chrono::steady_clock clock;
+
+public:
+    explicit pool_decay(std::size_t interval_ms)
+        : m_interval(static_cast<std::chrono::milliseconds::rep>(interval_ms)),
+        m_start(clock::now()),
+        m_peak(0)
+    {
+    }
+
+    bool enabled() const
+    {
+        return m_interval.count() != 0;
+    }
+
+    // records the current number of bytes in use; returns true, and the peak
+    // of the interval in target, when the interval is over
+    bool tick(std::size_t bytes_in_use, std::size_t & target)
+    {
+        if (bytes_in_use > m_peak)
+        {
+            m_peak = bytes_in_use;
+        }
+
+        clock::time_point now = clock::now();
+        if (now - m_start < m_interval)
+        {
+            return false;
+        }
+
+        target = m_peak;
+        m_start = now;
+        m_peak = bytes_in_use;
+
+        return true;
+    }
+
+private:
+    std::chrono::milliseconds m_interval;
+    clock::time_point m_start;
+    std::size_t m_peak;
+};
+
+} // end detail
+THRUST_NAMESPACE_END
+
@@ -1,5 +1,6 @@
 /*
  *  Copyright 2018 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -25,12 +26,13 @@
 #include <thrust/detail/config.h>
 
 #include <thrust/host_vector.h>
-#include <thrust/binary_search.h>
-#include <thrust/detail/seq.h>
 
 #include <thrust/mr/memory_resource.h>
 #include <thrust/mr/allocator.h>
 #include <thrust/mr/pool_options.h>
+#include <thrust/mr/pool_statistics.h>
+#include <thrust/mr/detail/oversized_index.h>
+#include <thrust/mr/detail/pool_decay.h>
 
 #include <cassert>
 
@@ -96,6 +98,10 @@ public:
         ret.cached_size_cutoff_factor = 16;
         ret.cached_alignment_cutoff_factor = 16;
 
+        ret.soft_cap_bytes = 0;
+        ret.hard_cap_bytes = 0;
+        ret.decay_interval_ms = 0;
+
         return ret;
     }
 
@@ -114,7 +120,10 @@ public:
         m_pools(m_bookkeeper),
         m_allocated(m_bookkeeper),
         m_cached_oversized(m_bookkeeper),
-        m_oversized(m_bookkeeper)
+        m_oversized(m_bookkeeper),
+        m_statistics(),
+        m_decay(m_options.decay_interval_ms),
+        m_freed_since_trim(0)
     {
         assert(m_options.validate());
 
@@ -137,7 +146,10 @@ public:
         m_pools(m_bookkeeper),
         m_allocated(m_bookkeeper),
         m_cached_oversized(m_bookkeeper),
-        m_oversized(m_bookkeeper)
+        m_oversized(m_bookkeeper),
+        m_statistics(),
+        m_decay(m_options.decay_interval_ms),
+        m_freed_since_trim(0)
     {
         assert(m_options.validate());
 
@@ -161,6 +173,7 @@ private:
     {
         std::size_t size;
         void_ptr pointer;
+        std::size_t block_size;
     };
 
     typedef thrust::host_vector<
@@ -173,60 +186,19 @@ private:
         std::size_t size;
         std::size_t alignment;
         void_ptr pointer;
-
-        __host__ __device__
-        bool operator==(const oversized_block_descriptor & other) const
-        {
-            return size == other.size && alignment == other.alignment && pointer == other.pointer;
-        }
-
-        __host__ __device__
-        bool operator<(const oversized_block_descriptor & other) const
-        {
-            return size < other.size || (size == other.size && alignment < other.alignment);
-        }
     };
 
-    struct equal_pointers
-    {
-    public:
-        __host__ __device__
-        equal_pointers(void_ptr p) : p(p)
-        {
-        }
-
-        __host__ __device__
-        bool operator()(const oversized_block_descriptor & desc) const
-        {
-            return desc.pointer == p;
-        }
-
-    private:
-        void_ptr p;
-    };
-
-    struct matching_alignment
-    {
-    public:
-        __host__ __device__
-        matching_alignment(std::size_t requested) : requested(requested)
-        {
-        }
-
-        __host__ __device__
-        bool operator()(const oversized_block_descriptor & desc) const
-        {
-            return desc.alignment >= requested;
-        }
-
-    private:
-        std::size_t requested;
-    };
+    // all oversized/overaligned allocations, looked up by pointer in constant expected time
+    typedef thrust::detail::oversized_block_table<
+        oversized_block_descriptor,
+        allocator<oversized_block_descriptor, Bookkeeper>
+    > oversized_block_table;
 
-    typedef thrust::host_vector<
+    // the cached ones among them, ordered by size and alignment for best fit lookups
+    typedef thrust::detail::cached_block_tree<
         oversized_block_descriptor,
         allocator<oversized_block_descriptor, Bookkeeper>
-    > oversized_block_vector;
+    > cached_block_tree;
 
     typedef thrust::host_vector<
         void_ptr,
@@ -238,14 +210,18 @@ private:
         __host__
         pool(const pointer_vector & free)
             : free_blocks(free),
-            previous_allocated_count(0)
+            previous_allocated_count(0),
+            hits(0),
+            misses(0)
         {
         }
 
         __host__
         pool(const pool & other)
             : free_blocks(other.free_blocks),
-            previous_allocated_count(other.previous_allocated_count)
+            previous_allocated_count(other.previous_allocated_count),
+            hits(other.hits),
+            misses(other.misses)
         {
         }
 
@@ -258,6 +234,8 @@ private:
 
         pointer_vector free_blocks;
         std::size_t previous_allocated_count;
+        std::size_t hits;
+        std::size_t misses;
     };
 
     typedef thrust::host_vector<
@@ -275,10 +253,104 @@ private:
     pool_vector m_pools;
     // list of all allocations from upstream for the above
     chunk_vector m_allocated;
-    // list of all cached oversized/overaligned blocks that have been returned to the pool to cache
-    oversized_block_vector m_cached_oversized;
-    // list of all oversized/overaligned allocations from upstream
-    oversized_block_vector m_oversized;
+    // index of all cached oversized/overaligned blocks that have been returned to the pool to cache
+    cached_block_tree m_cached_oversized;
+    // index of all oversized/overaligned allocations from upstream
+    oversized_block_table m_oversized;
+
+    thrust::detail::pool_statistics_recorder m_statistics;
+    thrust::detail::pool_decay m_decay;
+    // the bytes deallocated since the last trim, to amortize the soft cap
+    std::size_t m_freed_since_trim;
+
+    static const std::size_t trimmed_chunk = static_cast<std::size_t>(-1);
+
+    // a chunk, by the raw address of its memory
+    struct chunk_address
+    {
+        std::size_t address;
+        std::size_t chunk;
+    };
+
+    typedef thrust::host_vector<
+        chunk_address,
+        allocator<chunk_address, Bookkeeper>
+    > chunk_address_vector;
+
+    typedef thrust::host_vector<
+        std::size_t,
+        allocator<std::size_t, Bookkeeper>
+    > count_vector;
+
+    static bool address_less(const chunk_address & lhs, const chunk_address & rhs)
+    {
+        return lhs.address < rhs.address;
+    }
+
+    static std::size_t raw_address(void_ptr p)
+    {
+        return reinterpret_cast<std::size_t>(thrust::detail::pointer_traits<void_ptr>::get(p));
+    }
+
+    // the chunk holding a free block
+    static std::size_t find_chunk(const chunk_address_vector & chunks, void_ptr p)
+    {
+        chunk_address key;
+        key.address = raw_address(p);
+        key.chunk = 0;
+
+        typename chunk_address_vector::const_iterator it = std::upper_bound(chunks.begin(), chunks.end(), key, address_less);
+        assert(it != chunks.begin());
+        return (*(it - 1)).chunk;
+    }
+
+    // trims the pool so that an allocation of the given size from upstream
+    // stays within the caps; returns false if it would exceed the hard cap
+    bool make_room(std::size_t bytes)
+    {
+        std::size_t cap = m_options.soft_cap_bytes != 0 ? m_options.soft_cap_bytes : m_options.hard_cap_bytes;
+        if (cap == 0 || m_statistics.pooled_bytes() + bytes <= cap)
+        {
+            return true;
+        }
+
+        trim(cap > bytes ? cap - bytes : 0);
+
+        return m_options.hard_cap_bytes == 0 || m_statistics.pooled_bytes() + bytes <= m_options.hard_cap_bytes;
+    }
+
+    // applies the decay and the soft cap after a deallocation
+    void freed(std::size_t bytes)
+    {
+        std::size_t target;
+        if (m_decay.enabled() && m_decay.tick(m_statistics.get().bytes_in_use, target))
+        {
+            trim(target);
+            return;
+        }
+
+        if (m_options.soft_cap_bytes == 0)
+        {
+            return;
+        }
+
+        std::size_t pooled = m_statistics.pooled_bytes();
+        if (pooled <= m_options.soft_cap_bytes)
+        {
+            m_freed_since_trim = 0;
+            return;
+        }
+
+        // trimming searches the chunk of every free block, so it is only
+        // attempted once enough memory has been freed since the last attempt,
+        // or once all of it is free
+        m_freed_since_trim += bytes;
+        if (m_freed_since_trim >= (std::min)(pooled - m_options.soft_cap_bytes, pooled / 8)
+            || m_statistics.get().bytes_in_use == 0)
+        {
+            trim(m_options.soft_cap_bytes);
+        }
+    }
 
 public:
     /*! Releases all held memory to upstream.
@@ -299,20 +371,157 @@ public:
                 m_allocated[i].pointer,
                 m_allocated[i].size,
                 m_options.alignment);
+            m_statistics.upstream_deallocated(m_allocated[i].size);
         }
 
         // deallocate cached oversized/overaligned memory
-        for (std::size_t i = 0; i < m_oversized.size(); ++i)
+        for (std::size_t i = 0; i < m_oversized.capacity(); ++i)
         {
+            if (!m_oversized.occupied(i))
+            {
+                continue;
+            }
+
             m_upstream->do_deallocate(
                 m_oversized[i].pointer,
                 m_oversized[i].size,
                 m_oversized[i].alignment);
+            m_statistics.upstream_deallocated(m_oversized[i].size);
         }
 
         m_allocated.clear();
         m_oversized.clear();
         m_cached_oversized.clear();
+
+        m_statistics.released();
+        m_freed_since_trim = 0;
+    }
+
+    /*! Returns fully free chunks and cached oversized blocks to upstream, until the pool holds at most \p target_bytes of
+     *      upstream memory, or has no more free memory to return. Unlike \p release, it leaves the blocks in use, and the
+     *      chunks they belong to, untouched.
+     *
+     *  \param target_bytes the number of bytes of upstream memory to trim the pool down to
+     *  \return the number of bytes returned to upstream
+     */
+    std::size_t trim(std::size_t target_bytes = 0)
+    {
+        std::size_t released = 0;
+        m_freed_since_trim = 0;
+
+        // cached oversized blocks are returned first, largest first, since they
+        // need no search
+        while (m_statistics.pooled_bytes() > target_bytes && !m_cached_oversized.empty())
+        {
+            std::size_t it = m_cached_oversized.largest();
+            oversized_block_descriptor oversized = m_cached_oversized[it];
+            m_cached_oversized.erase(it);
+            m_oversized.erase(m_oversized.find(oversized.pointer));
+
+            m_upstream->do_deallocate(oversized.pointer, oversized.size, oversized.alignment);
+            m_statistics.upstream_deallocated(oversized.size);
+            released += oversized.size;
+        }
+
+        if (m_statistics.pooled_bytes() <= target_bytes || m_allocated.empty())
+        {
+            return released;
+        }
+
+        // count the free blocks of every chunk, finding their chunks by address
+        chunk_address_vector chunks(m_bookkeeper);
+        chunks.resize(m_allocated.size());
+        for (std::size_t i = 0; i < m_allocated.size(); ++i)
+        {
+            chunks[i].address = raw_address(m_allocated[i].pointer);
+            chunks[i].chunk = i;
+        }
+        std::sort(chunks.begin(), chunks.end(), address_less);
+
+        count_vector free_counts(m_bookkeeper);
+        free_counts.resize(m_allocated.size(), 0);
+        for (std::size_t i = 0; i < m_pools.size(); ++i)
+        {
+            const pointer_vector & free_blocks = m_pools[i].free_blocks;
+            for (std::size_t j = 0; j < free_blocks.size(); ++j)
+            {
+                ++free_counts[find_chunk(chunks, free_blocks[j])];
+            }
+        }
+
+        // pick the fully free chunks to return, newest (and largest) first
+        std::size_t pooled = m_statistics.pooled_bytes();
+        bool any = false;
+        for (std::size_t i = m_allocated.size(); i > 0 && pooled > target_bytes; --i)
+        {
+            const chunk_descriptor & chunk = m_allocated[i - 1];
+            if (free_counts[i - 1] * chunk.block_size == chunk.size)
+            {
+                free_counts[i - 1] = trimmed_chunk;
+                pooled -= chunk.size;
+                any = true;
+            }
+        }
+
+        if (!any)
+        {
+            return released;
+        }
+
+        // remove their blocks from the free lists
+        for (std::size_t i = 0; i < m_pools.size(); ++i)
+        {
+            pointer_vector & free_blocks = m_pools[i].free_blocks;
+
+            std::size_t kept = 0;
+            for (std::size_t j = 0; j < free_blocks.size(); ++j)
+            {
+                if (free_counts[find_chunk(chunks, free_blocks[j])] != trimmed_chunk)
+                {
+                    free_blocks[kept++] = free_blocks[j];
+                }
+            }
+            free_blocks.resize(kept);
+        }
+
+        // and return them to upstream; their buckets start over from small chunks
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < m_allocated.size(); ++i)
+        {
+            chunk_descriptor chunk = m_allocated[i];
+            if (free_counts[i] == trimmed_chunk)
+            {
+                m_pools[thrust::detail::log2(chunk.block_size) - m_smallest_block_log2].previous_allocated_count = 0;
+
+                m_upstream->do_deallocate(chunk.pointer, chunk.size, m_options.alignment);
+                m_statistics.upstream_deallocated(chunk.size);
+                released += chunk.size;
+            }
+            else
+            {
+                m_allocated[kept++] = chunk;
+            }
+        }
+        m_allocated.resize(kept);
+
+        return released;
+    }
+
+    /*! Returns the usage statistics of the pool.
+     */
+    pool_statistics statistics() const
+    {
+        pool_statistics ret = m_statistics.get();
+
+        ret.size_classes.resize(m_pools.size());
+        for (std::size_t i = 0; i < m_pools.size(); ++i)
+        {
+            ret.size_classes[i].block_size = static_cast<std::size_t>(1) << (m_smallest_block_log2 + i);
+            ret.size_classes[i].hits = m_pools[i].hits;
+            ret.size_classes[i].misses = m_pools[i].misses;
+        }
+
+        return ret;
     }
 
     THRUST_NODISCARD virtual void_ptr do_allocate(std::size_t bytes, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
@@ -320,6 +529,12 @@ public:
         bytes = (std::max)(bytes, m_options.smallest_block_size);
         assert(detail::is_power_of_2(alignment));
 
+        std::size_t target;
+        if (m_decay.enabled() && m_decay.tick(m_statistics.get().bytes_in_use + bytes, target))
+        {
+            trim(target);
+        }
+
         // an oversized and/or overaligned allocation requested; needs to be allocated separately
         if (bytes > m_options.largest_block_size || alignment > m_options.alignment)
         {
@@ -329,52 +544,52 @@ public:
 
             if (m_options.cache_oversized && !m_cached_oversized.empty())
             {
-                typename oversized_block_vector::iterator it = thrust::lower_bound(
-                    thrust::seq,
-                    m_cached_oversized.begin(),
-                    m_cached_oversized.end(),
-                    oversized);
+                // the smallest cached block that is big enough and aligned enough
+                std::size_t it = m_cached_oversized.best_fit(bytes, alignment);
 
                 // if the size is bigger than the requested size by a factor
                 // bigger than or equal to the specified cutoff for size,
                 // allocate a new block
-                if (it != m_cached_oversized.end())
+                if (it != cached_block_tree::npos)
                 {
-                    std::size_t size_factor = (*it).size / bytes;
+                    std::size_t size_factor = m_cached_oversized[it].size / bytes;
                     if (size_factor >= m_options.cached_size_cutoff_factor)
                     {
-                        it = m_cached_oversized.end();
+                        it = cached_block_tree::npos;
                     }
                 }
 
-                if (it != m_cached_oversized.end() && (*it).alignment < alignment)
-                {
-                    it = find_if(it + 1, m_cached_oversized.end(), matching_alignment(alignment));
-                }
-
                 // if the alignment is bigger than the requested one by a factor
                 // bigger than or equal to the specified cutoff for alignment,
                 // allocate a new block
-                if (it != m_cached_oversized.end())
+                if (it != cached_block_tree::npos)
                 {
-                    std::size_t alignment_factor = (*it).alignment / alignment;
+                    std::size_t alignment_factor = m_cached_oversized[it].alignment / alignment;
                     if (alignment_factor >= m_options.cached_alignment_cutoff_factor)
                     {
-                        it = m_cached_oversized.end();
+                        it = cached_block_tree::npos;
                     }
                 }
 
-                if (it != m_cached_oversized.end())
+                if (it != cached_block_tree::npos)
                 {
-                    oversized.pointer = (*it).pointer;
+                    oversized.pointer = m_cached_oversized[it].pointer;
+                    m_statistics.oversized_hit();
+                    m_statistics.allocated(m_cached_oversized[it].size);
                     m_cached_oversized.erase(it);
                     return oversized.pointer;
                 }
             }
 
             // no fitting cached block found; allocate a new one that's just up to the specs
+            make_room(bytes);
+
             oversized.pointer = m_upstream->do_allocate(bytes, alignment);
-            m_oversized.push_back(oversized);
+            m_oversized.insert(oversized);
+
+            m_statistics.upstream_allocated(bytes);
+            m_statistics.oversized_miss();
+            m_statistics.allocated(bytes);
 
             return oversized.pointer;
         }
@@ -389,6 +604,8 @@ public:
         // and split it into blocks pushed to the free list
         if (bucket.free_blocks.empty())
         {
+            ++bucket.misses;
+
             std::size_t bucket_size = static_cast<std::size_t>(1) << bytes_log2;
 
             std::size_t n = bucket.previous_allocated_count;
@@ -420,11 +637,30 @@ public:
             assert(bytes >= m_options.min_bytes_per_chunk);
             assert(bytes <= m_options.max_bytes_per_chunk);
 
+            // over the hard cap, the block is allocated directly from upstream;
+            // it is indexed with the oversized blocks, so that deallocation finds
+            // it and release frees it
+            if (!make_room(bytes))
+            {
+                oversized_block_descriptor fallback;
+                fallback.size = bucket_size;
+                fallback.alignment = m_options.alignment;
+                fallback.pointer = m_upstream->do_allocate(bucket_size, m_options.alignment);
+                m_oversized.insert(fallback);
+
+                m_statistics.fallback_allocated(bucket_size);
+                m_statistics.allocated(bucket_size);
+
+                return fallback.pointer;
+            }
+
             chunk_descriptor allocated;
             allocated.size = bytes;
             allocated.pointer = m_upstream->do_allocate(bytes, m_options.alignment);
+            allocated.block_size = bucket_size;
             m_allocated.push_back(allocated);
             bucket.previous_allocated_count = n;
+            m_statistics.upstream_allocated(bytes);
 
             for (std::size_t i = 0; i < n; ++i)
             {
@@ -435,6 +671,12 @@ public:
                 );
             }
         }
+        else
+        {
+            ++bucket.hits;
+        }
+
+        m_statistics.allocated(static_cast<std::size_t>(1) << bytes_log2);
 
         // allocate a block from the front of the bucket's free list
         void_ptr ret = bucket.free_blocks.back();
@@ -453,21 +695,27 @@ public:
         // the deallocated block is oversized and/or overaligned
         if (n > m_options.largest_block_size || alignment > m_options.alignment)
         {
-            typename oversized_block_vector::iterator it = find_if(m_oversized.begin(), m_oversized.end(), equal_pointers(p));
-            assert(it != m_oversized.end());
+            std::size_t it = m_oversized.find(p);
+            assert(it != oversized_block_table::npos);
 
-            oversized_block_descriptor oversized = *it;
+            oversized_block_descriptor oversized = m_oversized[it];
 
-            if (m_options.cache_oversized)
+            m_statistics.deallocated(oversized.size);
+
+            // blocks are not cached above the hard cap
+            if (m_options.cache_oversized
+                && (m_options.hard_cap_bytes == 0 || m_statistics.pooled_bytes() <= m_options.hard_cap_bytes))
             {
-                typename oversized_block_vector::iterator position = lower_bound(m_cached_oversized.begin(), m_cached_oversized.end(), oversized);
-                m_cached_oversized.insert(position, oversized);
+                m_cached_oversized.insert(oversized);
+
+                freed(oversized.size);
                 return;
             }
 
             m_oversized.erase(it);
 
             m_upstream->do_deallocate(p, oversized.size, oversized.alignment);
+            m_statistics.upstream_deallocated(oversized.size);
 
             return;
         }
@@ -477,7 +725,27 @@ public:
         std::size_t bucket_idx = n_log2 - m_smallest_block_log2;
         pool & bucket = m_pools[bucket_idx];
 
+        m_statistics.deallocated(static_cast<std::size_t>(1) << n_log2);
+
+        // a block allocated directly from upstream because of the hard cap
+        if (m_statistics.get().fallback_bytes != 0)
+        {
+            std::size_t it = m_oversized.find(p);
+            if (it != oversized_block_table::npos)
+            {
+                oversized_block_descriptor fallback = m_oversized[it];
+                m_oversized.erase(it);
+
+                m_upstream->do_deallocate(p, fallback.size, fallback.alignment);
+                m_statistics.fallback_deallocated(fallback.size);
+
+                return;
+            }
+        }
+
         bucket.free_blocks.push_back(p);
+
+        freed(static_cast<std::size_t>(1) << n_log2);
     }
 };
 
@@ -0,0 +1,405 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file monotonic.h
+ *  \brief A bump allocating memory resource adaptor, for temporary storage which is freed all at once.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+
+#include <thrust/detail/raw_reference_cast.h>
+#include <thrust/detail/type_traits/pointer_traits.h>
+
+#include <thrust/mr/allocator.h>
+#include <thrust/mr/memory_resource.h>
+#include <thrust/mr/validator.h>
+
+#include <cassert>
+
+THRUST_NAMESPACE_BEGIN
+namespace mr
+{
+
+/*! \addtogroup memory_resources Memory Resources
+ *  \ingroup memory_management
+ *  \{
+ */
+
+/*! A memory resource adaptor handing out consecutive pieces of large chunks of memory obtained from \p Upstream, and
+ *      returning them all at once. Allocating is a pointer increment; deallocating does nothing, except for the most
+ *      recent allocation, which is given back to the arena, so that temporary storage freed in the reverse order of its
+ *      allocation is reused right away.
+ *
+ *  The memory of the arena is reclaimed with \p rewind, which returns everything allocated since a \p position was
+ *      taken, and with \p reset, which returns everything while keeping the chunks for reuse. When the allocations
+ *      between two resets did not fit in a single chunk, \p reset replaces the chunks by a single one large enough for
+ *      all of them, so that a workload repeated between resets soon runs in a single chunk, without ever calling
+ *      \p Upstream.
+ *
+ *  Passed to an execution policy, as in <tt>thrust::cpp::par(&arena)</tt>, the arena serves the temporary storage of
+ *      the algorithms invoked with that policy. The host backends allocate their temporary storage on the thread
+ *      invoking the algorithm, so an arena used this way needs no synchronization, but it must not be shared by
+ *      algorithms running concurrently.
+ *
+ *  Every allocation is aligned to at least \p THRUST_MR_DEFAULT_ALIGNMENT. The chunk descriptors are kept in the chunks
+ *      themselves, so the memory allocated by \p Upstream must be accessible from the host.
+ *
+ *  \tparam Upstream the type of memory resources that will be used for allocating memory chunks
+ */
+template<typename Upstream>
+class monotonic_buffer_resource final
+    : public memory_resource<typename Upstream::pointer>,
+        private validator<Upstream>
+{
+    typedef typename Upstream::pointer void_ptr;
+    typedef thrust::detail::pointer_traits<void_ptr> void_ptr_traits;
+    typedef typename void_ptr_traits::template rebind<char>::other char_ptr;
+
+    struct chunk_descriptor;
+    typedef typename void_ptr_traits::template rebind<chunk_descriptor>::other chunk_descriptor_ptr;
+
+    struct chunk_descriptor
+    {
+        // the usable size, following the descriptor
+        std::size_t size;
+        chunk_descriptor_ptr next;
+    };
+
+public:
+    /*! The default size of the first chunk. */
+    static const std::size_t default_initial_size = 64 * 1024;
+
+    /*! A position of the arena, as returned by \p position, to which it can be rewound.
+     */
+    class marker
+    {
+        friend class monotonic_buffer_resource;
+
+        chunk_descriptor_ptr chunk;
+        std::size_t offset;
+    };
+
+    /*! Constructor. The upstream resource is obtained by calling \p get_global_resource<Upstream>. No memory is allocated
+     *      until the first allocation.
+     */
+    monotonic_buffer_resource()
+        : m_upstream(get_global_resource<Upstream>()),
+        m_initial_size(default_initial_size),
+        m_next_size(default_initial_size),
+        m_first(),
+        m_current(),
+        m_offset(0),
+        m_capacity(0),
+        m_used(0)
+    {
+    }
+
+    /*! Constructor. No memory is allocated until the first allocation.
+     *
+     *  \param upstream the upstream memory resource for allocations
+     */
+    monotonic_buffer_resource(Upstream * upstream)
+        : m_upstream(upstream),
+        m_initial_size(default_initial_size),
+        m_next_size(default_initial_size),
+        m_first(),
+        m_current(),
+        m_offset(0),
+        m_capacity(0),
+        m_used(0)
+    {
+    }
+
+    /*! Constructor. The first chunk is allocated right away, so that an arena sized for its workload never calls
+     *      \p Upstream again.
+     *
+     *  \param initial_size the size of the first chunk, and the size \p release returns to
+     *  \param upstream the upstream memory resource for allocations
+     */
+    monotonic_buffer_resource(std::size_t initial_size, Upstream * upstream = get_global_resource<Upstream>())
+        : m_upstream(upstream),
+        m_initial_size(initial_size > 0 ? initial_size : 1),
+        m_next_size(m_initial_size),
+        m_first(),
+        m_current(),
+        m_offset(0),
+        m_capacity(0),
+        m_used(0)
+    {
+        m_first = m_current = allocate_chunk(m_initial_size);
+    }
+
+    ~monotonic_buffer_resource()
+    {
+        release();
+    }
+
+    /*! Returns the upstream memory resource. */
+    Upstream * upstream_resource() const
+    {
+        return m_upstream;
+    }
+
+    /*! Returns the total size of the chunks currently held by the arena. */
+    std::size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    /*! Returns the number of bytes of the arena before its current position: the sizes of the chunks filled since the
+     *      last \p reset, including the space left at their ends, and the part of the current chunk handed out. After a
+     *      workload, it is the size of the single chunk that would have served it, alignment padding included.
+     */
+    std::size_t bytes_used() const
+    {
+        return m_used;
+    }
+
+    /*! Returns the current position of the arena, for a later call to \p rewind.
+     */
+    marker position() const
+    {
+        marker ret;
+        ret.chunk = m_current;
+        ret.offset = m_offset;
+        return ret;
+    }
+
+    /*! Returns the memory allocated since \p position returned \p m to the arena. The memory allocated before that
+     *      remains valid. The chunks allocated since then are kept for reuse.
+     *
+     *  \param m a position returned by \p position since the last \p reset or \p release
+     */
+    void rewind(const marker & m)
+    {
+        if (!void_ptr_traits::get(m.chunk))
+        {
+            m_current = m_first;
+            m_offset = 0;
+            m_used = 0;
+            return;
+        }
+
+        std::size_t used = 0;
+        for (chunk_descriptor_ptr chunk = m_first; chunk != m.chunk; chunk = thrust::raw_reference_cast(*chunk).next)
+        {
+            used += thrust::raw_reference_cast(*chunk).size;
+        }
+
+        m_current = m.chunk;
+        m_offset = m.offset;
+        m_used = used + m.offset;
+    }
+
+    /*! Returns all the memory allocated from the arena. A single chunk is kept for reuse; when the arena had grown to
+     *      several chunks, they are replaced by one chunk as large as all of them together.
+     */
+    void reset()
+    {
+        m_used = 0;
+        m_offset = 0;
+
+        if (!void_ptr_traits::get(m_first) || !void_ptr_traits::get(thrust::raw_reference_cast(*m_first).next))
+        {
+            m_current = m_first;
+            return;
+        }
+
+        std::size_t size = m_capacity;
+        free_chunks();
+        m_first = m_current = allocate_chunk(size);
+        m_next_size = size;
+    }
+
+    /*! Deallocates all the chunks of the arena, and starts over from the initial chunk size.
+     */
+    void release()
+    {
+        free_chunks();
+        m_used = 0;
+        m_offset = 0;
+        m_next_size = m_initial_size;
+    }
+
+    THRUST_NODISCARD virtual void_ptr do_allocate(std::size_t bytes, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
+    {
+        if (alignment < THRUST_MR_DEFAULT_ALIGNMENT)
+        {
+            alignment = THRUST_MR_DEFAULT_ALIGNMENT;
+        }
+        if (bytes == 0)
+        {
+            bytes = 1;
+        }
+
+        // the current chunk, and then the chunks kept after it by rewind
+        while (void_ptr_traits::get(m_current))
+        {
+            void_ptr ret = allocate_from_current(bytes, alignment);
+            if (void_ptr_traits::get(ret))
+            {
+                return ret;
+            }
+
+            chunk_descriptor_ptr next = thrust::raw_reference_cast(*m_current).next;
+            if (!void_ptr_traits::get(next))
+            {
+                break;
+            }
+
+            m_used += thrust::raw_reference_cast(*m_current).size - m_offset;
+            m_current = next;
+            m_offset = 0;
+        }
+
+        // a new chunk, linked after the current one
+        std::size_t size = m_next_size;
+        while (size < bytes + alignment)
+        {
+            size *= 2;
+        }
+        m_next_size = size * 2;
+
+        chunk_descriptor_ptr chunk = allocate_chunk(size);
+
+        if (void_ptr_traits::get(m_current))
+        {
+            m_used += thrust::raw_reference_cast(*m_current).size - m_offset;
+            thrust::raw_reference_cast(*chunk).next = thrust::raw_reference_cast(*m_current).next;
+            thrust::raw_reference_cast(*m_current).next = chunk;
+        }
+        else
+        {
+            m_first = chunk;
+        }
+
+        m_current = chunk;
+        m_offset = 0;
+
+        void_ptr ret = allocate_from_current(bytes, alignment);
+        assert(void_ptr_traits::get(ret));
+        return ret;
+    }
+
+    virtual void do_deallocate(void_ptr p, std::size_t bytes, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
+    {
+        (void)alignment;
+
+        if (!void_ptr_traits::get(m_current))
+        {
+            return;
+        }
+        if (bytes == 0)
+        {
+            bytes = 1;
+        }
+
+        // only the most recent allocation is given back
+        char_ptr data = chunk_data(m_current);
+        char_ptr begin = static_cast<char_ptr>(p);
+        if (begin + bytes == data + m_offset && begin >= data)
+        {
+            std::size_t offset = begin - data;
+            m_used -= m_offset - offset;
+            m_offset = offset;
+        }
+    }
+
+private:
+    // the descriptor, rounded up so that the memory following it is aligned
+    static std::size_t descriptor_size()
+    {
+        return (sizeof(chunk_descriptor) + THRUST_MR_DEFAULT_ALIGNMENT - 1) / THRUST_MR_DEFAULT_ALIGNMENT * THRUST_MR_DEFAULT_ALIGNMENT;
+    }
+
+    static char_ptr chunk_data(chunk_descriptor_ptr chunk)
+    {
+        return static_cast<char_ptr>(static_cast<void_ptr>(chunk)) + descriptor_size();
+    }
+
+    chunk_descriptor_ptr allocate_chunk(std::size_t size)
+    {
+        void_ptr allocated = m_upstream->do_allocate(size + descriptor_size(), THRUST_MR_DEFAULT_ALIGNMENT);
+        chunk_descriptor_ptr chunk = static_cast<chunk_descriptor_ptr>(allocated);
+
+        chunk_descriptor desc;
+        desc.size = size;
+        desc.next = chunk_descriptor_ptr();
+        *chunk = desc;
+
+        m_capacity += size;
+
+        return chunk;
+    }
+
+    void free_chunks()
+    {
+        while (void_ptr_traits::get(m_first))
+        {
+            chunk_descriptor_ptr chunk = m_first;
+            m_first = thrust::raw_reference_cast(*chunk).next;
+
+            std::size_t size = thrust::raw_reference_cast(*chunk).size;
+            m_upstream->do_deallocate(static_cast<void_ptr>(chunk), size + descriptor_size(), THRUST_MR_DEFAULT_ALIGNMENT);
+        }
+
+        m_current = chunk_descriptor_ptr();
+        m_capacity = 0;
+    }
+
+    // returns a null pointer if the request does not fit in the current chunk
+    void_ptr allocate_from_current(std::size_t bytes, std::size_t alignment)
+    {
+        char_ptr data = chunk_data(m_current);
+        std::size_t size = thrust::raw_reference_cast(*m_current).size;
+
+        std::size_t address = reinterpret_cast<std::size_t>(void_ptr_traits::get(data)) + m_offset;
+        std::size_t padding = (alignment - address % alignment) % alignment;
+
+        if (padding > size - m_offset || bytes > size - m_offset - padding)
+        {
+            return void_ptr();
+        }
+
+        char_ptr ret = data + (m_offset + padding);
+        m_offset += padding + bytes;
+        m_used += padding + bytes;
+
+        return static_cast<void_ptr>(ret);
+    }
+
+    Upstream * m_upstream;
+
+    std::size_t m_initial_size;
+    std::size_t m_next_size;
+
+    chunk_descriptor_ptr m_first;
+    chunk_descriptor_ptr m_current;
+    // the offset of the free memory in the current chunk
+    std::size_t m_offset;
+
+    std::size_t m_capacity;
+    std::size_t m_used;
+};
+
+/*! \} // memory_resources
+ */
+
+} // end mr
+THRUST_NAMESPACE_END
+
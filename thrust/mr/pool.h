@@ -1,5 +1,6 @@
 /*
  *  Copyright 2018 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -31,6 +32,8 @@
 #include <thrust/mr/memory_resource.h>
 #include <thrust/mr/allocator.h>
 #include <thrust/mr/pool_options.h>
+#include <thrust/mr/pool_statistics.h>
+#include <thrust/mr/detail/pool_decay.h>
 
 #include <cassert>
 
@@ -93,6 +96,10 @@ public:
         ret.cached_size_cutoff_factor = 16;
         ret.cached_alignment_cutoff_factor = 16;
 
+        ret.soft_cap_bytes = 0;
+        ret.hard_cap_bytes = 0;
+        ret.decay_interval_ms = 0;
+
         return ret;
     }
 
@@ -108,11 +115,14 @@ public:
         m_pools(upstream),
         m_allocated(),
         m_oversized(),
-        m_cached_oversized()
+        m_cached_oversized(),
+        m_statistics(),
+        m_decay(m_options.decay_interval_ms),
+        m_freed_since_trim(0)
     {
         assert(m_options.validate());
 
-        pool p = { block_descriptor_ptr(), 0 };
+        pool p = { block_descriptor_ptr(), 0, 0, 0 };
         m_pools.resize(detail::log2_ri(m_options.largest_block_size) - m_smallest_block_log2 + 1, p);
     }
 
@@ -129,11 +139,14 @@ public:
         m_pools(get_global_resource<Upstream>()),
         m_allocated(),
         m_oversized(),
-        m_cached_oversized()
+        m_cached_oversized(),
+        m_statistics(),
+        m_decay(m_options.decay_interval_ms),
+        m_freed_since_trim(0)
     {
         assert(m_options.validate());
 
-        pool p = { block_descriptor_ptr(), 0 };
+        pool p = { block_descriptor_ptr(), 0, 0, 0 };
         m_pools.resize(detail::log2_ri(m_options.largest_block_size) - m_smallest_block_log2 + 1, p);
     }
 
@@ -159,12 +172,18 @@ private:
     struct block_descriptor
     {
         block_descriptor_ptr next;
+        // the chunk of the block, or null for a block allocated directly from
+        // upstream because of the hard cap
+        chunk_descriptor_ptr chunk;
     };
 
     struct chunk_descriptor
     {
         std::size_t size;
         chunk_descriptor_ptr next;
+        std::size_t block_count;
+        // the number of free blocks, only counted by trim
+        std::size_t free_count;
     };
 
     // this was originally a forward list, but I made it a doubly linked list
@@ -192,6 +211,8 @@ private:
     {
         block_descriptor_ptr free_list;
         std::size_t previous_allocated_count;
+        std::size_t hits;
+        std::size_t misses;
     };
 
     typedef thrust::host_vector<
@@ -209,6 +230,105 @@ private:
     oversized_block_descriptor_ptr m_oversized;
     oversized_block_descriptor_ptr m_cached_oversized;
 
+    thrust::detail::pool_statistics_recorder m_statistics;
+    thrust::detail::pool_decay m_decay;
+    // the bytes deallocated since the last trim, to amortize the soft cap
+    std::size_t m_freed_since_trim;
+
+    static const std::size_t trimmed_chunk = static_cast<std::size_t>(-1);
+
+    // the size of a block descriptor, placed right after each pooled block
+    std::size_t block_descriptor_size() const
+    {
+        return (std::max)(sizeof(block_descriptor), m_options.alignment);
+    }
+
+    void push_oversized(oversized_block_descriptor_ptr block, oversized_block_descriptor desc)
+    {
+        desc.prev = oversized_block_descriptor_ptr();
+        desc.next = m_oversized;
+        *block = desc;
+        m_oversized = block;
+
+        if (detail::pointer_traits<oversized_block_descriptor_ptr>::get(desc.next))
+        {
+            oversized_block_descriptor next = *desc.next;
+            next.prev = block;
+            *desc.next = next;
+        }
+    }
+
+    void unlink_oversized(oversized_block_descriptor_ptr block, const oversized_block_descriptor & desc)
+    {
+        if (!detail::pointer_traits<oversized_block_descriptor_ptr>::get(desc.prev))
+        {
+            assert(m_oversized == block);
+            m_oversized = desc.next;
+        }
+        else
+        {
+            oversized_block_descriptor prev = *desc.prev;
+            assert(prev.next == block);
+            prev.next = desc.next;
+            *desc.prev = prev;
+        }
+
+        if (detail::pointer_traits<oversized_block_descriptor_ptr>::get(desc.next))
+        {
+            oversized_block_descriptor next = *desc.next;
+            assert(next.prev == block);
+            next.prev = desc.prev;
+            *desc.next = next;
+        }
+    }
+
+    // trims the pool so that an allocation of the given size from upstream
+    // stays within the caps; returns false if it would exceed the hard cap
+    bool make_room(std::size_t bytes)
+    {
+        std::size_t cap = m_options.soft_cap_bytes != 0 ? m_options.soft_cap_bytes : m_options.hard_cap_bytes;
+        if (cap == 0 || m_statistics.pooled_bytes() + bytes <= cap)
+        {
+            return true;
+        }
+
+        trim(cap > bytes ? cap - bytes : 0);
+
+        return m_options.hard_cap_bytes == 0 || m_statistics.pooled_bytes() + bytes <= m_options.hard_cap_bytes;
+    }
+
+    // applies the decay and the soft cap after a deallocation
+    void freed(std::size_t bytes)
+    {
+        std::size_t target;
+        if (m_decay.enabled() && m_decay.tick(m_statistics.get().bytes_in_use, target))
+        {
+            trim(target);
+            return;
+        }
+
+        if (m_options.soft_cap_bytes == 0)
+        {
+            return;
+        }
+
+        std::size_t pooled = m_statistics.pooled_bytes();
+        if (pooled <= m_options.soft_cap_bytes)
+        {
+            m_freed_since_trim = 0;
+            return;
+        }
+
+        // trimming walks the free lists, so it is only attempted once enough
+        // memory has been freed since the last attempt, or once all of it is free
+        m_freed_since_trim += bytes;
+        if (m_freed_since_trim >= (std::min)(pooled - m_options.soft_cap_bytes, pooled / 8)
+            || m_statistics.get().bytes_in_use == 0)
+        {
+            trim(m_options.soft_cap_bytes);
+        }
+    }
+
 public:
     /*! Releases all held memory to upstream.
      */
@@ -232,6 +352,7 @@ public:
                     static_cast<void_ptr>(alloc)
                 ) - thrust::raw_reference_cast(*alloc).size
             );
+            m_statistics.upstream_deallocated(thrust::raw_reference_cast(*alloc).size + sizeof(chunk_descriptor));
             m_upstream->do_deallocate(p, thrust::raw_reference_cast(*alloc).size + sizeof(chunk_descriptor), m_options.alignment);
         }
 
@@ -246,10 +367,156 @@ public:
                     static_cast<void_ptr>(alloc)
                 ) - thrust::raw_reference_cast(*alloc).size
             );
+            m_statistics.upstream_deallocated(thrust::raw_reference_cast(*alloc).size + sizeof(oversized_block_descriptor));
             m_upstream->do_deallocate(p, thrust::raw_reference_cast(*alloc).size + sizeof(oversized_block_descriptor), thrust::raw_reference_cast(*alloc).alignment);
         }
 
         m_cached_oversized = oversized_block_descriptor_ptr();
+
+        m_statistics.released();
+        m_freed_since_trim = 0;
+    }
+
+    /*! Returns fully free chunks and cached oversized blocks to upstream, until the pool holds at most \p target_bytes of
+     *      upstream memory, or has no more free memory to return. Unlike \p release, it leaves the blocks in use, and the
+     *      chunks they belong to, untouched.
+     *
+     *  \param target_bytes the number of bytes of upstream memory to trim the pool down to
+     *  \return the number of bytes returned to upstream
+     */
+    std::size_t trim(std::size_t target_bytes = 0)
+    {
+        std::size_t released = 0;
+        m_freed_since_trim = 0;
+
+        // cached oversized blocks are returned first, since they need no search
+        while (m_statistics.pooled_bytes() > target_bytes
+            && detail::pointer_traits<oversized_block_descriptor_ptr>::get(m_cached_oversized))
+        {
+            oversized_block_descriptor_ptr block = m_cached_oversized;
+            oversized_block_descriptor desc = *block;
+            m_cached_oversized = desc.next_cached;
+
+            unlink_oversized(block, desc);
+
+            void_ptr p = static_cast<void_ptr>(
+                static_cast<char_ptr>(
+                    static_cast<void_ptr>(block)
+                ) - desc.size
+            );
+            m_statistics.upstream_deallocated(desc.size + sizeof(oversized_block_descriptor));
+            m_upstream->do_deallocate(p, desc.size + sizeof(oversized_block_descriptor), desc.alignment);
+            released += desc.size + sizeof(oversized_block_descriptor);
+        }
+
+        if (m_statistics.pooled_bytes() <= target_bytes)
+        {
+            return released;
+        }
+
+        // count the free blocks of every chunk
+        for (chunk_descriptor_ptr chunk = m_allocated;
+            detail::pointer_traits<chunk_descriptor_ptr>::get(chunk);
+            chunk = thrust::raw_reference_cast(*chunk).next)
+        {
+            thrust::raw_reference_cast(*chunk).free_count = 0;
+        }
+
+        for (std::size_t i = 0; i < m_pools.size(); ++i)
+        {
+            for (block_descriptor_ptr block = thrust::raw_reference_cast(m_pools[i]).free_list;
+                detail::pointer_traits<block_descriptor_ptr>::get(block);
+                block = thrust::raw_reference_cast(*block).next)
+            {
+                ++thrust::raw_reference_cast(*thrust::raw_reference_cast(*block).chunk).free_count;
+            }
+        }
+
+        // pick the fully free chunks to return, newest (and largest) first
+        std::size_t pooled = m_statistics.pooled_bytes();
+        bool any = false;
+        for (chunk_descriptor_ptr chunk = m_allocated;
+            pooled > target_bytes && detail::pointer_traits<chunk_descriptor_ptr>::get(chunk);
+            chunk = thrust::raw_reference_cast(*chunk).next)
+        {
+            chunk_descriptor & desc = thrust::raw_reference_cast(*chunk);
+            if (desc.free_count == desc.block_count)
+            {
+                desc.free_count = trimmed_chunk;
+                pooled -= desc.size + sizeof(chunk_descriptor);
+                any = true;
+            }
+        }
+
+        if (!any)
+        {
+            return released;
+        }
+
+        // unlink their blocks from the free lists
+        for (std::size_t i = 0; i < m_pools.size(); ++i)
+        {
+            block_descriptor_ptr * previous = &thrust::raw_reference_cast(m_pools[i]).free_list;
+            block_descriptor_ptr block = *previous;
+            while (detail::pointer_traits<block_descriptor_ptr>::get(block))
+            {
+                block_descriptor desc = *block;
+                if (thrust::raw_reference_cast(*desc.chunk).free_count != trimmed_chunk)
+                {
+                    *previous = block;
+                    previous = &thrust::raw_reference_cast(*block).next;
+                }
+                block = desc.next;
+            }
+            *previous = block_descriptor_ptr();
+        }
+
+        // and return them to upstream
+        chunk_descriptor_ptr * previous = &m_allocated;
+        chunk_descriptor_ptr chunk = m_allocated;
+        while (detail::pointer_traits<chunk_descriptor_ptr>::get(chunk))
+        {
+            chunk_descriptor desc = *chunk;
+            if (desc.free_count == trimmed_chunk)
+            {
+                *previous = desc.next;
+
+                void_ptr p = static_cast<void_ptr>(
+                    static_cast<char_ptr>(
+                        static_cast<void_ptr>(chunk)
+                    ) - desc.size
+                );
+                m_statistics.upstream_deallocated(desc.size + sizeof(chunk_descriptor));
+                m_upstream->do_deallocate(p, desc.size + sizeof(chunk_descriptor), m_options.alignment);
+                released += desc.size + sizeof(chunk_descriptor);
+            }
+            else
+            {
+                previous = &thrust::raw_reference_cast(*chunk).next;
+            }
+            chunk = desc.next;
+        }
+
+        return released;
+    }
+
+    /*! Returns the usage statistics of the pool.
+     */
+    pool_statistics statistics() const
+    {
+        pool_statistics ret = m_statistics.get();
+
+        ret.size_classes.resize(m_pools.size());
+        for (std::size_t i = 0; i < m_pools.size(); ++i)
+        {
+            pool bucket = m_pools[i];
+
+            ret.size_classes[i].block_size = static_cast<std::size_t>(1) << (m_smallest_block_log2 + i);
+            ret.size_classes[i].hits = bucket.hits;
+            ret.size_classes[i].misses = bucket.misses;
+        }
+
+        return ret;
     }
 
     THRUST_NODISCARD virtual void_ptr do_allocate(std::size_t bytes, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
@@ -257,6 +524,12 @@ public:
         bytes = (std::max)(bytes, m_options.smallest_block_size);
         assert(detail::is_power_of_2(alignment));
 
+        std::size_t target;
+        if (m_decay.enabled() && m_decay.tick(m_statistics.get().bytes_in_use + bytes, target))
+        {
+            trim(target);
+        }
+
         // an oversized and/or overaligned allocation requested; needs to be allocated separately
         if (bytes > m_options.largest_block_size || alignment > m_options.alignment)
         {
@@ -309,6 +582,9 @@ public:
                         desc.next_cached = oversized_block_descriptor_ptr();
                         *ptr = desc;
 
+                        m_statistics.oversized_hit();
+                        m_statistics.allocated(desc.size);
+
                         return static_cast<void_ptr>(
                             static_cast<char_ptr>(
                                 static_cast<void_ptr>(ptr)
@@ -322,7 +598,13 @@ public:
             }
 
             // no fitting cached block found; allocate a new one that's just up to the specs
+            make_room(bytes + sizeof(oversized_block_descriptor));
+
             void_ptr allocated = m_upstream->do_allocate(bytes + sizeof(oversized_block_descriptor), alignment);
+            m_statistics.upstream_allocated(bytes + sizeof(oversized_block_descriptor));
+            m_statistics.oversized_miss();
+            m_statistics.allocated(bytes);
+
             oversized_block_descriptor_ptr block = static_cast<oversized_block_descriptor_ptr>(
                 static_cast<void_ptr>(
                     static_cast<char_ptr>(allocated) + bytes
@@ -332,18 +614,8 @@ public:
             oversized_block_descriptor desc;
             desc.size = bytes;
             desc.alignment = alignment;
-            desc.prev = oversized_block_descriptor_ptr();
-            desc.next = m_oversized;
             desc.next_cached = oversized_block_descriptor_ptr();
-            *block = desc;
-            m_oversized = block;
-
-            if (detail::pointer_traits<oversized_block_descriptor_ptr>::get(desc.next))
-            {
-                oversized_block_descriptor next = *desc.next;
-                next.prev = block;
-                *desc.next = next;
-            }
+            push_oversized(block, desc);
 
             return allocated;
         }
@@ -360,6 +632,8 @@ public:
         // and split it into blocks pushed to the free list
         if (!detail::pointer_traits<block_descriptor_ptr>::get(bucket.free_list))
         {
+            ++bucket.misses;
+
             std::size_t n = bucket.previous_allocated_count;
             if (n == 0)
             {
@@ -382,12 +656,50 @@ public:
                 }
             }
 
-            std::size_t descriptor_size = (std::max)(sizeof(block_descriptor), m_options.alignment);
+            std::size_t descriptor_size = block_descriptor_size();
             std::size_t block_size = bytes + descriptor_size;
             block_size += m_options.alignment - block_size % m_options.alignment;
             std::size_t chunk_size = block_size * n;
 
+            // over the hard cap, the block is allocated directly from upstream;
+            // it is tracked as an oversized block, so that release frees it
+            if (!make_room(chunk_size + sizeof(chunk_descriptor)))
+            {
+                std::size_t size = bytes + descriptor_size;
+
+                void_ptr allocated = m_upstream->do_allocate(size + sizeof(oversized_block_descriptor), m_options.alignment);
+                m_statistics.fallback_allocated(size + sizeof(oversized_block_descriptor));
+                m_statistics.allocated(bytes);
+
+                block_descriptor_ptr block = static_cast<block_descriptor_ptr>(
+                    static_cast<void_ptr>(
+                        static_cast<char_ptr>(allocated) + bytes
+                    )
+                );
+
+                block_descriptor block_desc;
+                block_desc.next = block_descriptor_ptr();
+                block_desc.chunk = chunk_descriptor_ptr();
+                *block = block_desc;
+
+                oversized_block_descriptor_ptr tracker = static_cast<oversized_block_descriptor_ptr>(
+                    static_cast<void_ptr>(
+                        static_cast<char_ptr>(allocated) + size
+                    )
+                );
+
+                oversized_block_descriptor desc;
+                desc.size = size;
+                desc.alignment = m_options.alignment;
+                desc.next_cached = oversized_block_descriptor_ptr();
+                push_oversized(tracker, desc);
+
+                return allocated;
+            }
+
             void_ptr allocated = m_upstream->do_allocate(chunk_size + sizeof(chunk_descriptor), m_options.alignment);
+            m_statistics.upstream_allocated(chunk_size + sizeof(chunk_descriptor));
+
             chunk_descriptor_ptr chunk = static_cast<chunk_descriptor_ptr>(
                 static_cast<void_ptr>(
                     static_cast<char_ptr>(allocated) + chunk_size
@@ -397,6 +709,8 @@ public:
             chunk_descriptor chunk_desc;
             chunk_desc.size = chunk_size;
             chunk_desc.next = m_allocated;
+            chunk_desc.block_count = n;
+            chunk_desc.free_count = 0;
             *chunk = chunk_desc;
             m_allocated = chunk;
 
@@ -410,10 +724,17 @@ public:
 
                 block_descriptor block_desc;
                 block_desc.next = bucket.free_list;
+                block_desc.chunk = chunk;
                 *block = block_desc;
                 bucket.free_list = block;
             }
         }
+        else
+        {
+            ++bucket.hits;
+        }
+
+        m_statistics.allocated(bytes);
 
         // allocate a block from the front of the bucket's free list
         block_descriptor_ptr block = bucket.free_list;
@@ -444,37 +765,24 @@ public:
 
             oversized_block_descriptor desc = *block;
 
-            if (m_options.cache_oversized)
+            m_statistics.deallocated(desc.size);
+
+            // blocks are not cached above the hard cap
+            if (m_options.cache_oversized
+                && (m_options.hard_cap_bytes == 0 || m_statistics.pooled_bytes() <= m_options.hard_cap_bytes))
             {
                 desc.next_cached = m_cached_oversized;
                 *block = desc;
                 m_cached_oversized = block;
 
+                freed(desc.size);
                 return;
             }
 
-            if (!detail::pointer_traits<oversized_block_descriptor_ptr>::get(desc.prev))
-            {
-                assert(m_oversized == block);
-                m_oversized = desc.next;
-            }
-            else
-            {
-                oversized_block_descriptor prev = *desc.prev;
-                assert(prev.next == block);
-                prev.next = desc.next;
-                *desc.prev = prev;
-            }
-
-            if (detail::pointer_traits<oversized_block_descriptor_ptr>::get(desc.next))
-            {
-                oversized_block_descriptor next = *desc.next;
-                assert(next.prev == block);
-                next.prev = desc.prev;
-                *desc.next = next;
-            }
+            unlink_oversized(block, desc);
 
             m_upstream->do_deallocate(p, desc.size + sizeof(oversized_block_descriptor), desc.alignment);
+            m_statistics.upstream_deallocated(desc.size + sizeof(oversized_block_descriptor));
 
             return;
         }
@@ -486,16 +794,40 @@ public:
 
         n = static_cast<std::size_t>(1) << n_log2;
 
+        m_statistics.deallocated(n);
+
         block_descriptor_ptr block = static_cast<block_descriptor_ptr>(
             static_cast<void_ptr>(
                 static_cast<char_ptr>(p) + n
             )
         );
 
-        block_descriptor desc;
+        block_descriptor desc = *block;
+
+        // a block allocated directly from upstream because of the hard cap
+        if (!detail::pointer_traits<chunk_descriptor_ptr>::get(desc.chunk))
+        {
+            std::size_t size = n + block_descriptor_size();
+
+            oversized_block_descriptor_ptr tracker = static_cast<oversized_block_descriptor_ptr>(
+                static_cast<void_ptr>(
+                    static_cast<char_ptr>(p) + size
+                )
+            );
+            oversized_block_descriptor tracker_desc = *tracker;
+            unlink_oversized(tracker, tracker_desc);
+
+            m_upstream->do_deallocate(p, size + sizeof(oversized_block_descriptor), m_options.alignment);
+            m_statistics.fallback_deallocated(size + sizeof(oversized_block_descriptor));
+
+            return;
+        }
+
         desc.next = bucket.free_list;
         *block = desc;
         bucket.free_list = block;
+
+        freed(n);
     }
 };
 
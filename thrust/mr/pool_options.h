@@ -1,5 +1,6 @@
 /*
  *  Copyright 2018 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -90,6 +91,23 @@ struct pool_options
      */
     std::size_t cached_alignment_cutoff_factor;
 
+    /*! The number of bytes of upstream memory above which the pool resource returns free memory to upstream. When a
+     *      deallocation or a new chunk brings the pool above this size, fully free chunks and cached oversized blocks are
+     *      released until it is back under it, as if by \p trim. Zero means no limit.
+     */
+    std::size_t soft_cap_bytes;
+    /*! The number of bytes of upstream memory the pool resource never exceeds for its own chunks and cached blocks. When
+     *      a new chunk would exceed it even after trimming, the request is allocated directly from upstream instead, and
+     *      returned to it on deallocation; oversized blocks are not cached above it. Zero means no limit.
+     */
+    std::size_t hard_cap_bytes;
+    /*! The length, in milliseconds, of the intervals after which the pool resource returns the memory it did not need
+     *      during the whole interval, trimming itself to the highest number of bytes in use within it. The elapsed time is
+     *      checked on allocation and deallocation, so an unused pool is only trimmed on its next use. Zero disables the
+     *      decay.
+     */
+    std::size_t decay_interval_ms;
+
     /*! Checks if the options are self-consistent.
      *
      *  /returns true if the options are self-consitent, false otherwise.
@@ -116,6 +134,8 @@ struct pool_options
 
         if (alignment > smallest_block_size) return false;
 
+        if (soft_cap_bytes != 0 && hard_cap_bytes != 0 && soft_cap_bytes > hard_cap_bytes) return false;
+
         return true;
     }
 };
@@ -0,0 +1,235 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file pool_statistics.h
+ *  \brief Usage statistics reported by the pooling resource adaptors.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+THRUST_NAMESPACE_BEGIN
+namespace mr
+{
+
+/*! \addtogroup memory_resources Memory Resources
+ *  \ingroup memory_management
+ *  \{
+ */
+
+/*! Usage statistics of a single size class of a pooling resource adaptor.
+ */
+struct size_class_statistics
+{
+    /*! The size of the blocks of this size class. */
+    std::size_t block_size;
+    /*! The number of allocations served from blocks already cached by the pool. */
+    std::size_t hits;
+    /*! The number of allocations which required a new chunk to be allocated from upstream. */
+    std::size_t misses;
+};
+
+/*! Usage statistics of a pooling resource adaptor, as returned by its \p statistics member function. All the
+ *      counts are cumulative since the construction of the pool, while the byte counts reflect its current state.
+ *      They are meant for tuning \p pool_options for a given allocation pattern.
+ */
+struct pool_statistics
+{
+    pool_statistics()
+        : bytes_in_use(0),
+        peak_bytes_in_use(0),
+        upstream_bytes(0),
+        peak_upstream_bytes(0),
+        upstream_allocations(0),
+        upstream_deallocations(0),
+        oversized_hits(0),
+        oversized_misses(0),
+        fallback_allocations(0),
+        fallback_bytes(0),
+        size_classes()
+    {
+    }
+
+    /*! The number of bytes in the blocks currently handed out by the pool. Requests are rounded up to the size of
+     *      their size class.
+     */
+    std::size_t bytes_in_use;
+    /*! The highest value \p bytes_in_use has reached. */
+    std::size_t peak_bytes_in_use;
+    /*! The number of bytes currently allocated from upstream for chunks and oversized blocks, including the
+     *      descriptors embedded in them, but not the table of size classes.
+     */
+    std::size_t upstream_bytes;
+    /*! The highest value \p upstream_bytes has reached. */
+    std::size_t peak_upstream_bytes;
+    /*! The number of calls to \p do_allocate of upstream. */
+    std::size_t upstream_allocations;
+    /*! The number of calls to \p do_deallocate of upstream. */
+    std::size_t upstream_deallocations;
+    /*! The number of oversized or overaligned allocations served from the cache of such blocks. */
+    std::size_t oversized_hits;
+    /*! The number of oversized or overaligned allocations which required an allocation from upstream. */
+    std::size_t oversized_misses;
+    /*! The number of allocations made directly from upstream because a new chunk would have exceeded
+     *      \p pool_options::hard_cap_bytes.
+     */
+    std::size_t fallback_allocations;
+    /*! The number of bytes currently allocated directly from upstream that way; they are included in \p upstream_bytes.
+     */
+    std::size_t fallback_bytes;
+    /*! The statistics of every size class of the pool, from the smallest to the largest. */
+    std::vector<size_class_statistics> size_classes;
+
+    /*! The share of oversized or overaligned allocations served from the cache, or 0 if there were none.
+     */
+    double oversized_hit_rate() const
+    {
+        std::size_t total = oversized_hits + oversized_misses;
+        return total == 0 ? 0.0 : static_cast<double>(oversized_hits) / static_cast<double>(total);
+    }
+};
+
+/*! Formats pool statistics as a JSON object.
+ *
+ *  \param stats the statistics to format
+ *  \return a JSON object with a member for every field of \p stats, and the oversized cache hit rate
+ */
+inline std::string to_json(const pool_statistics & stats)
+{
+    std::ostringstream out;
+
+    out << "{\"bytes_in_use\":" << stats.bytes_in_use
+        << ",\"peak_bytes_in_use\":" << stats.peak_bytes_in_use
+        << ",\"upstream_bytes\":" << stats.upstream_bytes
+        << ",\"peak_upstream_bytes\":" << stats.peak_upstream_bytes
+        << ",\"upstream_allocations\":" << stats.upstream_allocations
+        << ",\"upstream_deallocations\":" << stats.upstream_deallocations
+        << ",\"oversized_hits\":" << stats.oversized_hits
+        << ",\"oversized_misses\":" << stats.oversized_misses
+        << ",\"oversized_hit_rate\":" << stats.oversized_hit_rate()
+        << ",\"fallback_allocations\":" << stats.fallback_allocations
+        << ",\"fallback_bytes\":" << stats.fallback_bytes
+        << ",\"size_classes\":[";
+
+    for (std::size_t i = 0; i < stats.size_classes.size(); ++i)
+    {
+        out << (i == 0 ? "" : ",")
+            << "{\"block_size\":" << stats.size_classes[i].block_size
+            << ",\"hits\":" << stats.size_classes[i].hits
+            << ",\"misses\":" << stats.size_classes[i].misses
+            << "}";
+    }
+
+    out << "]}";
+
+    return out.str();
+}
+
+/*! \} // memory_resources
+ */
+
+} // end mr
+
+namespace detail
+{
+
+// the counters kept by the pools; the per size class counters live in their buckets
+class pool_statistics_recorder
+{
+public:
+    void allocated(std::size_t bytes)
+    {
+        m_stats.bytes_in_use += bytes;
+        if (m_stats.bytes_in_use > m_stats.peak_bytes_in_use)
+        {
+            m_stats.peak_bytes_in_use = m_stats.bytes_in_use;
+        }
+    }
+
+    void deallocated(std::size_t bytes)
+    {
+        m_stats.bytes_in_use -= bytes;
+    }
+
+    void upstream_allocated(std::size_t bytes)
+    {
+        ++m_stats.upstream_allocations;
+        m_stats.upstream_bytes += bytes;
+        if (m_stats.upstream_bytes > m_stats.peak_upstream_bytes)
+        {
+            m_stats.peak_upstream_bytes = m_stats.upstream_bytes;
+        }
+    }
+
+    void upstream_deallocated(std::size_t bytes)
+    {
+        ++m_stats.upstream_deallocations;
+        m_stats.upstream_bytes -= bytes;
+    }
+
+    void oversized_hit()
+    {
+        ++m_stats.oversized_hits;
+    }
+
+    void oversized_miss()
+    {
+        ++m_stats.oversized_misses;
+    }
+
+    void fallback_allocated(std::size_t bytes)
+    {
+        upstream_allocated(bytes);
+        ++m_stats.fallback_allocations;
+        m_stats.fallback_bytes += bytes;
+    }
+
+    void fallback_deallocated(std::size_t bytes)
+    {
+        upstream_deallocated(bytes);
+        m_stats.fallback_bytes -= bytes;
+    }
+
+    // the upstream memory held by the pool itself, which the caps apply to
+    std::size_t pooled_bytes() const
+    {
+        return m_stats.upstream_bytes - m_stats.fallback_bytes;
+    }
+
+    // all blocks handed out are gone once the pool releases its memory
+    void released()
+    {
+        m_stats.bytes_in_use = 0;
+        m_stats.fallback_bytes = 0;
+    }
+
+    const thrust::mr::pool_statistics & get() const
+    {
+        return m_stats;
+    }
+
+private:
+    thrust::mr::pool_statistics m_stats;
+};
+
+} // end detail
+THRUST_NAMESPACE_END
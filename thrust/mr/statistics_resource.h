@@ -0,0 +1,199 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file statistics_resource.h
+ *  \brief A memory resource adaptor recording the allocations made through it.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/detail/cpp11_required.h>
+
+#if THRUST_CPP_DIALECT >= 2011
+
+#include <thrust/mr/memory_resource.h>
+#include <thrust/mr/validator.h>
+
+#include <atomic>
+#include <sstream>
+#include <string>
+
+THRUST_NAMESPACE_BEGIN
+namespace mr
+{
+
+/*! \addtogroup memory_resources Memory Resources
+ *  \ingroup memory_management
+ *  \{
+ */
+
+/*! Usage statistics of a \p statistics_resource. The counts are cumulative since its construction.
+ */
+struct resource_statistics
+{
+    /*! The number of calls to \p do_allocate. */
+    std::size_t allocations;
+    /*! The number of calls to \p do_deallocate. */
+    std::size_t deallocations;
+    /*! The total number of bytes ever allocated. */
+    std::size_t bytes_allocated;
+    /*! The number of bytes currently allocated. */
+    std::size_t bytes_in_use;
+    /*! The highest value \p bytes_in_use has reached. */
+    std::size_t peak_bytes_in_use;
+    /*! The size of the largest single allocation. */
+    std::size_t largest_allocation;
+};
+
+/*! Formats resource statistics as a JSON object.
+ *
+ *  \param stats the statistics to format
+ *  \return a JSON object with a member for every field of \p stats
+ */
+inline std::string to_json(const resource_statistics & stats)
+{
+    std::ostringstream out;
+
+    out << "{\"allocations\":" << stats.allocations
+        << ",\"deallocations\":" << stats.deallocations
+        << ",\"bytes_allocated\":" << stats.bytes_allocated
+        << ",\"bytes_in_use\":" << stats.bytes_in_use
+        << ",\"peak_bytes_in_use\":" << stats.peak_bytes_in_use
+        << ",\"largest_allocation\":" << stats.largest_allocation
+        << "}";
+
+    return out.str();
+}
+
+/*! A memory resource adaptor forwarding every allocation and deallocation to \p Upstream, and recording the number
+ *      of calls, the bytes in use and their high-water mark. The counters are atomic, so the adaptor is as thread-safe
+ *      as \p Upstream.
+ *
+ *  Placed under a pool, for instance as the upstream of an \p unsynchronized_pool_resource, it shows how often and
+ *      how much the pool allocates from the system; placed over a pool, it shows the allocation pattern of the
+ *      application.
+ *
+ *  \tparam Upstream the type of memory resources that will be used for allocating memory
+ */
+template<typename Upstream>
+class statistics_resource final
+    : public memory_resource<typename Upstream::pointer>,
+        private validator<Upstream>
+{
+    typedef typename Upstream::pointer void_ptr;
+
+public:
+    /*! Constructor. The upstream resource is obtained by calling \p get_global_resource<Upstream>.
+     */
+    statistics_resource()
+        : statistics_resource(get_global_resource<Upstream>())
+    {
+    }
+
+    /*! Constructor.
+     *
+     *  \param upstream the upstream memory resource for allocations
+     */
+    statistics_resource(Upstream * upstream)
+        : m_upstream(upstream),
+        m_allocations(0),
+        m_deallocations(0),
+        m_bytes_allocated(0),
+        m_bytes_in_use(0),
+        m_peak_bytes_in_use(0),
+        m_largest_allocation(0)
+    {
+    }
+
+    /*! Returns the upstream memory resource. */
+    Upstream * upstream_resource() const
+    {
+        return m_upstream;
+    }
+
+    /*! Returns the statistics recorded so far. When allocations are made concurrently with this call, the counters
+     *      are read one at a time, and may therefore be slightly inconsistent with each other.
+     */
+    resource_statistics statistics() const
+    {
+        resource_statistics ret;
+
+        ret.allocations = m_allocations.load(std::memory_order_relaxed);
+        ret.deallocations = m_deallocations.load(std::memory_order_relaxed);
+        ret.bytes_allocated = m_bytes_allocated.load(std::memory_order_relaxed);
+        ret.bytes_in_use = m_bytes_in_use.load(std::memory_order_relaxed);
+        ret.peak_bytes_in_use = m_peak_bytes_in_use.load(std::memory_order_relaxed);
+        ret.largest_allocation = m_largest_allocation.load(std::memory_order_relaxed);
+
+        return ret;
+    }
+
+    /*! Resets the high-water mark to the number of bytes currently in use, to measure the peak of a new phase.
+     */
+    void reset_peak()
+    {
+        m_peak_bytes_in_use.store(m_bytes_in_use.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    THRUST_NODISCARD virtual void_ptr do_allocate(std::size_t bytes, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
+    {
+        void_ptr ret = m_upstream->do_allocate(bytes, alignment);
+
+        m_allocations.fetch_add(1, std::memory_order_relaxed);
+        m_bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+
+        std::size_t in_use = m_bytes_in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        update_max(m_peak_bytes_in_use, in_use);
+        update_max(m_largest_allocation, bytes);
+
+        return ret;
+    }
+
+    virtual void do_deallocate(void_ptr p, std::size_t bytes, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
+    {
+        m_upstream->do_deallocate(p, bytes, alignment);
+
+        m_deallocations.fetch_add(1, std::memory_order_relaxed);
+        m_bytes_in_use.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+private:
+    static void update_max(std::atomic<std::size_t> & max, std::size_t value)
+    {
+        std::size_t current = max.load(std::memory_order_relaxed);
+        while (current < value && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    Upstream * m_upstream;
+
+    std::atomic<std::size_t> m_allocations;
+    std::atomic<std::size_t> m_deallocations;
+    std::atomic<std::size_t> m_bytes_allocated;
+    std::atomic<std::size_t> m_bytes_in_use;
+    std::atomic<std::size_t> m_peak_bytes_in_use;
+    std::atomic<std::size_t> m_largest_allocation;
+};
+
+/*! \} // memory_resources
+ */
+
+} // end mr
+THRUST_NAMESPACE_END
+
+#endif // THRUST_CPP_DIALECT >= 2011
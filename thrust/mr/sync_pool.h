@@ -1,5 +1,6 @@
 /*
  *  Copyright 2018 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -87,6 +88,26 @@ public:
         upstream_pool.release();
     }
 
+    /*! Returns fully free chunks and cached oversized blocks to upstream, until the pool holds at most \p target_bytes of
+     *      upstream memory, or has no more free memory to return.
+     *
+     *  \param target_bytes the number of bytes of upstream memory to trim the pool down to
+     *  \return the number of bytes returned to upstream
+     */
+    std::size_t trim(std::size_t target_bytes = 0)
+    {
+        lock_t lock(mtx);
+        return upstream_pool.trim(target_bytes);
+    }
+
+    /*! Returns the usage statistics of the pool.
+     */
+    pool_statistics statistics() const
+    {
+        lock_t lock(mtx);
+        return upstream_pool.statistics();
+    }
+
     THRUST_NODISCARD virtual void_ptr do_allocate(std::size_t bytes, std::size_t alignment = THRUST_MR_DEFAULT_ALIGNMENT) override
     {
         lock_t lock(mtx);
@@ -100,7 +121,7 @@ public:
     }
 
 private:
-    std::mutex mtx;
+    mutable std::mutex mtx;
     unsync_pool upstream_pool;
 };
 
@@ -0,0 +1,636 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file soa_vector.h
+ *  \brief A vector of tuples stored as one contiguous array per element of
+ *         the tuple.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/detail/cpp11_required.h>
+
+#if THRUST_CPP_DIALECT >= 2011
+
+#include <thrust/device_allocator.h>
+#include <thrust/iterator/iterator_traits.h>
+#include <thrust/iterator/zip_iterator.h>
+#include <thrust/tuple.h>
+#include <thrust/type_traits/integer_sequence.h>
+#include <thrust/universal_allocator.h>
+#include <thrust/detail/static_assert.h>
+#include <thrust/detail/vector_base.h>
+#include <thrust/detail/allocator/allocator_traits.h>
+
+#include <cstddef>
+#include <memory>
+#include <tuple>
+
+THRUST_NAMESPACE_BEGIN
+
+/*! \addtogroup container_classes Container Classes
+ *  \{
+ */
+
+/*! \p soa_span is a view of one column of a \p soa_vector: the contiguous
+ *  elements of a single element of its tuples. It is a plain pointer and a
+ *  size, which may be passed by value to device code, and is invalidated by
+ *  anything which reallocates the \p soa_vector.
+ *
+ *  \tparam Pointer The pointer type of the column, such as \c T* or
+ *          <tt>device_ptr<T></tt>.
+ *
+ *  \see soa_vector
+ */
+template<typename Pointer>
+  class soa_span
+{
+  public:
+    typedef Pointer                                              pointer;
+    typedef Pointer                                              iterator;
+    typedef typename thrust::iterator_value<Pointer>::type       value_type;
+    typedef typename thrust::iterator_reference<Pointer>::type   reference;
+    typedef std::size_t                                          size_type;
+
+    /*! This constructor creates a \p soa_span of \p size elements at \p data.
+     */
+    __host__ __device__
+    soa_span(pointer data, size_type size)
+      : m_data(data), m_size(size)
+    {}
+
+    /*! \return A pointer to the first element of this \p soa_span.
+     */
+    __host__ __device__
+    pointer data() const
+    {
+      return m_data;
+    }
+
+    __host__ __device__
+    iterator begin() const
+    {
+      return m_data;
+    }
+
+    __host__ __device__
+    iterator end() const
+    {
+      return m_data + m_size;
+    }
+
+    __host__ __device__
+    size_type size() const
+    {
+      return m_size;
+    }
+
+    __host__ __device__
+    bool empty() const
+    {
+      return m_size == 0;
+    }
+
+    __host__ __device__
+    reference operator[](size_type n) const
+    {
+      return m_data[n];
+    }
+
+  private:
+    pointer   m_data;
+    size_type m_size;
+};
+
+/*! \} // container_classes
+ */
+
+namespace detail
+{
+
+// the column types of a soa_vector: a vector_base per element of its tuples,
+// with the allocator rebound to the type of that element
+template<typename Tuple,
+         typename Alloc,
+         typename Fields = thrust::make_index_sequence<thrust::tuple_size<Tuple>::value> >
+  struct soa_vector_columns;
+
+template<typename Tuple, typename Alloc, std::size_t... Is>
+  struct soa_vector_columns<Tuple, Alloc, thrust::index_sequence<Is...> >
+{
+  template<std::size_t I>
+    struct column
+  {
+    typedef typename thrust::tuple_element<I, Tuple>::type value_type;
+
+    typedef vector_base<
+      value_type,
+      typename allocator_traits_detail::rebind_alloc<Alloc, value_type>::type
+    > type;
+  };
+
+  typedef std::tuple<typename column<Is>::type...> type;
+
+  typedef thrust::zip_iterator<
+    thrust::tuple<typename column<Is>::type::iterator...>
+  > iterator;
+
+  typedef thrust::zip_iterator<
+    thrust::tuple<typename column<Is>::type::const_iterator...>
+  > const_iterator;
+};
+
+} // end detail
+
+/*! \addtogroup container_classes Container Classes
+ *  \{
+ */
+
+/*! \p soa_vector is a sequence of tuples, such as
+ *  <tt>thrust::tuple<int, float></tt>, which stores each element of the tuples
+ *  in a contiguous array of its own, rather than the tuples side by side. Its
+ *  iterators are \p zip_iterators over these arrays, so that it may be used
+ *  with every algorithm taking a sequence of tuples, while each column is also
+ *  accessible on its own, as a \p soa_span, to the algorithms and kernels which
+ *  only need one of them. The \p sort_by_key of the host systems recognizes
+ *  these iterators as values: it sorts the keys along indices, and then moves
+ *  each column once.
+ *
+ *  All the columns have the same size, and grow together; each one grows its
+ *  storage through the growth policy of the allocator rebound to its element
+ *  type, so that their capacities may differ when that policy depends on the
+ *  size of the elements.
+ *
+ *  \code
+ *  #include <thrust/soa_vector.h>
+ *  #include <thrust/sort.h>
+ *  ...
+ *  thrust::device_soa_vector<thrust::tuple<int, float, double> > v(n);
+ *
+ *  // the keys of the particles
+ *  thrust::soa_span<thrust::device_ptr<int> > keys = v.column<0>();
+ *  ...
+ *  // copy the keys aside, and reorder the particles by key
+ *  thrust::device_vector<int> k(keys.begin(), keys.end());
+ *  thrust::sort_by_key(k.begin(), k.end(), v.begin());
+ *  \endcode
+ *
+ *  \tparam Tuple The type of the elements, a \p thrust::tuple.
+ *  \tparam Alloc The allocator of the elements, which is rebound to the type
+ *          of each column.
+ *
+ *  \see host_soa_vector
+ *  \see device_soa_vector
+ *  \see universal_soa_vector
+ *  \see zip_iterator
+ */
+template<typename Tuple, typename Alloc = thrust::device_allocator<Tuple> >
+  class soa_vector
+{
+  private:
+    THRUST_STATIC_ASSERT_MSG(thrust::tuple_size<Tuple>::value > 0,
+                             "the tuples of a soa_vector must not be empty");
+
+    typedef thrust::make_index_sequence<thrust::tuple_size<Tuple>::value> fields;
+    typedef detail::soa_vector_columns<Tuple, Alloc>                      columns;
+
+    template<typename, typename> friend class soa_vector;
+
+  public:
+    // typedefs
+    typedef Tuple                                                   value_type;
+    typedef Alloc                                                   allocator_type;
+    typedef std::size_t                                             size_type;
+    typedef std::ptrdiff_t                                          difference_type;
+    typedef typename columns::iterator                              iterator;
+    typedef typename columns::const_iterator                        const_iterator;
+    typedef typename thrust::iterator_reference<iterator>::type       reference;
+    typedef typename thrust::iterator_reference<const_iterator>::type const_reference;
+
+    /*! The \p soa_span of the elements of index \p I of the tuples.
+     */
+    template<std::size_t I>
+      using column_span = soa_span<typename columns::template column<I>::type::pointer>;
+
+    /*! The read only \p soa_span of the elements of index \p I of the tuples.
+     */
+    template<std::size_t I>
+      using const_column_span = soa_span<typename columns::template column<I>::type::const_pointer>;
+
+    /*! This constructor creates an empty \p soa_vector.
+     */
+    soa_vector()
+      : m_columns()
+    {}
+
+    /*! This constructor creates a \p soa_vector with value initialized elements.
+     *  \param n The number of elements to create.
+     */
+    explicit soa_vector(size_type n)
+      : m_columns()
+    {
+      resize(n);
+    }
+
+    /*! This constructor creates a \p soa_vector with copies of an exemplar element.
+     *  \param n The number of elements to create.
+     *  \param value An element to copy.
+     */
+    soa_vector(size_type n, const value_type &value)
+      : m_columns()
+    {
+      resize(n, value);
+    }
+
+    /*! This constructor creates a \p soa_vector with default initialized
+     *  elements, which leaves the columns of trivial types uninitialized.
+     *  \param n The number of elements to create.
+     */
+    soa_vector(size_type n, default_init_t)
+      : m_columns()
+    {
+      resize(n, default_init);
+    }
+
+    /*! Copy constructor copies from a \p soa_vector with another allocator,
+     *  such as one in another memory space, one column at a time.
+     *  \param v The \p soa_vector to copy.
+     */
+    template<typename OtherAlloc>
+    soa_vector(const soa_vector<Tuple, OtherAlloc> &v)
+      : m_columns()
+    {
+      assign_columns(v, fields());
+    }
+
+    /*! Assignment operator copies from a \p soa_vector with another allocator,
+     *  one column at a time.
+     *  \param v The \p soa_vector to copy.
+     */
+    template<typename OtherAlloc>
+    soa_vector &operator=(const soa_vector<Tuple, OtherAlloc> &v)
+    {
+      assign_columns(v, fields());
+      return *this;
+    }
+
+    /*! \return The number of elements in this \p soa_vector.
+     */
+    size_type size() const
+    {
+      return std::get<0>(m_columns).size();
+    }
+
+    /*! \return true if this \p soa_vector has no elements.
+     */
+    bool empty() const
+    {
+      return size() == 0;
+    }
+
+    /*! \return The number of elements this \p soa_vector can hold without
+     *          reallocating any of its columns.
+     */
+    size_type capacity() const
+    {
+      return capacity(fields());
+    }
+
+    /*! \return The largest number of elements this \p soa_vector can hold.
+     */
+    size_type max_size() const
+    {
+      return max_size(fields());
+    }
+
+    /*! Reserves storage for at least \p n elements in every column.
+     *  \param n The number of elements to reserve storage for.
+     *  \throw std::length_error If \p n exceeds \p max_size().
+     */
+    void reserve(size_type n)
+    {
+      reserve(n, fields());
+    }
+
+    /*! Resizes this \p soa_vector, value initializing the new elements. If a
+     *  column fails to grow, the columns which have already grown are shrunk
+     *  back, and the exception is rethrown.
+     *  \param new_size The number of elements this \p soa_vector should contain.
+     */
+    void resize(size_type new_size)
+    {
+      const size_type old_size = size();
+      try
+      {
+        resize_columns(new_size, fields());
+      }
+      catch(...)
+      {
+        truncate(old_size, fields());
+        throw;
+      }
+    }
+
+    /*! Resizes this \p soa_vector, copying an exemplar element to the new
+     *  elements.
+     *  \param new_size The number of elements this \p soa_vector should contain.
+     *  \param x The element to copy.
+     */
+    void resize(size_type new_size, const value_type &x)
+    {
+      const size_type old_size = size();
+      try
+      {
+        resize_columns(new_size, x, fields());
+      }
+      catch(...)
+      {
+        truncate(old_size, fields());
+        throw;
+      }
+    }
+
+    /*! Resizes this \p soa_vector, default initializing the new elements.
+     *  \param new_size The number of elements this \p soa_vector should contain.
+     */
+    void resize(size_type new_size, default_init_t)
+    {
+      const size_type old_size = size();
+      try
+      {
+        resize_columns(new_size, default_init, fields());
+      }
+      catch(...)
+      {
+        truncate(old_size, fields());
+        throw;
+      }
+    }
+
+    /*! Appends an element to the end of this \p soa_vector.
+     *  \param x The element to append.
+     */
+    void push_back(const value_type &x)
+    {
+      const size_type old_size = size();
+      try
+      {
+        push_back_columns(x, fields());
+      }
+      catch(...)
+      {
+        truncate(old_size, fields());
+        throw;
+      }
+    }
+
+    /*! Erases the last element of this \p soa_vector.
+     */
+    void pop_back()
+    {
+      truncate(size() - 1, fields());
+    }
+
+    /*! Erases all the elements of this \p soa_vector, keeping its storage.
+     */
+    void clear()
+    {
+      truncate(0, fields());
+    }
+
+    /*! Releases the storage of every column beyond its size.
+     */
+    void shrink_to_fit()
+    {
+      shrink_to_fit(fields());
+    }
+
+    /*! Swaps the columns of this \p soa_vector with those of another.
+     *  \param v The \p soa_vector to swap with.
+     */
+    void swap(soa_vector &v)
+    {
+      swap(v, fields());
+    }
+
+    iterator begin()
+    {
+      return begin(fields());
+    }
+
+    const_iterator begin() const
+    {
+      return cbegin(fields());
+    }
+
+    const_iterator cbegin() const
+    {
+      return cbegin(fields());
+    }
+
+    iterator end()
+    {
+      return begin() + static_cast<difference_type>(size());
+    }
+
+    const_iterator end() const
+    {
+      return cbegin() + static_cast<difference_type>(size());
+    }
+
+    const_iterator cend() const
+    {
+      return cbegin() + static_cast<difference_type>(size());
+    }
+
+    /*! \return A tuple of references to the elements of index \p n of every
+     *          column.
+     */
+    reference operator[](size_type n)
+    {
+      return begin()[static_cast<difference_type>(n)];
+    }
+
+    const_reference operator[](size_type n) const
+    {
+      return cbegin()[static_cast<difference_type>(n)];
+    }
+
+    /*! \return A \p soa_span of the elements of index \p I of the tuples.
+     */
+    template<std::size_t I>
+    column_span<I> column()
+    {
+      return column_span<I>(std::get<I>(m_columns).data(), size());
+    }
+
+    /*! \return A read only \p soa_span of the elements of index \p I of the tuples.
+     */
+    template<std::size_t I>
+    const_column_span<I> column() const
+    {
+      return const_column_span<I>(std::get<I>(m_columns).data(), size());
+    }
+
+  private:
+    typename columns::type m_columns;
+
+    template<typename OtherAlloc, std::size_t... Is>
+    void assign_columns(const soa_vector<Tuple, OtherAlloc> &v, thrust::index_sequence<Is...>)
+    {
+      auto l = { (std::get<Is>(m_columns) = std::get<Is>(v.m_columns), 0)... };
+      THRUST_UNUSED_VAR(l);
+    }
+
+    static size_type smaller(size_type a, size_type b)
+    {
+      return a < b ? a : b;
+    }
+
+    template<std::size_t... Is>
+    size_type capacity(thrust::index_sequence<Is...>) const
+    {
+      size_type result = std::get<0>(m_columns).capacity();
+      auto l = { (result = smaller(result, std::get<Is>(m_columns).capacity()), 0)... };
+      THRUST_UNUSED_VAR(l);
+      return result;
+    }
+
+    template<std::size_t... Is>
+    size_type max_size(thrust::index_sequence<Is...>) const
+    {
+      size_type result = std::get<0>(m_columns).max_size();
+      auto l = { (result = smaller(result, std::get<Is>(m_columns).max_size()), 0)... };
+      THRUST_UNUSED_VAR(l);
+      return result;
+    }
+
+    template<std::size_t... Is>
+    void reserve(size_type n, thrust::index_sequence<Is...>)
+    {
+      auto l = { (std::get<Is>(m_columns).reserve(n), 0)... };
+      THRUST_UNUSED_VAR(l);
+    }
+
+    // the columns grow one after the other, from the first one; the callers
+    // shrink them back when one of them throws
+    template<std::size_t... Is>
+    void resize_columns(size_type new_size, thrust::index_sequence<Is...>)
+    {
+      auto l = { (std::get<Is>(m_columns).resize(new_size), 0)... };
+      THRUST_UNUSED_VAR(l);
+    }
+
+    template<std::size_t... Is>
+    void resize_columns(size_type new_size, const value_type &x, thrust::index_sequence<Is...>)
+    {
+      auto l = { (std::get<Is>(m_columns).resize(new_size, thrust::get<Is>(x)), 0)... };
+      THRUST_UNUSED_VAR(l);
+    }
+
+    template<std::size_t... Is>
+    void resize_columns(size_type new_size, default_init_t, thrust::index_sequence<Is...>)
+    {
+      auto l = { (std::get<Is>(m_columns).resize(new_size, default_init), 0)... };
+      THRUST_UNUSED_VAR(l);
+    }
+
+    template<std::size_t... Is>
+    void push_back_columns(const value_type &x, thrust::index_sequence<Is...>)
+    {
+      auto l = { (std::get<Is>(m_columns).push_back(thrust::get<Is>(x)), 0)... };
+      THRUST_UNUSED_VAR(l);
+    }
+
+    // erases the elements past n of every column which has more
+    template<std::size_t... Is>
+    void truncate(size_type n, thrust::index_sequence<Is...>)
+    {
+      auto l = { (truncate(std::get<Is>(m_columns), n), 0)... };
+      THRUST_UNUSED_VAR(l);
+    }
+
+    template<typename Column>
+    static void truncate(Column &column, size_type n)
+    {
+      if(column.size() > n)
+      {
+        column.erase(column.begin() + static_cast<difference_type>(n), column.end());
+      }
+    }
+
+    template<std::size_t... Is>
+    void shrink_to_fit(thrust::index_sequence<Is...>)
+    {
+      auto l = { (std::get<Is>(m_columns).shrink_to_fit(), 0)... };
+      THRUST_UNUSED_VAR(l);
+    }
+
+    template<std::size_t... Is>
+    void swap(soa_vector &v, thrust::index_sequence<Is...>)
+    {
+      auto l = { (std::get<Is>(m_columns).swap(std::get<Is>(v.m_columns)), 0)... };
+      THRUST_UNUSED_VAR(l);
+    }
+
+    template<std::size_t... Is>
+    iterator begin(thrust::index_sequence<Is...>)
+    {
+      return iterator(thrust::make_tuple(std::get<Is>(m_columns).begin()...));
+    }
+
+    template<std::size_t... Is>
+    const_iterator cbegin(thrust::index_sequence<Is...>) const
+    {
+      return const_iterator(thrust::make_tuple(std::get<Is>(m_columns).cbegin()...));
+    }
+};
+
+/*! Exchanges the contents of two \p soa_vectors.
+ *  \param a The first \p soa_vector of interest.
+ *  \param b The second \p soa_vector of interest.
+ */
+template<typename Tuple, typename Alloc>
+  void swap(soa_vector<Tuple, Alloc> &a, soa_vector<Tuple, Alloc> &b)
+{
+  a.swap(b);
+}
+
+/*! \p host_soa_vector is a \p soa_vector whose columns reside in host memory.
+ */
+template<typename Tuple>
+  using host_soa_vector = soa_vector<Tuple, std::allocator<Tuple> >;
+
+/*! \p device_soa_vector is a \p soa_vector whose columns reside in memory
+ *  accessible to the device system.
+ */
+template<typename Tuple>
+  using device_soa_vector = soa_vector<Tuple, thrust::device_allocator<Tuple> >;
+
+/*! \p universal_soa_vector is a \p soa_vector whose columns reside in memory
+ *  accessible to both the host and the device system.
+ */
+template<typename Tuple>
+  using universal_soa_vector = soa_vector<Tuple, thrust::universal_allocator<Tuple> >;
+
+/*! \} // container_classes
+ */
+
+THRUST_NAMESPACE_END
+
+#endif // THRUST_CPP_DIALECT >= 2011
@@ -18,5 +18,80 @@
 
 #include <thrust/detail/config.h>
 
-// this system has no special temporary buffer functions
+// unless THRUST_HOST_NO_CACHING_TEMPORARY_ALLOCATOR is defined, the temporary
+// buffers of this system, and of the systems derived from it, come from a
+// thread-local cache of blocks instead of malloc,
+// see thrust/detail/host_caching_allocator.h
+#ifndef THRUST_HOST_NO_CACHING_TEMPORARY_ALLOCATOR
+
+#include <thrust/system/cpp/detail/execution_policy.h>
+#include <thrust/detail/host_caching_allocator.h>
+#include <thrust/detail/pointer.h>
+#include <thrust/detail/raw_pointer_cast.h>
+#include <thrust/pair.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace cpp
+{
+namespace detail
+{
+
+
+// the two-argument return_temporary_buffer is not given the size of the
+// buffer, so it is recorded in front of it, along with the alignment
+struct temporary_buffer_header
+{
+  std::size_t bytes;
+  std::size_t alignment;
+};
+
+
+inline __host__
+std::size_t temporary_buffer_header_size(std::size_t alignment)
+{
+  return (sizeof(temporary_buffer_header) + alignment - 1) / alignment * alignment;
+}
+
+
+template<typename T, typename DerivedPolicy>
+__host__
+  thrust::pair<thrust::pointer<T,DerivedPolicy>, typename thrust::pointer<T,DerivedPolicy>::difference_type>
+    get_temporary_buffer(execution_policy<DerivedPolicy> &, typename thrust::pointer<T,DerivedPolicy>::difference_type n)
+{
+  const std::size_t alignment = THRUST_ALIGNOF(T) > THRUST_MR_DEFAULT_ALIGNMENT ? THRUST_ALIGNOF(T) : THRUST_MR_DEFAULT_ALIGNMENT;
+  const std::size_t header_size = temporary_buffer_header_size(alignment);
+  const std::size_t bytes = header_size + sizeof(T) * static_cast<std::size_t>(n);
+
+  char *raw = static_cast<char *>(thrust::detail::host_tls_caching_resource().do_allocate(bytes, alignment));
+  char *buffer = raw + header_size;
+
+  temporary_buffer_header *header = reinterpret_cast<temporary_buffer_header *>(buffer) - 1;
+  header->bytes = bytes;
+  header->alignment = alignment;
+
+  return thrust::make_pair(thrust::pointer<T,DerivedPolicy>(reinterpret_cast<T *>(buffer)), n);
+} // end get_temporary_buffer()
+
+
+template<typename DerivedPolicy, typename Pointer>
+__host__
+  void return_temporary_buffer(execution_policy<DerivedPolicy> &, Pointer p)
+{
+  char *buffer = reinterpret_cast<char *>(thrust::raw_pointer_cast(p));
+
+  const temporary_buffer_header header = *(reinterpret_cast<temporary_buffer_header *>(buffer) - 1);
+
+  thrust::detail::host_tls_caching_resource().do_deallocate(
+    buffer - temporary_buffer_header_size(header.alignment), header.bytes, header.alignment);
+} // end return_temporary_buffer()
+
+
+} // end detail
+} // end cpp
+} // end system
+THRUST_NAMESPACE_END
+
+#endif // THRUST_HOST_NO_CACHING_TEMPORARY_ALLOCATOR
 
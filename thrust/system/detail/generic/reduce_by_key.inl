@@ -30,7 +30,13 @@
 
 #include <thrust/detail/internal_functional.h>
 #include <thrust/scan.h>
+#include <thrust/for_each.h>
+#include <thrust/iterator/counting_iterator.h>
 #include <thrust/detail/temporary_array.h>
+#include <thrust/detail/raw_pointer_cast.h>
+#include <thrust/detail/function.h>
+#include <thrust/detail/minmax.h>
+#include <thrust/detail/cstdint.h>
 
 THRUST_NAMESPACE_BEGIN
 namespace system
@@ -62,6 +68,183 @@ struct reduce_by_key_functor
 };
 
 
+// the input is processed in tiles of this many elements, all temporary
+// storage is proportional to the number of tiles
+const static int reduce_by_key_tile_size = 4096;
+
+
+// reduces one tile to the number of segments ending inside it and to the
+// (flag, value) partial of its last segment, flag is set when that segment
+// starts inside the tile
+template <typename InputIterator1,
+          typename InputIterator2,
+          typename ValueType,
+          typename FlagType,
+          typename Size,
+          typename BinaryPredicate,
+          typename BinaryFunction>
+struct reduce_by_key_partial_functor
+{
+  InputIterator1 keys_first;
+  InputIterator2 values_first;
+  Size n;
+  ValueType *partials;
+  FlagType *flags;
+  Size *counts;
+  BinaryPredicate binary_pred;
+  thrust::detail::wrapped_function<BinaryFunction,ValueType> binary_op;
+
+  __host__ __device__
+  reduce_by_key_partial_functor(InputIterator1 keys_first,
+                                InputIterator2 values_first,
+                                Size n,
+                                ValueType *partials,
+                                FlagType *flags,
+                                Size *counts,
+                                BinaryPredicate binary_pred,
+                                BinaryFunction binary_op)
+    : keys_first(keys_first), values_first(values_first), n(n),
+      partials(partials), flags(flags), counts(counts),
+      binary_pred(binary_pred), binary_op(binary_op)
+  {}
+
+  __thrust_exec_check_disable__
+  __host__ __device__
+  void operator()(Size tile) const
+  {
+    typedef typename thrust::iterator_value<InputIterator1>::type KeyType;
+
+    const Size begin = tile * reduce_by_key_tile_size;
+    const Size end   = thrust::min<Size>(begin + reduce_by_key_tile_size, n);
+
+    KeyType key = keys_first[begin];
+
+    FlagType flag  = (begin == 0 || !binary_pred(keys_first[begin - 1], key)) ? 1 : 0;
+    Size     count = 0;
+
+    ValueType sum = values_first[begin];
+
+    for(Size i = begin + 1; i < end; ++i)
+    {
+      KeyType next_key = keys_first[i];
+
+      if(binary_pred(key, next_key))
+      {
+        sum = binary_op(sum, values_first[i]);
+      }
+      else
+      {
+        sum  = values_first[i];
+        flag = 1;
+        ++count;
+      }
+
+      key = next_key;
+    }
+
+    // the last element closes a segment when the next tile starts a new one
+    if(end == n || !binary_pred(key, keys_first[end]))
+    {
+      ++count;
+    }
+
+    partials[tile] = sum;
+    flags[tile]    = flag;
+    counts[tile]   = count;
+  }
+};
+
+
+// reduces the segments of one tile, the segment open at the start of the
+// tile is continued from the carry of the preceding tiles
+// keys are written by the tile holding the segment's head and values by the
+// tile holding its tail, both at the segment's scanned output position
+template <typename InputIterator1,
+          typename InputIterator2,
+          typename OutputIterator1,
+          typename OutputIterator2,
+          typename ValueType,
+          typename Size,
+          typename BinaryPredicate,
+          typename BinaryFunction>
+struct reduce_by_key_tile_functor
+{
+  InputIterator1 keys_first;
+  InputIterator2 values_first;
+  OutputIterator1 keys_output;
+  OutputIterator2 values_output;
+  Size n;
+  const ValueType *carries;
+  const Size *offsets;
+  BinaryPredicate binary_pred;
+  thrust::detail::wrapped_function<BinaryFunction,ValueType> binary_op;
+
+  __host__ __device__
+  reduce_by_key_tile_functor(InputIterator1 keys_first,
+                             InputIterator2 values_first,
+                             OutputIterator1 keys_output,
+                             OutputIterator2 values_output,
+                             Size n,
+                             const ValueType *carries,
+                             const Size *offsets,
+                             BinaryPredicate binary_pred,
+                             BinaryFunction binary_op)
+    : keys_first(keys_first), values_first(values_first),
+      keys_output(keys_output), values_output(values_output), n(n),
+      carries(carries), offsets(offsets),
+      binary_pred(binary_pred), binary_op(binary_op)
+  {}
+
+  __thrust_exec_check_disable__
+  __host__ __device__
+  void operator()(Size tile) const
+  {
+    typedef typename thrust::iterator_value<InputIterator1>::type KeyType;
+
+    const Size begin = tile * reduce_by_key_tile_size;
+    const Size end   = thrust::min<Size>(begin + reduce_by_key_tile_size, n);
+
+    Size output = offsets[tile];
+
+    KeyType key = keys_first[begin];
+
+    const bool is_head = begin == 0 || !binary_pred(keys_first[begin - 1], key);
+
+    ValueType sum = is_head ? ValueType(values_first[begin]) : binary_op(carries[tile - 1], values_first[begin]);
+
+    if(is_head)
+    {
+      keys_output[output] = key;
+    }
+
+    for(Size i = begin + 1; i < end; ++i)
+    {
+      KeyType next_key = keys_first[i];
+
+      if(binary_pred(key, next_key))
+      {
+        sum = binary_op(sum, values_first[i]);
+      }
+      else
+      {
+        values_output[output] = sum;
+        ++output;
+
+        keys_output[output] = next_key;
+        sum = values_first[i];
+      }
+
+      key = next_key;
+    }
+
+    if(end == n || !binary_pred(key, keys_first[end]))
+    {
+      values_output[output] = sum;
+    }
+  }
+};
+
+
 } // end namespace detail
 
 
@@ -85,7 +268,7 @@ __host__ __device__
 {
     typedef typename thrust::iterator_traits<InputIterator1>::difference_type difference_type;
 
-    typedef unsigned int FlagType;  // TODO use difference_type
+    typedef thrust::detail::uint8_t FlagType;
 
     // Use the input iterator's value type per https://wg21.link/P0571
     using ValueType = typename thrust::iterator_value<InputIterator2>::type;
@@ -96,37 +279,43 @@ __host__ __device__
     // input size
     difference_type n = keys_last - keys_first;
 
-    InputIterator2 values_last = values_first + n;
+    const difference_type num_tiles = (n + detail::reduce_by_key_tile_size - 1) / detail::reduce_by_key_tile_size;
+
+    thrust::detail::temporary_array<ValueType,ExecutionPolicy>       partials(exec, num_tiles);
+    thrust::detail::temporary_array<FlagType,ExecutionPolicy>        flags(exec, num_tiles);
+    thrust::detail::temporary_array<difference_type,ExecutionPolicy> counts(exec, num_tiles + 1);
 
-    // compute head flags
-    thrust::detail::temporary_array<FlagType,ExecutionPolicy> head_flags(exec, n);
-    thrust::transform(exec, keys_first, keys_last - 1, keys_first + 1, head_flags.begin() + 1, thrust::detail::not2(binary_pred));
-    head_flags[0] = 1;
+    ValueType       *partials_ptr = thrust::raw_pointer_cast(&*partials.begin());
+    FlagType        *flags_ptr    = thrust::raw_pointer_cast(&*flags.begin());
+    difference_type *counts_ptr   = thrust::raw_pointer_cast(&*counts.begin());
 
-    // compute tail flags
-    thrust::detail::temporary_array<FlagType,ExecutionPolicy> tail_flags(exec, n); //COPY INSTEAD OF TRANSFORM
-    thrust::transform(exec, keys_first, keys_last - 1, keys_first + 1, tail_flags.begin(), thrust::detail::not2(binary_pred));
-    tail_flags[n-1] = 1;
+    thrust::counting_iterator<difference_type> tiles_first(0);
+    thrust::counting_iterator<difference_type> tiles_last(num_tiles);
 
-    // scan the values by flag
-    thrust::detail::temporary_array<ValueType,ExecutionPolicy> scanned_values(exec, n);
-    thrust::detail::temporary_array<FlagType,ExecutionPolicy>  scanned_tail_flags(exec, n);
+    // reduce each tile to its segment count and the partial of its last segment
+    thrust::for_each(exec, tiles_first, tiles_last,
+                     detail::reduce_by_key_partial_functor<InputIterator1, InputIterator2, ValueType, FlagType, difference_type, BinaryPredicate, BinaryFunction>
+                       (keys_first, values_first, n, partials_ptr, flags_ptr, counts_ptr, binary_pred, binary_op));
 
+    // scan the partials by flag, partials[t] becomes the carry into tile t + 1
     thrust::inclusive_scan
         (exec,
-         thrust::make_zip_iterator(thrust::make_tuple(values_first,           head_flags.begin())),
-         thrust::make_zip_iterator(thrust::make_tuple(values_last,            head_flags.end())),
-         thrust::make_zip_iterator(thrust::make_tuple(scanned_values.begin(), scanned_tail_flags.begin())),
+         thrust::make_zip_iterator(thrust::make_tuple(partials.begin(), flags.begin())),
+         thrust::make_zip_iterator(thrust::make_tuple(partials.end(),   flags.end())),
+         thrust::make_zip_iterator(thrust::make_tuple(partials.begin(), flags.begin())),
          detail::reduce_by_key_functor<ValueType, FlagType, BinaryFunction>(binary_op));
 
-    thrust::exclusive_scan(exec, tail_flags.begin(), tail_flags.end(), scanned_tail_flags.begin(), FlagType(0), thrust::plus<FlagType>());
+    // scan the segment counts into output offsets
+    counts[num_tiles] = 0;
+    thrust::exclusive_scan(exec, counts.begin(), counts.end(), counts.begin(), difference_type(0), thrust::plus<difference_type>());
 
     // number of unique keys
-    FlagType N = scanned_tail_flags[n - 1] + 1;
+    difference_type N = counts[num_tiles];
 
-    // scatter the keys and accumulated values
-    thrust::scatter_if(exec, keys_first,            keys_last,             scanned_tail_flags.begin(), head_flags.begin(), keys_output);
-    thrust::scatter_if(exec, scanned_values.begin(), scanned_values.end(), scanned_tail_flags.begin(), tail_flags.begin(), values_output);
+    // reduce the segments of each tile directly into the output
+    thrust::for_each(exec, tiles_first, tiles_last,
+                     detail::reduce_by_key_tile_functor<InputIterator1, InputIterator2, OutputIterator1, OutputIterator2, ValueType, difference_type, BinaryPredicate, BinaryFunction>
+                       (keys_first, values_first, keys_output, values_output, n, partials_ptr, counts_ptr, binary_pred, binary_op));
 
     return thrust::make_pair(keys_output + N, values_output + N);
 } // end reduce_by_key()
@@ -0,0 +1,72 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/detail/raw_reference_cast.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace detail
+{
+namespace internal
+{
+
+  // returns the number of elements of [first1, first1 + n1) which precede
+  // output position diagonal when [first1, first1 + n1) and [first2, first2 + n2)
+  // are stably merged; ties are resolved in favor of the first range, so the
+  // partition agrees with thrust::merge and may be used to split a merge
+  // into independent pieces at arbitrary output positions
+  __thrust_exec_check_disable__
+  template <typename RandomAccessIterator1,
+            typename RandomAccessIterator2,
+            typename Size,
+            typename StrictWeakOrdering>
+  __host__ __device__
+    Size merge_path(RandomAccessIterator1 first1, Size n1,
+                    RandomAccessIterator2 first2, Size n2,
+                    Size diagonal,
+                    StrictWeakOrdering comp)
+    {
+      Size lo = diagonal > n2 ? diagonal - n2 : Size(0);
+      Size hi = diagonal < n1 ? diagonal : n1;
+
+      while(lo < hi)
+      {
+        Size mid = lo + (hi - lo) / 2;
+
+        if(comp(thrust::raw_reference_cast(first2[diagonal - 1 - mid]),
+                thrust::raw_reference_cast(first1[mid])))
+        {
+          hi = mid;
+        }
+        else
+        {
+          lo = mid + 1;
+        }
+      }
+
+      return lo;
+    }
+
+
+} // end namespace internal
+} // end namespace detail
+} // end namespace system
+THRUST_NAMESPACE_END
+
@@ -0,0 +1,334 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file parallel_compact.h
+ *  \brief In-place tiled remove_if and unique, shared by the multicore
+ *         host backends.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/system/detail/internal/decompose.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/detail/temporary_array.h>
+#include <thrust/detail/raw_pointer_cast.h>
+#include <thrust/detail/raw_reference_cast.h>
+#include <thrust/system/detail/sequential/remove.h>
+#include <thrust/system/detail/sequential/unique.h>
+#include <thrust/copy.h>
+#include <thrust/for_each.h>
+#include <thrust/detail/seq.h>
+#include <thrust/detail/minmax.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace detail
+{
+namespace internal
+{
+
+
+// sequential compactions, applied to each tile in place; these call the sequential
+// backend directly, as the public headers would include this one again through
+// the omp and tbb remove and unique
+template<typename Predicate>
+struct remove_if_op
+{
+  Predicate pred;
+
+  remove_if_op(Predicate pred)
+    : pred(pred)
+  {}
+
+  template<typename RandomAccessIterator, typename Size>
+  RandomAccessIterator operator()(RandomAccessIterator first, Size begin, Size end) const
+  {
+    thrust::detail::seq_t seq;
+    return thrust::system::detail::sequential::remove_if(seq, first + begin, first + end, pred);
+  }
+};
+
+
+template<typename InputIterator, typename Predicate>
+struct remove_if_stencil_op
+{
+  InputIterator stencil;
+  Predicate pred;
+
+  remove_if_stencil_op(InputIterator stencil, Predicate pred)
+    : stencil(stencil), pred(pred)
+  {}
+
+  template<typename RandomAccessIterator, typename Size>
+  RandomAccessIterator operator()(RandomAccessIterator first, Size begin, Size end) const
+  {
+    thrust::detail::seq_t seq;
+    return thrust::system::detail::sequential::remove_if(seq, first + begin, first + end, stencil + begin, pred);
+  }
+};
+
+
+template<typename BinaryPredicate>
+struct unique_op
+{
+  BinaryPredicate binary_pred;
+
+  unique_op(BinaryPredicate binary_pred)
+    : binary_pred(binary_pred)
+  {}
+
+  template<typename RandomAccessIterator, typename Size>
+  RandomAccessIterator operator()(RandomAccessIterator first, Size begin, Size end) const
+  {
+    thrust::detail::seq_t seq;
+    return thrust::system::detail::sequential::unique(seq, first + begin, first + end, binary_pred);
+  }
+};
+
+
+namespace parallel_compact_detail
+{
+
+
+// tiles smaller than this are not worth a task of their own
+const static int grain_size = 4096;
+
+
+// compacts one tile to its front and records the range of survivors
+template<typename RandomAccessIterator, typename Size, typename CompactOperation>
+struct compact_tile
+{
+  RandomAccessIterator first;
+  uniform_decomposition<Size> decomp;
+  Size *sources;
+  Size *counts;
+  CompactOperation compact_op;
+
+  compact_tile(RandomAccessIterator first,
+               uniform_decomposition<Size> decomp,
+               Size *sources,
+               Size *counts,
+               CompactOperation compact_op)
+    : first(first), decomp(decomp), sources(sources), counts(counts), compact_op(compact_op)
+  {}
+
+  void operator()(Size tile) const
+  {
+    // sources[tile] may already skip the tile's first element, see parallel_unique
+    const Size end = compact_op(first, decomp[tile].begin(), decomp[tile].end()) - first;
+
+    counts[tile] = end - sources[tile];
+  }
+};
+
+
+// moves the survivors of one tile to their final position
+// the destination never lies to the right of the source, so a forward copy is safe
+template<typename RandomAccessIterator, typename Size>
+struct move_tile
+{
+  RandomAccessIterator first;
+  const Size *sources;
+  const Size *counts;
+  const Size *offsets;
+
+  move_tile(RandomAccessIterator first, const Size *sources, const Size *counts, const Size *offsets)
+    : first(first), sources(sources), counts(counts), offsets(offsets)
+  {}
+
+  void operator()(Size tile) const
+  {
+    thrust::copy(thrust::seq, first + sources[tile], first + sources[tile] + counts[tile], first + offsets[tile]);
+  }
+};
+
+
+// compacts every tile in parallel, scans the survivor counts and moves the
+// tiles into place
+// a tile may only move once every earlier tile whose survivors overlap its
+// destination has moved, so the moves are performed in rounds: tiles of the
+// same round are independent and move in parallel
+template<typename DerivedPolicy, typename RandomAccessIterator, typename Size, typename CompactOperation>
+RandomAccessIterator compact(thrust::execution_policy<DerivedPolicy> &exec,
+                             RandomAccessIterator first,
+                             uniform_decomposition<Size> decomp,
+                             Size *sources,
+                             CompactOperation compact_op)
+{
+  const Size num_tiles = decomp.size();
+
+  thrust::detail::temporary_array<Size,DerivedPolicy> temp(exec, 4 * num_tiles);
+
+  Size *counts  = thrust::raw_pointer_cast(&*temp.begin());
+  Size *offsets = counts  + num_tiles;
+  Size *rounds  = offsets + num_tiles;
+  Size *movers  = rounds  + num_tiles;
+
+  thrust::counting_iterator<Size> tiles_first(0);
+  thrust::counting_iterator<Size> tiles_last(num_tiles);
+
+  // compact each tile to its front
+  thrust::for_each(exec, tiles_first, tiles_last,
+                   compact_tile<RandomAccessIterator,Size,CompactOperation>(first, decomp, sources, counts, compact_op));
+
+  // scan the counts into output offsets and schedule the moves
+  // tiles which need not move are assigned round -1
+  Size sum = 0;
+  Size num_rounds = 0;
+
+  for(Size tile = 0; tile < num_tiles; ++tile)
+  {
+    offsets[tile] = sum;
+    rounds[tile]  = -1;
+
+    if(counts[tile] != 0 && sources[tile] != sum)
+    {
+      rounds[tile] = 0;
+
+      // the survivors of earlier tiles end in nondecreasing order, so only a
+      // run of immediately preceding tiles can overlap this tile's destination
+      for(Size i = tile; i-- > 0 && sources[i] + counts[i] > sum; )
+      {
+        if(sources[i] < sum + counts[tile])
+        {
+          rounds[tile] = thrust::max(rounds[tile], rounds[i] + 1);
+        }
+      }
+
+      num_rounds = thrust::max(num_rounds, rounds[tile] + 1);
+    }
+
+    sum += counts[tile];
+  }
+
+  // move the tiles round by round
+  for(Size round = 0; round < num_rounds; ++round)
+  {
+    Size num_movers = 0;
+
+    for(Size tile = 0; tile < num_tiles; ++tile)
+    {
+      if(rounds[tile] == round)
+      {
+        movers[num_movers++] = tile;
+      }
+    }
+
+    thrust::for_each(exec, movers, movers + num_movers,
+                     move_tile<RandomAccessIterator,Size>(first, sources, counts, offsets));
+  }
+
+  return first + sum;
+}
+
+
+} // end namespace parallel_compact_detail
+
+
+// compacts [first, last) in place with compact_op, a sequential in-place
+// compaction such as remove_if_op, using an O(num_tiles) temporary
+// every tile is compacted to its front in parallel, the survivor counts are
+// scanned and the tiles are then shifted left into place
+// the per-tile work is distributed with thrust::for_each on exec's system
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename CompactOperation,
+         typename Size>
+RandomAccessIterator parallel_compact(thrust::execution_policy<DerivedPolicy> &exec,
+                                      RandomAccessIterator first,
+                                      RandomAccessIterator last,
+                                      CompactOperation compact_op,
+                                      Size max_tiles)
+{
+  using namespace parallel_compact_detail;
+
+  const Size n = last - first;
+
+  uniform_decomposition<Size> decomp(n, grain_size, max_tiles);
+
+  const Size num_tiles = decomp.size();
+
+  if(num_tiles <= 1)
+  {
+    return compact_op(first, Size(0), n);
+  }
+
+  thrust::detail::temporary_array<Size,DerivedPolicy> sources(exec, num_tiles);
+  Size *sources_ptr = thrust::raw_pointer_cast(&*sources.begin());
+
+  for(Size tile = 0; tile < num_tiles; ++tile)
+  {
+    sources_ptr[tile] = decomp[tile].begin();
+  }
+
+  return compact(exec, first, decomp, sources_ptr, compact_op);
+}
+
+
+// removes consecutive duplicates in place, using an O(num_tiles) temporary
+// every tile is uniqued on its own; the first element of a tile is dropped
+// when it duplicates the last element of the preceding tile
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename BinaryPredicate,
+         typename Size>
+RandomAccessIterator parallel_unique(thrust::execution_policy<DerivedPolicy> &exec,
+                                     RandomAccessIterator first,
+                                     RandomAccessIterator last,
+                                     BinaryPredicate binary_pred,
+                                     Size max_tiles)
+{
+  using namespace parallel_compact_detail;
+
+  const Size n = last - first;
+
+  uniform_decomposition<Size> decomp(n, grain_size, max_tiles);
+
+  const Size num_tiles = decomp.size();
+
+  if(num_tiles <= 1)
+  {
+    thrust::detail::seq_t seq;
+    return thrust::system::detail::sequential::unique(seq, first, last, binary_pred);
+  }
+
+  thrust::detail::temporary_array<Size,DerivedPolicy> sources(exec, num_tiles);
+  Size *sources_ptr = thrust::raw_pointer_cast(&*sources.begin());
+
+  // the tile boundaries are inspected before any tile is compacted
+  for(Size tile = 0; tile < num_tiles; ++tile)
+  {
+    const Size begin = decomp[tile].begin();
+
+    sources_ptr[tile] = begin;
+
+    if(tile > 0 && binary_pred(thrust::raw_reference_cast(first[begin - 1]), thrust::raw_reference_cast(first[begin])))
+    {
+      ++sources_ptr[tile];
+    }
+  }
+
+  return compact(exec, first, decomp, sources_ptr, unique_op<BinaryPredicate>(binary_pred));
+}
+
+
+} // end namespace internal
+} // end namespace detail
+} // end namespace system
+THRUST_NAMESPACE_END
+
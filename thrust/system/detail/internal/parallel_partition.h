@@ -0,0 +1,312 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file parallel_partition.h
+ *  \brief In-place tiled unstable partition, shared by the multicore host
+ *         backends.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/system/detail/internal/decompose.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/detail/temporary_array.h>
+#include <thrust/detail/raw_pointer_cast.h>
+#include <thrust/binary_search.h>
+#include <thrust/partition.h>
+#include <thrust/swap.h>
+#include <thrust/for_each.h>
+#include <thrust/detail/seq.h>
+#include <thrust/detail/minmax.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace detail
+{
+namespace internal
+{
+namespace parallel_partition_detail
+{
+
+
+// tiles smaller than this are not worth a task of their own
+const static int grain_size = 4096;
+
+
+// sequential in-place partitions, applied to each tile
+template<typename Predicate>
+struct partition_op
+{
+  Predicate pred;
+
+  partition_op(Predicate pred)
+    : pred(pred)
+  {}
+
+  template<typename RandomAccessIterator, typename Size>
+  RandomAccessIterator operator()(RandomAccessIterator first, Size begin, Size end) const
+  {
+    return thrust::partition(thrust::seq, first + begin, first + end, pred);
+  }
+};
+
+
+template<typename InputIterator, typename Predicate>
+struct partition_stencil_op
+{
+  InputIterator stencil;
+  Predicate pred;
+
+  partition_stencil_op(InputIterator stencil, Predicate pred)
+    : stencil(stencil), pred(pred)
+  {}
+
+  template<typename RandomAccessIterator, typename Size>
+  RandomAccessIterator operator()(RandomAccessIterator first, Size begin, Size end) const
+  {
+    return thrust::partition(thrust::seq, first + begin, first + end, stencil + begin, pred);
+  }
+};
+
+
+// partitions one tile in place and records how many of its elements satisfy the predicate
+template<typename RandomAccessIterator, typename Size, typename PartitionOperation>
+struct partition_tile
+{
+  RandomAccessIterator first;
+  uniform_decomposition<Size> decomp;
+  Size *counts;
+  PartitionOperation partition_op;
+
+  partition_tile(RandomAccessIterator first,
+                 uniform_decomposition<Size> decomp,
+                 Size *counts,
+                 PartitionOperation partition_op)
+    : first(first), decomp(decomp), counts(counts), partition_op(partition_op)
+  {}
+
+  void operator()(Size tile) const
+  {
+    const Size begin = decomp[tile].begin();
+
+    counts[tile] = (partition_op(first, begin, decomp[tile].end()) - first) - begin;
+  }
+};
+
+
+// the misplaced elements on either side of the split point, as a list of
+// intervals whose lengths are scanned into offsets, so that the k-th
+// misplaced element of one side is exchanged with the k-th of the other
+template<typename Size>
+struct misplaced_intervals
+{
+  const Size *starts;
+  const Size *offsets;
+  Size size;
+
+  // the index of the interval holding the i-th misplaced element
+  Size find(Size i) const
+  {
+    return (thrust::upper_bound(thrust::seq, offsets, offsets + size + 1, i) - offsets) - 1;
+  }
+};
+
+
+// exchanges the misplaced elements [chunks[chunk].begin(), chunks[chunk].end())
+// of both sides
+template<typename RandomAccessIterator, typename Size>
+struct swap_chunk
+{
+  RandomAccessIterator first;
+  uniform_decomposition<Size> chunks;
+  misplaced_intervals<Size> falses;
+  misplaced_intervals<Size> trues;
+
+  swap_chunk(RandomAccessIterator first,
+             uniform_decomposition<Size> chunks,
+             misplaced_intervals<Size> falses,
+             misplaced_intervals<Size> trues)
+    : first(first), chunks(chunks), falses(falses), trues(trues)
+  {}
+
+  void operator()(Size chunk) const
+  {
+    Size begin = chunks[chunk].begin();
+    Size end   = chunks[chunk].end();
+
+    Size i = falses.find(begin);
+    Size j = trues.find(begin);
+
+    while(begin < end)
+    {
+      const Size length = thrust::min(end, thrust::min(falses.offsets[i + 1], trues.offsets[j + 1])) - begin;
+
+      RandomAccessIterator false_first = first + falses.starts[i] + (begin - falses.offsets[i]);
+      RandomAccessIterator true_first  = first + trues.starts[j]  + (begin - trues.offsets[j]);
+
+      thrust::swap_ranges(thrust::seq, false_first, false_first + length, true_first);
+
+      begin += length;
+
+      if(begin == falses.offsets[i + 1]) ++i;
+      if(begin == trues.offsets[j + 1])  ++j;
+    }
+  }
+};
+
+
+// partitions every tile in place in parallel and then exchanges, in
+// parallel, the elements left of the split point which fail the predicate
+// with the elements right of it which satisfy it
+template<typename DerivedPolicy, typename RandomAccessIterator, typename PartitionOperation, typename Size>
+RandomAccessIterator partition_tiles(thrust::execution_policy<DerivedPolicy> &exec,
+                                     RandomAccessIterator first,
+                                     RandomAccessIterator last,
+                                     PartitionOperation partition_op,
+                                     Size max_tiles)
+{
+  const Size n = last - first;
+
+  uniform_decomposition<Size> decomp(n, grain_size, max_tiles);
+
+  const Size num_tiles = decomp.size();
+
+  if(num_tiles <= 1)
+  {
+    return partition_op(first, Size(0), n);
+  }
+
+  thrust::detail::temporary_array<Size,DerivedPolicy> temp(exec, 5 * num_tiles + 2);
+
+  Size *counts        = thrust::raw_pointer_cast(&*temp.begin());
+  Size *false_starts  = counts        + num_tiles;
+  Size *false_offsets = false_starts  + num_tiles;
+  Size *true_starts   = false_offsets + num_tiles + 1;
+  Size *true_offsets  = true_starts   + num_tiles;
+
+  thrust::counting_iterator<Size> tiles_first(0);
+  thrust::counting_iterator<Size> tiles_last(num_tiles);
+
+  // partition each tile in place
+  thrust::for_each(exec, tiles_first, tiles_last,
+                   partition_tile<RandomAccessIterator,Size,PartitionOperation>(first, decomp, counts, partition_op));
+
+  Size split = 0;
+
+  for(Size tile = 0; tile < num_tiles; ++tile)
+  {
+    split += counts[tile];
+  }
+
+  // every tile holds at most one interval of misplaced elements on either side of split
+  misplaced_intervals<Size> falses = {false_starts, false_offsets, 0};
+  misplaced_intervals<Size> trues  = {true_starts,  true_offsets,  0};
+
+  false_offsets[0] = 0;
+  true_offsets[0]  = 0;
+
+  for(Size tile = 0; tile < num_tiles; ++tile)
+  {
+    const Size begin  = decomp[tile].begin();
+    const Size end    = decomp[tile].end();
+    const Size middle = begin + counts[tile];
+
+    const Size false_end  = thrust::min(end, split);
+    const Size true_begin = thrust::max(begin, split);
+
+    if(middle < false_end)
+    {
+      false_starts[falses.size]      = middle;
+      false_offsets[falses.size + 1] = false_offsets[falses.size] + (false_end - middle);
+      ++falses.size;
+    }
+
+    if(true_begin < middle)
+    {
+      true_starts[trues.size]      = true_begin;
+      true_offsets[trues.size + 1] = true_offsets[trues.size] + (middle - true_begin);
+      ++trues.size;
+    }
+  }
+
+  // both sides hold the same number of misplaced elements
+  const Size num_misplaced = false_offsets[falses.size];
+
+  if(num_misplaced > 0)
+  {
+    uniform_decomposition<Size> chunks(num_misplaced, grain_size, max_tiles);
+
+    thrust::for_each(exec, tiles_first, tiles_first + chunks.size(),
+                     swap_chunk<RandomAccessIterator,Size>(first, chunks, falses, trues));
+  }
+
+  return first + split;
+}
+
+
+} // end namespace parallel_partition_detail
+
+
+// reorders [first, last) in place so that the elements satisfying pred
+// precede those that do not, using an O(num_tiles) temporary
+// every tile is partitioned on its own in parallel; the misplaced blocks
+// left over on either side of the split point are then exchanged in parallel
+// the relative order of the elements is not preserved
+// the per-tile work is distributed with thrust::for_each on exec's system,
+// so this may also serve as the partition step of a parallel quicksort or
+// selection
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename Predicate,
+         typename Size>
+RandomAccessIterator parallel_partition(thrust::execution_policy<DerivedPolicy> &exec,
+                                        RandomAccessIterator first,
+                                        RandomAccessIterator last,
+                                        Predicate pred,
+                                        Size max_tiles)
+{
+  using namespace parallel_partition_detail;
+
+  return partition_tiles(exec, first, last, partition_op<Predicate>(pred), max_tiles);
+}
+
+
+// as above, the predicate is applied to the stencil element at each element's original position
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename InputIterator,
+         typename Predicate,
+         typename Size>
+RandomAccessIterator parallel_partition(thrust::execution_policy<DerivedPolicy> &exec,
+                                        RandomAccessIterator first,
+                                        RandomAccessIterator last,
+                                        InputIterator stencil,
+                                        Predicate pred,
+                                        Size max_tiles)
+{
+  using namespace parallel_partition_detail;
+
+  return partition_tiles(exec, first, last, partition_stencil_op<InputIterator,Predicate>(stencil, pred), max_tiles);
+}
+
+
+} // end namespace internal
+} // end namespace detail
+} // end namespace system
+THRUST_NAMESPACE_END
+
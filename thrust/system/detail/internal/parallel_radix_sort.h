@@ -0,0 +1,309 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file parallel_radix_sort.h
+ *  \brief Tiled LSD radix sort for primitive keys, shared by the
+ *         multicore host backends.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/system/detail/internal/decompose.h>
+#include <thrust/system/detail/sequential/stable_radix_sort.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/iterator_traits.h>
+#include <thrust/detail/temporary_array.h>
+#include <thrust/detail/raw_pointer_cast.h>
+#include <thrust/for_each.h>
+#include <thrust/copy.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace detail
+{
+namespace internal
+{
+namespace parallel_radix_sort_detail
+{
+
+
+const static unsigned int RadixBits = 8;
+const static size_t       NumBuckets = size_t(1) << RadixBits;
+
+
+// maps a key to its bucket for the pass starting at bit_shift
+// descending order is obtained by complementing each digit, which keeps the sort stable
+template<typename KeyType, bool Descending>
+struct digit_functor
+{
+  typedef thrust::system::detail::sequential::radix_sort_detail::RadixEncoder<KeyType> Encoder;
+  typedef typename Encoder::result_type EncodedType;
+
+  Encoder encode;
+  unsigned int bit_shift;
+
+  digit_functor(unsigned int bit_shift)
+    : encode(), bit_shift(bit_shift)
+  {}
+
+  size_t operator()(KeyType key) const
+  {
+    const EncodedType x = encode(key);
+
+    const size_t digit = static_cast<size_t>((x >> bit_shift) & static_cast<EncodedType>(NumBuckets - 1));
+
+    return Descending ? (NumBuckets - 1) - digit : digit;
+  }
+};
+
+
+// computes the histogram of one tile for the current pass
+template<typename RandomAccessIterator, typename Digit, typename IndexType>
+struct count_tile
+{
+  RandomAccessIterator keys;
+  Digit digit;
+  uniform_decomposition<IndexType> decomp;
+  size_t *histograms;
+
+  count_tile(RandomAccessIterator keys, Digit digit, uniform_decomposition<IndexType> decomp, size_t *histograms)
+    : keys(keys), digit(digit), decomp(decomp), histograms(histograms)
+  {}
+
+  void operator()(IndexType tile) const
+  {
+    size_t *histogram = histograms + tile * NumBuckets;
+
+    for(size_t i = 0; i < NumBuckets; ++i)
+      histogram[i] = 0;
+
+    for(IndexType i = decomp[tile].begin(); i < decomp[tile].end(); ++i)
+      ++histogram[digit(keys[i])];
+  }
+};
+
+
+// scatters one tile to the positions reserved for it by the offset scan
+template<bool HasValues,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename RandomAccessIterator3,
+         typename RandomAccessIterator4,
+         typename Digit,
+         typename IndexType>
+struct scatter_tile
+{
+  RandomAccessIterator1 keys_src;
+  RandomAccessIterator2 values_src;
+  RandomAccessIterator3 keys_dst;
+  RandomAccessIterator4 values_dst;
+  Digit digit;
+  uniform_decomposition<IndexType> decomp;
+  size_t *offsets;
+
+  scatter_tile(RandomAccessIterator1 keys_src,
+               RandomAccessIterator2 values_src,
+               RandomAccessIterator3 keys_dst,
+               RandomAccessIterator4 values_dst,
+               Digit digit,
+               uniform_decomposition<IndexType> decomp,
+               size_t *offsets)
+    : keys_src(keys_src), values_src(values_src),
+      keys_dst(keys_dst), values_dst(values_dst),
+      digit(digit), decomp(decomp), offsets(offsets)
+  {}
+
+  void operator()(IndexType tile) const
+  {
+    size_t *offset = offsets + tile * NumBuckets;
+
+    for(IndexType i = decomp[tile].begin(); i < decomp[tile].end(); ++i)
+    {
+      const size_t position = offset[digit(keys_src[i])]++;
+
+      keys_dst[position] = keys_src[i];
+
+      if(HasValues)
+      {
+        values_dst[position] = values_src[i];
+      }
+    }
+  }
+};
+
+
+// turns per-tile histograms into per-tile starting offsets, bucket-major
+// returns false when every key falls into a single bucket and the pass can be skipped
+inline bool scan_histograms(size_t *histograms, size_t num_tiles, size_t n)
+{
+  size_t sum = 0;
+
+  for(size_t bucket = 0; bucket < NumBuckets; ++bucket)
+  {
+    const size_t bucket_begin = sum;
+
+    for(size_t tile = 0; tile < num_tiles; ++tile)
+    {
+      size_t count = histograms[tile * NumBuckets + bucket];
+      histograms[tile * NumBuckets + bucket] = sum;
+      sum += count;
+    }
+
+    if(sum - bucket_begin == n)
+      return false;
+  }
+
+  return true;
+}
+
+
+template<bool Descending,
+         bool HasValues,
+         typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename RandomAccessIterator3,
+         typename RandomAccessIterator4,
+         typename IndexType>
+void radix_sort(thrust::execution_policy<DerivedPolicy> &exec,
+                RandomAccessIterator1 keys1,
+                RandomAccessIterator2 keys2,
+                RandomAccessIterator3 values1,
+                RandomAccessIterator4 values2,
+                IndexType n,
+                IndexType num_tiles)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator1>::type KeyType;
+  typedef digit_functor<KeyType,Descending> Digit;
+  typedef typename Digit::EncodedType EncodedType;
+
+  const unsigned int NumPasses = (8 * sizeof(EncodedType) + (RadixBits - 1)) / RadixBits;
+
+  uniform_decomposition<IndexType> decomp(n, 1, num_tiles);
+  num_tiles = decomp.size();
+
+  thrust::detail::temporary_array<size_t,DerivedPolicy> histograms(exec, num_tiles * NumBuckets);
+  size_t *histograms_ptr = thrust::raw_pointer_cast(&*histograms.begin());
+
+  thrust::counting_iterator<IndexType> tiles_first(0);
+  thrust::counting_iterator<IndexType> tiles_last(num_tiles);
+
+  // false if most recent data is stored in (keys1,values1)
+  bool flip = false;
+
+  for(unsigned int pass = 0; pass < NumPasses; ++pass)
+  {
+    Digit digit(pass * RadixBits);
+
+    if(flip)
+    {
+      thrust::for_each(exec, tiles_first, tiles_last,
+                       count_tile<RandomAccessIterator2,Digit,IndexType>(keys2, digit, decomp, histograms_ptr));
+    }
+    else
+    {
+      thrust::for_each(exec, tiles_first, tiles_last,
+                       count_tile<RandomAccessIterator1,Digit,IndexType>(keys1, digit, decomp, histograms_ptr));
+    }
+
+    if(!scan_histograms(histograms_ptr, static_cast<size_t>(num_tiles), static_cast<size_t>(n)))
+      continue;
+
+    if(flip)
+    {
+      thrust::for_each(exec, tiles_first, tiles_last,
+                       scatter_tile<HasValues,RandomAccessIterator2,RandomAccessIterator4,RandomAccessIterator1,RandomAccessIterator3,Digit,IndexType>
+                         (keys2, values2, keys1, values1, digit, decomp, histograms_ptr));
+    }
+    else
+    {
+      thrust::for_each(exec, tiles_first, tiles_last,
+                       scatter_tile<HasValues,RandomAccessIterator1,RandomAccessIterator3,RandomAccessIterator2,RandomAccessIterator4,Digit,IndexType>
+                         (keys1, values1, keys2, values2, digit, decomp, histograms_ptr));
+    }
+
+    flip = !flip;
+  }
+
+  // ensure final values are in (keys1,values1)
+  if(flip)
+  {
+    thrust::copy(exec, keys2, keys2 + n, keys1);
+
+    if(HasValues)
+    {
+      thrust::copy(exec, values2, values2 + n, values1);
+    }
+  }
+}
+
+
+} // end namespace parallel_radix_sort_detail
+
+
+// stably sorts [first, last) of a primitive key type in num_tiles independent tiles
+// per pass: every tile builds its own histogram, the histograms are scanned into
+// per-tile offsets and every tile then scatters its keys in parallel
+// the per-tile work is distributed with thrust::for_each on exec's system
+template<bool Descending,
+         typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename IndexType>
+void parallel_radix_sort(thrust::execution_policy<DerivedPolicy> &exec,
+                         RandomAccessIterator first,
+                         RandomAccessIterator last,
+                         IndexType num_tiles)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type KeyType;
+
+  IndexType n = last - first;
+
+  thrust::detail::temporary_array<KeyType,DerivedPolicy> temp(exec, n);
+
+  parallel_radix_sort_detail::radix_sort<Descending,false>(exec, first, temp.begin(), static_cast<int *>(0), static_cast<int *>(0), n, num_tiles);
+}
+
+
+template<bool Descending,
+         typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename IndexType>
+void parallel_radix_sort_by_key(thrust::execution_policy<DerivedPolicy> &exec,
+                                RandomAccessIterator1 keys_first,
+                                RandomAccessIterator1 keys_last,
+                                RandomAccessIterator2 values_first,
+                                IndexType num_tiles)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator1>::type KeyType;
+  typedef typename thrust::iterator_value<RandomAccessIterator2>::type ValueType;
+
+  IndexType n = keys_last - keys_first;
+
+  thrust::detail::temporary_array<KeyType,DerivedPolicy>   temp1(exec, n);
+  thrust::detail::temporary_array<ValueType,DerivedPolicy> temp2(exec, n);
+
+  parallel_radix_sort_detail::radix_sort<Descending,true>(exec, keys_first, temp1.begin(), values_first, temp2.begin(), n, num_tiles);
+}
+
+
+} // end namespace internal
+} // end namespace detail
+} // end namespace system
+THRUST_NAMESPACE_END
+
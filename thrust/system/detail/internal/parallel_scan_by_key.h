@@ -0,0 +1,359 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file parallel_scan_by_key.h
+ *  \brief Tiled segmented scans, shared by the multicore host backends.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/system/detail/internal/decompose.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/iterator_traits.h>
+#include <thrust/detail/temporary_array.h>
+#include <thrust/detail/raw_pointer_cast.h>
+#include <thrust/detail/function.h>
+#include <thrust/detail/cstdint.h>
+#include <thrust/scan.h>
+#include <thrust/for_each.h>
+#include <thrust/detail/seq.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace detail
+{
+namespace internal
+{
+namespace parallel_scan_by_key_detail
+{
+
+
+// tiles smaller than this are not worth a task of their own
+const static int grain_size = 4096;
+
+
+// per-tile head flags
+// head_first: the tile's first element starts a new segment
+// head_any:   some element of the tile starts a new segment
+typedef thrust::detail::uint8_t HeadFlagType;
+
+const static HeadFlagType head_first = 1;
+const static HeadFlagType head_any   = 2;
+
+
+// pass 1: computes the (flags, value) partial of every tile
+// the partial value is the reduction of the tile's last (possibly incomplete) segment;
+// for the exclusive scan a segment that starts inside the tile is seeded with init
+template<bool Exclusive,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename ValueType,
+         typename BinaryPredicate,
+         typename BinaryFunction,
+         typename Size>
+struct reduce_tile
+{
+  RandomAccessIterator1 keys;
+  RandomAccessIterator2 values;
+  ValueType init;
+  BinaryPredicate binary_pred;
+  thrust::detail::wrapped_function<BinaryFunction,ValueType> binary_op;
+  uniform_decomposition<Size> decomp;
+  ValueType *partials;
+  HeadFlagType *flags;
+
+  reduce_tile(RandomAccessIterator1 keys,
+              RandomAccessIterator2 values,
+              ValueType init,
+              BinaryPredicate binary_pred,
+              BinaryFunction binary_op,
+              uniform_decomposition<Size> decomp,
+              ValueType *partials,
+              HeadFlagType *flags)
+    : keys(keys), values(values), init(init),
+      binary_pred(binary_pred), binary_op(binary_op),
+      decomp(decomp), partials(partials), flags(flags)
+  {}
+
+  void operator()(Size tile) const
+  {
+    typedef typename thrust::iterator_value<RandomAccessIterator1>::type KeyType;
+
+    const Size begin = decomp[tile].begin();
+    const Size end   = decomp[tile].end();
+
+    // the boundary with the previous tile is read here, before any tile writes
+    // its output, so that the scan may be performed in place
+    HeadFlagType flag = (begin == 0 || !binary_pred(keys[begin - 1], keys[begin])) ? (head_first | head_any) : 0;
+
+    KeyType   prev_key = keys[begin];
+    ValueType sum      = (Exclusive && (flag & head_first)) ? binary_op(init, values[begin]) : ValueType(values[begin]);
+
+    for(Size i = begin + 1; i < end; ++i)
+    {
+      KeyType key = keys[i];
+
+      if(binary_pred(prev_key, key))
+      {
+        sum = binary_op(sum, values[i]);
+      }
+      else
+      {
+        sum   = Exclusive ? binary_op(init, values[i]) : ValueType(values[i]);
+        flag |= head_any;
+      }
+
+      prev_key = key;
+    }
+
+    partials[tile] = sum;
+    flags[tile]    = flag;
+  }
+};
+
+
+// pass 3: scans every tile, carrying the scanned partial of its predecessors
+// into the tile's first segment
+template<bool Exclusive,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename OutputIterator,
+         typename ValueType,
+         typename BinaryPredicate,
+         typename BinaryFunction,
+         typename Size>
+struct scan_tile
+{
+  RandomAccessIterator1 keys;
+  RandomAccessIterator2 values;
+  OutputIterator result;
+  ValueType init;
+  BinaryPredicate binary_pred;
+  thrust::detail::wrapped_function<BinaryFunction,ValueType> binary_op;
+  uniform_decomposition<Size> decomp;
+  const ValueType *carries;
+  const HeadFlagType *flags;
+
+  scan_tile(RandomAccessIterator1 keys,
+            RandomAccessIterator2 values,
+            OutputIterator result,
+            ValueType init,
+            BinaryPredicate binary_pred,
+            BinaryFunction binary_op,
+            uniform_decomposition<Size> decomp,
+            const ValueType *carries,
+            const HeadFlagType *flags)
+    : keys(keys), values(values), result(result), init(init),
+      binary_pred(binary_pred), binary_op(binary_op),
+      decomp(decomp), carries(carries), flags(flags)
+  {}
+
+  void operator()(Size tile) const
+  {
+    typedef typename thrust::iterator_value<RandomAccessIterator1>::type KeyType;
+
+    const Size begin = decomp[tile].begin();
+    const Size end   = decomp[tile].end();
+
+    const bool is_head = (flags[tile] & head_first) != 0;
+
+    KeyType prev_key = keys[begin];
+
+    if(Exclusive)
+    {
+      // carries[tile - 1] is the running sum in front of the tile's first element
+      ValueType next = is_head ? init : carries[tile - 1];
+
+      ValueType value = values[begin];
+      result[begin] = next;
+      next = binary_op(next, value);
+
+      for(Size i = begin + 1; i < end; ++i)
+      {
+        KeyType key = keys[i];
+
+        // use temp to permit in-place scans
+        value = values[i];
+
+        if(!binary_pred(prev_key, key))
+          next = init;
+
+        result[i] = next;
+        next = binary_op(next, value);
+
+        prev_key = key;
+      }
+    }
+    else
+    {
+      ValueType sum = is_head ? ValueType(values[begin]) : binary_op(carries[tile - 1], values[begin]);
+
+      result[begin] = sum;
+
+      for(Size i = begin + 1; i < end; ++i)
+      {
+        KeyType key = keys[i];
+
+        if(binary_pred(prev_key, key))
+          result[i] = sum = binary_op(sum, values[i]);
+        else
+          result[i] = sum = values[i];
+
+        prev_key = key;
+      }
+    }
+  }
+};
+
+
+template<bool Exclusive,
+         typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename OutputIterator,
+         typename ValueType,
+         typename BinaryPredicate,
+         typename BinaryFunction,
+         typename Size>
+void scan_by_key(thrust::execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator1 keys,
+                 RandomAccessIterator2 values,
+                 OutputIterator result,
+                 ValueType init,
+                 BinaryPredicate binary_pred,
+                 BinaryFunction binary_op,
+                 uniform_decomposition<Size> decomp)
+{
+  const Size num_tiles = decomp.size();
+
+  thrust::detail::temporary_array<ValueType,DerivedPolicy>    partials(exec, num_tiles);
+  thrust::detail::temporary_array<HeadFlagType,DerivedPolicy> flags(exec, num_tiles);
+
+  ValueType    *partials_ptr = thrust::raw_pointer_cast(&*partials.begin());
+  HeadFlagType *flags_ptr    = thrust::raw_pointer_cast(&*flags.begin());
+
+  thrust::counting_iterator<Size> tiles_first(0);
+  thrust::counting_iterator<Size> tiles_last(num_tiles);
+
+  // reduce each tile to a (flags, value) partial
+  thrust::for_each(exec, tiles_first, tiles_last,
+                   reduce_tile<Exclusive,RandomAccessIterator1,RandomAccessIterator2,ValueType,BinaryPredicate,BinaryFunction,Size>
+                     (keys, values, init, binary_pred, binary_op, decomp, partials_ptr, flags_ptr));
+
+  // scan the partials, restarting at every tile containing a head
+  // afterwards partials[t] holds the carry into tile t + 1
+  thrust::detail::wrapped_function<BinaryFunction,ValueType> wrapped_binary_op(binary_op);
+
+  for(Size tile = 1; tile < num_tiles; ++tile)
+  {
+    if(!(flags_ptr[tile] & head_any))
+    {
+      partials_ptr[tile] = wrapped_binary_op(partials_ptr[tile - 1], partials_ptr[tile]);
+    }
+  }
+
+  // rescan each tile with its carry
+  thrust::for_each(exec, tiles_first, tiles_last,
+                   scan_tile<Exclusive,RandomAccessIterator1,RandomAccessIterator2,OutputIterator,ValueType,BinaryPredicate,BinaryFunction,Size>
+                     (keys, values, result, init, binary_pred, binary_op, decomp, partials_ptr, flags_ptr));
+}
+
+
+} // end namespace parallel_scan_by_key_detail
+
+
+// segmented inclusive scan over up to max_tiles tiles
+// every tile is reduced to a (flags, value) partial carrying the sum of its
+// last segment and whether it contains a segment head, the partials are
+// scanned sequentially and every tile is then rescanned with its carry
+// heads follow thrust/detail/range/head_flags.h: element i starts a segment
+// when i == 0 or !binary_pred(keys[i - 1], keys[i])
+// the per-tile work is distributed with thrust::for_each on exec's system
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename OutputIterator,
+         typename BinaryPredicate,
+         typename BinaryFunction,
+         typename Size>
+OutputIterator parallel_inclusive_scan_by_key(thrust::execution_policy<DerivedPolicy> &exec,
+                                              RandomAccessIterator1 first1,
+                                              RandomAccessIterator1 last1,
+                                              RandomAccessIterator2 first2,
+                                              OutputIterator result,
+                                              BinaryPredicate binary_pred,
+                                              BinaryFunction binary_op,
+                                              Size max_tiles)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator2>::type ValueType;
+
+  const Size n = last1 - first1;
+
+  uniform_decomposition<Size> decomp(n, parallel_scan_by_key_detail::grain_size, max_tiles);
+
+  if(decomp.size() <= 1)
+  {
+    return thrust::inclusive_scan_by_key(thrust::seq, first1, last1, first2, result, binary_pred, binary_op);
+  }
+
+  // the inclusive scan has no init, the first value of the input stands in
+  parallel_scan_by_key_detail::scan_by_key<false>(exec, first1, first2, result, ValueType(*first2), binary_pred, binary_op, decomp);
+
+  return result + n;
+}
+
+
+// segmented exclusive scan over up to max_tiles tiles, every segment is seeded with init
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename OutputIterator,
+         typename T,
+         typename BinaryPredicate,
+         typename BinaryFunction,
+         typename Size>
+OutputIterator parallel_exclusive_scan_by_key(thrust::execution_policy<DerivedPolicy> &exec,
+                                              RandomAccessIterator1 first1,
+                                              RandomAccessIterator1 last1,
+                                              RandomAccessIterator2 first2,
+                                              OutputIterator result,
+                                              T init,
+                                              BinaryPredicate binary_pred,
+                                              BinaryFunction binary_op,
+                                              Size max_tiles)
+{
+  const Size n = last1 - first1;
+
+  uniform_decomposition<Size> decomp(n, parallel_scan_by_key_detail::grain_size, max_tiles);
+
+  if(decomp.size() <= 1)
+  {
+    return thrust::exclusive_scan_by_key(thrust::seq, first1, last1, first2, result, init, binary_pred, binary_op);
+  }
+
+  parallel_scan_by_key_detail::scan_by_key<true>(exec, first1, first2, result, init, binary_pred, binary_op, decomp);
+
+  return result + n;
+}
+
+
+} // end namespace internal
+} // end namespace detail
+} // end namespace system
+THRUST_NAMESPACE_END
+
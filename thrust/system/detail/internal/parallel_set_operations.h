@@ -0,0 +1,288 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file parallel_set_operations.h
+ *  \brief Partitioned set operations, shared by the multicore host backends.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/system/detail/internal/decompose.h>
+#include <thrust/system/detail/internal/merge_path.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/detail/temporary_array.h>
+#include <thrust/detail/raw_pointer_cast.h>
+#include <thrust/detail/raw_reference_cast.h>
+#include <thrust/binary_search.h>
+#include <thrust/set_operations.h>
+#include <thrust/for_each.h>
+#include <thrust/detail/seq.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace detail
+{
+namespace internal
+{
+
+
+// sequential set operations, applied to each partition
+struct set_difference_op
+{
+  template<typename InputIterator1, typename InputIterator2, typename OutputIterator, typename StrictWeakOrdering>
+  OutputIterator operator()(InputIterator1 first1, InputIterator1 last1,
+                            InputIterator2 first2, InputIterator2 last2,
+                            OutputIterator result, StrictWeakOrdering comp) const
+  {
+    return thrust::set_difference(thrust::seq, first1, last1, first2, last2, result, comp);
+  }
+};
+
+
+struct set_intersection_op
+{
+  template<typename InputIterator1, typename InputIterator2, typename OutputIterator, typename StrictWeakOrdering>
+  OutputIterator operator()(InputIterator1 first1, InputIterator1 last1,
+                            InputIterator2 first2, InputIterator2 last2,
+                            OutputIterator result, StrictWeakOrdering comp) const
+  {
+    return thrust::set_intersection(thrust::seq, first1, last1, first2, last2, result, comp);
+  }
+};
+
+
+struct set_symmetric_difference_op
+{
+  template<typename InputIterator1, typename InputIterator2, typename OutputIterator, typename StrictWeakOrdering>
+  OutputIterator operator()(InputIterator1 first1, InputIterator1 last1,
+                            InputIterator2 first2, InputIterator2 last2,
+                            OutputIterator result, StrictWeakOrdering comp) const
+  {
+    return thrust::set_symmetric_difference(thrust::seq, first1, last1, first2, last2, result, comp);
+  }
+};
+
+
+struct set_union_op
+{
+  template<typename InputIterator1, typename InputIterator2, typename OutputIterator, typename StrictWeakOrdering>
+  OutputIterator operator()(InputIterator1 first1, InputIterator1 last1,
+                            InputIterator2 first2, InputIterator2 last2,
+                            OutputIterator result, StrictWeakOrdering comp) const
+  {
+    return thrust::set_union(thrust::seq, first1, last1, first2, last2, result, comp);
+  }
+};
+
+
+namespace parallel_set_operations_detail
+{
+
+
+// partitions smaller than this are not worth a task of their own
+const static int grain_size = 4096;
+
+
+// finds the start of partition i in both inputs
+// the merge path position of the partition's first output is moved back to
+// the first element equivalent to the element found there, so that every
+// equivalence class falls into a single partition and duplicates are paired
+// exactly as the sequential algorithm pairs them
+template<typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename Size,
+         typename StrictWeakOrdering>
+void find_partition(RandomAccessIterator1 first1, Size n1,
+                    RandomAccessIterator2 first2, Size n2,
+                    Size diagonal,
+                    StrictWeakOrdering comp,
+                    Size &split1,
+                    Size &split2)
+{
+  Size i = merge_path(first1, n1, first2, n2, diagonal, comp);
+  Size j = diagonal - i;
+
+  if(j >= n2 || (i < n1 && !comp(thrust::raw_reference_cast(first2[j]), thrust::raw_reference_cast(first1[i]))))
+  {
+    split1 = thrust::lower_bound(thrust::seq, first1, first1 + i, thrust::raw_reference_cast(first1[i]), comp) - first1;
+    split2 = thrust::lower_bound(thrust::seq, first2, first2 + j, thrust::raw_reference_cast(first1[i]), comp) - first2;
+  }
+  else
+  {
+    split1 = thrust::lower_bound(thrust::seq, first1, first1 + i, thrust::raw_reference_cast(first2[j]), comp) - first1;
+    split2 = thrust::lower_bound(thrust::seq, first2, first2 + j, thrust::raw_reference_cast(first2[j]), comp) - first2;
+  }
+}
+
+
+template<typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename OutputIterator,
+         typename Size,
+         typename StrictWeakOrdering,
+         typename SetOperation>
+struct partition_functor
+{
+  RandomAccessIterator1 first1;
+  RandomAccessIterator2 first2;
+  OutputIterator result;
+  const Size *splits1;
+  const Size *splits2;
+  Size *offsets;
+  StrictWeakOrdering comp;
+  SetOperation set_op;
+
+  partition_functor(RandomAccessIterator1 first1,
+                    RandomAccessIterator2 first2,
+                    OutputIterator result,
+                    const Size *splits1,
+                    const Size *splits2,
+                    Size *offsets,
+                    StrictWeakOrdering comp,
+                    SetOperation set_op)
+    : first1(first1), first2(first2), result(result),
+      splits1(splits1), splits2(splits2), offsets(offsets),
+      comp(comp), set_op(set_op)
+  {}
+
+  // counts the output of partition i
+  void operator()(Size i, thrust::detail::false_type) const
+  {
+    thrust::discard_iterator<> counter;
+
+    offsets[i] = set_op(first1 + splits1[i], first1 + splits1[i + 1],
+                        first2 + splits2[i], first2 + splits2[i + 1],
+                        counter,
+                        comp) - counter;
+  }
+
+  // writes the output of partition i at its scanned offset
+  void operator()(Size i, thrust::detail::true_type) const
+  {
+    set_op(first1 + splits1[i], first1 + splits1[i + 1],
+           first2 + splits2[i], first2 + splits2[i + 1],
+           result + offsets[i],
+           comp);
+  }
+};
+
+
+template<typename Functor, bool Write>
+struct partition_pass
+{
+  Functor f;
+
+  partition_pass(Functor f)
+    : f(f)
+  {}
+
+  template<typename Size>
+  void operator()(Size i) const
+  {
+    f(i, thrust::detail::integral_constant<bool,Write>());
+  }
+};
+
+
+} // end namespace parallel_set_operations_detail
+
+
+// splits both inputs at up to max_partitions balanced positions, counts
+// the output of every partition in parallel, scans the counts and then
+// writes every partition in parallel at its offset
+// the per-partition work is distributed with thrust::for_each on exec's system
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename OutputIterator,
+         typename StrictWeakOrdering,
+         typename SetOperation,
+         typename Size>
+OutputIterator parallel_set_operation(thrust::execution_policy<DerivedPolicy> &exec,
+                                      RandomAccessIterator1 first1,
+                                      RandomAccessIterator1 last1,
+                                      RandomAccessIterator2 first2,
+                                      RandomAccessIterator2 last2,
+                                      OutputIterator result,
+                                      StrictWeakOrdering comp,
+                                      SetOperation set_op,
+                                      Size max_partitions)
+{
+  using namespace parallel_set_operations_detail;
+
+  const Size n1 = last1 - first1;
+  const Size n2 = last2 - first2;
+
+  uniform_decomposition<Size> decomp(n1 + n2, grain_size, max_partitions);
+
+  const Size num_partitions = decomp.size();
+
+  if(num_partitions <= 1)
+  {
+    return set_op(first1, last1, first2, last2, result, comp);
+  }
+
+  thrust::detail::temporary_array<Size,DerivedPolicy> splits(exec, 2 * (num_partitions + 1));
+  thrust::detail::temporary_array<Size,DerivedPolicy> offsets(exec, num_partitions + 1);
+
+  Size *splits1     = thrust::raw_pointer_cast(&*splits.begin());
+  Size *splits2     = splits1 + (num_partitions + 1);
+  Size *offsets_ptr = thrust::raw_pointer_cast(&*offsets.begin());
+
+  splits1[0] = 0;
+  splits2[0] = 0;
+  splits1[num_partitions] = n1;
+  splits2[num_partitions] = n2;
+
+  for(Size i = 1; i < num_partitions; ++i)
+  {
+    find_partition(first1, n1, first2, n2, decomp[i].begin(), comp, splits1[i], splits2[i]);
+  }
+
+  typedef partition_functor<RandomAccessIterator1,RandomAccessIterator2,OutputIterator,Size,StrictWeakOrdering,SetOperation> Functor;
+
+  Functor f(first1, first2, result, splits1, splits2, offsets_ptr, comp, set_op);
+
+  thrust::counting_iterator<Size> partitions_first(0);
+  thrust::counting_iterator<Size> partitions_last(num_partitions);
+
+  // count the output of each partition
+  thrust::for_each(exec, partitions_first, partitions_last, partition_pass<Functor,false>(f));
+
+  // scan the counts into output offsets
+  Size sum = 0;
+  for(Size i = 0; i <= num_partitions; ++i)
+  {
+    Size count = (i < num_partitions) ? offsets_ptr[i] : Size(0);
+    offsets_ptr[i] = sum;
+    sum += count;
+  }
+
+  // write the output of each partition
+  thrust::for_each(exec, partitions_first, partitions_last, partition_pass<Functor,true>(f));
+
+  return result + offsets_ptr[num_partitions];
+}
+
+
+} // end namespace internal
+} // end namespace detail
+} // end namespace system
+THRUST_NAMESPACE_END
+
@@ -0,0 +1,418 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file parallel_stable_partition.h
+ *  \brief Tiled stable_partition and stable_partition_copy, shared by the
+ *         multicore host backends.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/system/detail/internal/decompose.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/detail/temporary_array.h>
+#include <thrust/detail/raw_pointer_cast.h>
+#include <thrust/detail/function.h>
+#include <thrust/detail/cstdint.h>
+#include <thrust/partition.h>
+#include <thrust/reverse.h>
+#include <thrust/for_each.h>
+#include <thrust/pair.h>
+#include <thrust/detail/seq.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace detail
+{
+namespace internal
+{
+namespace parallel_stable_partition_detail
+{
+
+
+// tiles smaller than this are not worth a task of their own
+const static int grain_size = 4096;
+
+
+// the predicate results of a tile are kept as one bit per element between
+// the counting and the writing pass of stable_partition_copy
+typedef thrust::detail::uint64_t MaskType;
+
+const static int mask_bits = 64;
+
+
+// rotates [first, last) so that middle becomes its first element
+template<typename DerivedPolicy, typename RandomAccessIterator>
+void rotate(const thrust::detail::execution_policy_base<DerivedPolicy> &exec,
+            RandomAccessIterator first,
+            RandomAccessIterator middle,
+            RandomAccessIterator last)
+{
+  if(first == middle || middle == last)
+    return;
+
+  thrust::reverse(exec, first, middle);
+  thrust::reverse(exec, middle, last);
+  thrust::reverse(exec, first, last);
+}
+
+
+// stably partitions [begin, end) without a buffer: both halves are
+// partitioned and the false part of the left half is rotated past the true
+// part of the right half
+// every element is tested by its leaf before anything in its half moves, so
+// stencil[i] still belongs to the element at i, also when stencil is first itself
+template<typename RandomAccessIterator, typename InputIterator, typename Predicate, typename Size>
+Size stable_partition_range(RandomAccessIterator first,
+                            InputIterator stencil,
+                            thrust::detail::wrapped_function<Predicate,bool> &pred,
+                            Size begin,
+                            Size end)
+{
+  if(end - begin <= 1)
+  {
+    return (begin < end && pred(stencil[begin])) ? end : begin;
+  }
+
+  const Size middle = begin + (end - begin) / 2;
+
+  const Size true_end1 = stable_partition_range(first, stencil, pred, begin, middle);
+  const Size true_end2 = stable_partition_range(first, stencil, pred, middle, end);
+
+  parallel_stable_partition_detail::rotate(thrust::seq, first + true_end1, first + middle, first + true_end2);
+
+  return true_end1 + (true_end2 - middle);
+}
+
+
+// stably partitions one tile in place and records the size of its true part
+template<typename RandomAccessIterator, typename InputIterator, typename Predicate, typename Size>
+struct stable_partition_tile
+{
+  RandomAccessIterator first;
+  InputIterator stencil;
+  Predicate pred;
+  uniform_decomposition<Size> decomp;
+  Size *counts;
+
+  stable_partition_tile(RandomAccessIterator first,
+                        InputIterator stencil,
+                        Predicate pred,
+                        uniform_decomposition<Size> decomp,
+                        Size *counts)
+    : first(first), stencil(stencil), pred(pred), decomp(decomp), counts(counts)
+  {}
+
+  void operator()(Size tile) const
+  {
+    thrust::detail::wrapped_function<Predicate,bool> wrapped_pred(pred);
+
+    const Size begin = decomp[tile].begin();
+
+    counts[tile] = stable_partition_range(first, stencil, wrapped_pred, begin, decomp[tile].end()) - begin;
+  }
+};
+
+
+// evaluates the predicate of every element of one tile, records the results
+// in the tile's mask words and counts the tile's true elements
+template<typename InputIterator, typename Predicate, typename Size>
+struct count_tile
+{
+  InputIterator stencil;
+  thrust::detail::wrapped_function<Predicate,bool> pred;
+  uniform_decomposition<Size> decomp;
+  MaskType *mask;
+  const Size *mask_offsets;
+  Size *counts;
+
+  count_tile(InputIterator stencil,
+             Predicate pred,
+             uniform_decomposition<Size> decomp,
+             MaskType *mask,
+             const Size *mask_offsets,
+             Size *counts)
+    : stencil(stencil), pred(pred), decomp(decomp), mask(mask), mask_offsets(mask_offsets), counts(counts)
+  {}
+
+  void operator()(Size tile) const
+  {
+    InputIterator s         = stencil + decomp[tile].begin();
+    MaskType     *tile_mask = mask + mask_offsets[tile];
+
+    const Size size = decomp[tile].size();
+
+    Size     count = 0;
+    MaskType bits  = 0;
+
+    for(Size i = 0; i < size; ++i, ++s)
+    {
+      if(pred(*s))
+      {
+        bits |= MaskType(1) << (i % mask_bits);
+        ++count;
+      }
+
+      if(i % mask_bits == mask_bits - 1 || i == size - 1)
+      {
+        tile_mask[i / mask_bits] = bits;
+        bits = 0;
+      }
+    }
+
+    counts[tile] = count;
+  }
+};
+
+
+// writes the elements of one tile to both outputs, as recorded in its mask words
+// the false part of a tile starts where its true part would in a partition in place
+template<typename InputIterator, typename OutputIterator1, typename OutputIterator2, typename Size>
+struct write_tile
+{
+  InputIterator first;
+  OutputIterator1 out_true;
+  OutputIterator2 out_false;
+  uniform_decomposition<Size> decomp;
+  const MaskType *mask;
+  const Size *mask_offsets;
+  const Size *offsets;
+
+  write_tile(InputIterator first,
+             OutputIterator1 out_true,
+             OutputIterator2 out_false,
+             uniform_decomposition<Size> decomp,
+             const MaskType *mask,
+             const Size *mask_offsets,
+             const Size *offsets)
+    : first(first), out_true(out_true), out_false(out_false),
+      decomp(decomp), mask(mask), mask_offsets(mask_offsets), offsets(offsets)
+  {}
+
+  void operator()(Size tile) const
+  {
+    const Size begin = decomp[tile].begin();
+    const Size size  = decomp[tile].size();
+
+    InputIterator   src       = first + begin;
+    OutputIterator1 dst_true  = out_true  + offsets[tile];
+    OutputIterator2 dst_false = out_false + (begin - offsets[tile]);
+
+    const MaskType *tile_mask = mask + mask_offsets[tile];
+
+    for(Size i = 0; i < size; ++i, ++src)
+    {
+      if((tile_mask[i / mask_bits] >> (i % mask_bits)) & 1)
+      {
+        *dst_true = *src;
+        ++dst_true;
+      }
+      else
+      {
+        *dst_false = *src;
+        ++dst_false;
+      }
+    }
+  }
+};
+
+
+// stably partitions every tile in place in parallel by recursive rotations,
+// then merges adjacent runs of tiles pairwise by rotating the false part of
+// the left run past the true part of the right run; each rotation is
+// performed in parallel on exec's system
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename InputIterator,
+         typename Predicate,
+         typename Size>
+RandomAccessIterator stable_partition_tiles(thrust::execution_policy<DerivedPolicy> &exec,
+                                            RandomAccessIterator first,
+                                            InputIterator stencil,
+                                            Predicate pred,
+                                            uniform_decomposition<Size> decomp)
+{
+  const Size num_tiles = decomp.size();
+
+  thrust::detail::temporary_array<Size,DerivedPolicy> counts(exec, num_tiles);
+  Size *counts_ptr = thrust::raw_pointer_cast(&*counts.begin());
+
+  thrust::counting_iterator<Size> tiles_first(0);
+  thrust::counting_iterator<Size> tiles_last(num_tiles);
+
+  // partition each tile in place
+  thrust::for_each(exec, tiles_first, tiles_last,
+                   stable_partition_tile<RandomAccessIterator,InputIterator,Predicate,Size>(first, stencil, pred, decomp, counts_ptr));
+
+  // merge runs of tiles pairwise, counts[a] is the size of the true part of the run starting at tile a
+  for(Size width = 1; width < num_tiles; width *= 2)
+  {
+    for(Size a = 0; a + width < num_tiles; a += 2 * width)
+    {
+      const Size b = a + width;
+
+      parallel_stable_partition_detail::rotate(exec,
+                                               first + decomp[a].begin() + counts_ptr[a],
+                                               first + decomp[b].begin(),
+                                               first + decomp[b].begin() + counts_ptr[b]);
+
+      counts_ptr[a] += counts_ptr[b];
+    }
+  }
+
+  return first + counts_ptr[0];
+}
+
+
+} // end namespace parallel_stable_partition_detail
+
+
+// stably partitions [first, last) in place, using an O(num_tiles) temporary
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename Predicate,
+         typename Size>
+RandomAccessIterator parallel_stable_partition(thrust::execution_policy<DerivedPolicy> &exec,
+                                               RandomAccessIterator first,
+                                               RandomAccessIterator last,
+                                               Predicate pred,
+                                               Size max_tiles)
+{
+  using namespace parallel_stable_partition_detail;
+
+  uniform_decomposition<Size> decomp(last - first, grain_size, max_tiles);
+
+  if(decomp.size() <= 1)
+  {
+    return thrust::stable_partition(thrust::seq, first, last, pred);
+  }
+
+  // every element is tested before it moves, so the range is its own stencil
+  return stable_partition_tiles(exec, first, first, pred, decomp);
+}
+
+
+// as above, the predicate is applied to the stencil element at each element's original position
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename InputIterator,
+         typename Predicate,
+         typename Size>
+RandomAccessIterator parallel_stable_partition(thrust::execution_policy<DerivedPolicy> &exec,
+                                               RandomAccessIterator first,
+                                               RandomAccessIterator last,
+                                               InputIterator stencil,
+                                               Predicate pred,
+                                               Size max_tiles)
+{
+  using namespace parallel_stable_partition_detail;
+
+  uniform_decomposition<Size> decomp(last - first, grain_size, max_tiles);
+
+  if(decomp.size() <= 1)
+  {
+    return thrust::stable_partition(thrust::seq, first, last, stencil, pred);
+  }
+
+  return stable_partition_tiles(exec, first, stencil, pred, decomp);
+}
+
+
+// stably partitions [first, last) into out_true and out_false in a single
+// pass over the input, evaluating the predicate once per element
+// every tile counts its true elements in parallel, the counts are scanned
+// and every tile then writes both of its parts in parallel; the predicate
+// results are kept as one bit per element in between
+// the predicate is applied to the stencil, pass first as the stencil to
+// test the elements themselves
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename OutputIterator1,
+         typename OutputIterator2,
+         typename Predicate,
+         typename Size>
+thrust::pair<OutputIterator1,OutputIterator2>
+  parallel_stable_partition_copy(thrust::execution_policy<DerivedPolicy> &exec,
+                                 RandomAccessIterator1 first,
+                                 RandomAccessIterator1 last,
+                                 RandomAccessIterator2 stencil,
+                                 OutputIterator1 out_true,
+                                 OutputIterator2 out_false,
+                                 Predicate pred,
+                                 Size max_tiles)
+{
+  using namespace parallel_stable_partition_detail;
+
+  const Size n = last - first;
+
+  uniform_decomposition<Size> decomp(n, grain_size, max_tiles);
+
+  const Size num_tiles = decomp.size();
+
+  if(num_tiles <= 1)
+  {
+    return thrust::stable_partition_copy(thrust::seq, first, last, stencil, out_true, out_false, pred);
+  }
+
+  thrust::detail::temporary_array<Size,DerivedPolicy> temp(exec, 2 * (num_tiles + 1));
+
+  Size *offsets      = thrust::raw_pointer_cast(&*temp.begin());
+  Size *mask_offsets = offsets + (num_tiles + 1);
+
+  // every tile owns whole mask words, so that no two tiles write the same word
+  mask_offsets[0] = 0;
+
+  for(Size tile = 0; tile < num_tiles; ++tile)
+  {
+    mask_offsets[tile + 1] = mask_offsets[tile] + (decomp[tile].size() + mask_bits - 1) / mask_bits;
+  }
+
+  thrust::detail::temporary_array<MaskType,DerivedPolicy> mask(exec, mask_offsets[num_tiles]);
+  MaskType *mask_ptr = thrust::raw_pointer_cast(&*mask.begin());
+
+  thrust::counting_iterator<Size> tiles_first(0);
+  thrust::counting_iterator<Size> tiles_last(num_tiles);
+
+  // count the true elements of each tile
+  thrust::for_each(exec, tiles_first, tiles_last,
+                   count_tile<RandomAccessIterator2,Predicate,Size>(stencil, pred, decomp, mask_ptr, mask_offsets, offsets));
+
+  // scan the counts into output offsets
+  Size num_true = 0;
+
+  for(Size tile = 0; tile < num_tiles; ++tile)
+  {
+    Size count = offsets[tile];
+    offsets[tile] = num_true;
+    num_true += count;
+  }
+
+  // write both parts of each tile
+  thrust::for_each(exec, tiles_first, tiles_last,
+                   write_tile<RandomAccessIterator1,OutputIterator1,OutputIterator2,Size>(first, out_true, out_false, decomp, mask_ptr, mask_offsets, offsets));
+
+  return thrust::make_pair(out_true + num_true, out_false + (n - num_true));
+}
+
+
+} // end namespace internal
+} // end namespace detail
+} // end namespace system
+THRUST_NAMESPACE_END
+
@@ -0,0 +1,190 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+/*! \file sort_columns_by_key.h
+ *  \brief Sorts values stored as columns along their keys through a sort of
+ *         indices, shared by the host backends.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/copy.h>
+#include <thrust/distance.h>
+#include <thrust/gather.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+#include <thrust/tuple.h>
+#include <thrust/iterator/iterator_traits.h>
+#include <thrust/iterator/zip_iterator.h>
+#include <thrust/type_traits/integer_sequence.h>
+#include <thrust/type_traits/is_contiguous_iterator.h>
+#include <thrust/type_traits/logical_metafunctions.h>
+#include <thrust/detail/temporary_array.h>
+#include <thrust/detail/type_traits.h>
+
+#include <cstddef>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace detail
+{
+namespace internal
+{
+
+
+template<typename IteratorTuple,
+         typename Fields = thrust::make_index_sequence<thrust::tuple_size<IteratorTuple>::value> >
+  struct are_contiguous_iterators;
+
+template<typename IteratorTuple, std::size_t... Is>
+  struct are_contiguous_iterators<IteratorTuple, thrust::index_sequence<Is...> >
+    : thrust::conjunction<
+        thrust::is_contiguous_iterator<typename thrust::tuple_element<Is, IteratorTuple>::type>...
+      >
+{};
+
+// whether the values of a sort_by_key are stored as columns, such as those of
+// a soa_vector: a zip_iterator over at least two contiguous iterators
+template<typename Iterator>
+  struct is_sort_by_key_columns
+    : thrust::detail::false_type
+{};
+
+template<typename IteratorTuple>
+  struct is_sort_by_key_columns<thrust::zip_iterator<IteratorTuple> >
+    : thrust::detail::integral_constant<
+        bool,
+        (thrust::tuple_size<IteratorTuple>::value > 1) && are_contiguous_iterators<IteratorTuple>::value
+      >
+{};
+
+template<typename DerivedPolicy, typename Index, typename RandomAccessIterator>
+__host__ __device__
+  void gather_column(thrust::execution_policy<DerivedPolicy> &exec,
+                     const thrust::detail::temporary_array<Index, DerivedPolicy> &indices,
+                     RandomAccessIterator column)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type value_type;
+
+  thrust::detail::temporary_array<value_type, DerivedPolicy> sorted(exec, indices.size());
+  thrust::gather(exec, indices.begin(), indices.end(), column, sorted.begin());
+  thrust::copy(exec, sorted.begin(), sorted.end(), column);
+} // end gather_column()
+
+template<typename DerivedPolicy, typename Index, typename IteratorTuple, std::size_t... Is>
+__host__ __device__
+  void gather_columns(thrust::execution_policy<DerivedPolicy> &exec,
+                      const thrust::detail::temporary_array<Index, DerivedPolicy> &indices,
+                      IteratorTuple columns,
+                      thrust::index_sequence<Is...>)
+{
+  int l[] = { (gather_column(exec, indices, thrust::get<Is>(columns)), 0)... };
+  THRUST_UNUSED_VAR(l);
+} // end gather_columns()
+
+template<typename DerivedPolicy, typename RandomAccessIterator1, typename RandomAccessIterator2, typename StrictWeakOrdering>
+__host__ __device__
+  void sort_indices_by_key(thrust::execution_policy<DerivedPolicy> &exec,
+                           RandomAccessIterator1 keys_first,
+                           RandomAccessIterator1 keys_last,
+                           RandomAccessIterator2 indices_first,
+                           StrictWeakOrdering comp,
+                           thrust::detail::false_type /* stable */)
+{
+  thrust::sort_by_key(exec, keys_first, keys_last, indices_first, comp);
+} // end sort_indices_by_key()
+
+template<typename DerivedPolicy, typename RandomAccessIterator1, typename RandomAccessIterator2, typename StrictWeakOrdering>
+__host__ __device__
+  void sort_indices_by_key(thrust::execution_policy<DerivedPolicy> &exec,
+                           RandomAccessIterator1 keys_first,
+                           RandomAccessIterator1 keys_last,
+                           RandomAccessIterator2 indices_first,
+                           StrictWeakOrdering comp,
+                           thrust::detail::true_type /* stable */)
+{
+  thrust::stable_sort_by_key(exec, keys_first, keys_last, indices_first, comp);
+} // end sort_indices_by_key()
+
+template<typename Index,
+         typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename IteratorTuple,
+         typename StrictWeakOrdering,
+         typename Stable>
+__host__ __device__
+  void sort_columns_by_key_with_indices(thrust::execution_policy<DerivedPolicy> &exec,
+                                        RandomAccessIterator keys_first,
+                                        RandomAccessIterator keys_last,
+                                        thrust::zip_iterator<IteratorTuple> values_first,
+                                        StrictWeakOrdering comp,
+                                        Stable stable)
+{
+  thrust::detail::temporary_array<Index, DerivedPolicy> indices(exec, thrust::distance(keys_first, keys_last));
+  thrust::sequence(exec, indices.begin(), indices.end());
+
+  sort_indices_by_key(exec, keys_first, keys_last, indices.begin(), comp, stable);
+
+  gather_columns(exec,
+                 indices,
+                 values_first.get_iterator_tuple(),
+                 thrust::make_index_sequence<thrust::tuple_size<IteratorTuple>::value>());
+} // end sort_columns_by_key_with_indices()
+
+// sorts values stored as columns without moving whole tuples at every step of
+// the sort: the indices of the values are sorted along the keys, which for
+// arithmetic keys lets the backend radix sort pairs of integers, and every
+// column is then gathered once
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename IteratorTuple,
+         typename StrictWeakOrdering,
+         typename Stable>
+__host__ __device__
+  void sort_columns_by_key(thrust::execution_policy<DerivedPolicy> &exec,
+                           RandomAccessIterator keys_first,
+                           RandomAccessIterator keys_last,
+                           thrust::zip_iterator<IteratorTuple> values_first,
+                           StrictWeakOrdering comp,
+                           Stable stable)
+{
+  typedef typename thrust::iterator_difference<RandomAccessIterator>::type difference_type;
+
+  const difference_type n = thrust::distance(keys_first, keys_last);
+  if(n < 2)
+  {
+    return;
+  }
+
+  // 32-bit indices halve the memory traffic of the sort whenever they suffice
+  if(static_cast<std::size_t>(n) <= static_cast<std::size_t>(~0u))
+  {
+    sort_columns_by_key_with_indices<unsigned int>(exec, keys_first, keys_last, values_first, comp, stable);
+  }
+  else
+  {
+    sort_columns_by_key_with_indices<std::size_t>(exec, keys_first, keys_last, values_first, comp, stable);
+  }
+} // end sort_columns_by_key()
+
+
+} // end namespace internal
+} // end namespace detail
+} // end namespace system
+THRUST_NAMESPACE_END
@@ -0,0 +1,625 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+
+#include <thrust/iterator/iterator_traits.h>
+#include <thrust/iterator/zip_iterator.h>
+#include <thrust/tuple.h>
+#include <thrust/detail/function.h>
+#include <thrust/detail/internal_functional.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace detail
+{
+namespace sequential
+{
+namespace pdq_sort_detail
+{
+
+
+// ranges shorter than this are insertion sorted
+const static int insertion_sort_threshold = 24;
+
+// ranges longer than this pick their pivot as the median of three medians of three
+const static int ninther_threshold = 128;
+
+// the number of moves after which an optimistic insertion sort gives up
+const static int partial_insertion_sort_limit = 8;
+
+// the number of elements classified before any of them are swapped,
+// small enough for the offsets to fit an unsigned char
+const static int block_size = 64;
+
+
+__thrust_exec_check_disable__
+template<typename RandomAccessIterator>
+__host__ __device__
+void swap_elements(RandomAccessIterator a, RandomAccessIterator b)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type value_type;
+
+  value_type tmp = *a;
+  *a = *b;
+  *b = tmp;
+}
+
+
+__thrust_exec_check_disable__
+template<typename RandomAccessIterator, typename Compare>
+__host__ __device__
+void sort2(RandomAccessIterator a, RandomAccessIterator b, Compare comp)
+{
+  if(comp(*b, *a)) swap_elements(a, b);
+}
+
+
+// leaves the median of *a, *b and *c in *b
+__thrust_exec_check_disable__
+template<typename RandomAccessIterator, typename Compare>
+__host__ __device__
+void sort3(RandomAccessIterator a, RandomAccessIterator b, RandomAccessIterator c, Compare comp)
+{
+  sort2(a, b, comp);
+  sort2(b, c, comp);
+  sort2(a, b, comp);
+}
+
+
+__thrust_exec_check_disable__
+template<typename RandomAccessIterator, typename Compare>
+__host__ __device__
+void insertion_sort(RandomAccessIterator begin, RandomAccessIterator end, Compare comp)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type value_type;
+
+  if(begin == end) return;
+
+  for(RandomAccessIterator cur = begin + 1; cur != end; ++cur)
+  {
+    RandomAccessIterator sift   = cur;
+    RandomAccessIterator sift_1 = cur - 1;
+
+    if(comp(*sift, *sift_1))
+    {
+      value_type tmp = *sift;
+
+      do
+      {
+        *sift-- = *sift_1;
+      }
+      while(sift != begin && comp(tmp, *--sift_1));
+
+      *sift = tmp;
+    }
+  }
+}
+
+
+// as above, but *(begin - 1) is known not to be greater than any element of
+// [begin, end), which saves the bounds check
+__thrust_exec_check_disable__
+template<typename RandomAccessIterator, typename Compare>
+__host__ __device__
+void unguarded_insertion_sort(RandomAccessIterator begin, RandomAccessIterator end, Compare comp)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type value_type;
+
+  if(begin == end) return;
+
+  for(RandomAccessIterator cur = begin + 1; cur != end; ++cur)
+  {
+    RandomAccessIterator sift   = cur;
+    RandomAccessIterator sift_1 = cur - 1;
+
+    if(comp(*sift, *sift_1))
+    {
+      value_type tmp = *sift;
+
+      do
+      {
+        *sift-- = *sift_1;
+      }
+      while(comp(tmp, *--sift_1));
+
+      *sift = tmp;
+    }
+  }
+}
+
+
+// insertion sorts [begin, end) unless that takes more than
+// partial_insertion_sort_limit moves, returns whether the range is sorted
+__thrust_exec_check_disable__
+template<typename RandomAccessIterator, typename Compare>
+__host__ __device__
+bool partial_insertion_sort(RandomAccessIterator begin, RandomAccessIterator end, Compare comp)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type      value_type;
+  typedef typename thrust::iterator_difference<RandomAccessIterator>::type difference_type;
+
+  if(begin == end) return true;
+
+  difference_type limit = 0;
+
+  for(RandomAccessIterator cur = begin + 1; cur != end; ++cur)
+  {
+    RandomAccessIterator sift   = cur;
+    RandomAccessIterator sift_1 = cur - 1;
+
+    if(comp(*sift, *sift_1))
+    {
+      value_type tmp = *sift;
+
+      do
+      {
+        *sift-- = *sift_1;
+      }
+      while(sift != begin && comp(tmp, *--sift_1));
+
+      *sift = tmp;
+
+      limit += cur - sift;
+    }
+
+    if(limit > partial_insertion_sort_limit) return false;
+  }
+
+  return true;
+}
+
+
+__thrust_exec_check_disable__
+template<typename RandomAccessIterator, typename Size, typename Compare>
+__host__ __device__
+void sift_down(RandomAccessIterator first,
+               Size hole,
+               Size n,
+               typename thrust::iterator_value<RandomAccessIterator>::type value,
+               Compare comp)
+{
+  for(Size child = 2 * hole + 1; child < n; child = 2 * hole + 1)
+  {
+    if(child + 1 < n && comp(first[child], first[child + 1])) ++child;
+
+    if(!comp(value, first[child])) break;
+
+    first[hole] = first[child];
+    hole = child;
+  }
+
+  first[hole] = value;
+}
+
+
+// the O(n log n) fallback for inputs on which the pivots keep failing
+__thrust_exec_check_disable__
+template<typename RandomAccessIterator, typename Compare>
+__host__ __device__
+void heap_sort(RandomAccessIterator begin, RandomAccessIterator end, Compare comp)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type      value_type;
+  typedef typename thrust::iterator_difference<RandomAccessIterator>::type difference_type;
+
+  const difference_type n = end - begin;
+
+  for(difference_type i = n / 2; i-- > 0;)
+  {
+    value_type value = begin[i];
+    sift_down(begin, i, n, value, comp);
+  }
+
+  for(difference_type last = n - 1; last > 0; --last)
+  {
+    value_type value = begin[last];
+    begin[last] = begin[0];
+    sift_down(begin, difference_type(0), last, value, comp);
+  }
+}
+
+
+// exchanges the num elements at first + offsets_l[i] with those at last - offsets_r[i]
+// the pairs are swapped if both sides have the same number of misplaced
+// elements, otherwise they are cycled through a single temporary
+__thrust_exec_check_disable__
+template<typename RandomAccessIterator>
+__host__ __device__
+void swap_offsets(RandomAccessIterator first,
+                  RandomAccessIterator last,
+                  const unsigned char *offsets_l,
+                  const unsigned char *offsets_r,
+                  int num,
+                  bool use_swaps)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type value_type;
+
+  if(use_swaps)
+  {
+    for(int i = 0; i < num; ++i)
+    {
+      swap_elements(first + offsets_l[i], last - offsets_r[i]);
+    }
+  }
+  else if(num > 0)
+  {
+    RandomAccessIterator l = first + offsets_l[0];
+    RandomAccessIterator r = last  - offsets_r[0];
+
+    value_type tmp = *l;
+    *l = *r;
+
+    for(int i = 1; i < num; ++i)
+    {
+      l  = first + offsets_l[i];
+      *r = *l;
+      r  = last - offsets_r[i];
+      *l = *r;
+    }
+
+    *r = tmp;
+  }
+}
+
+
+// partitions [begin, end) around the pivot *begin so that the elements less
+// than it precede it and the others follow it, and returns the position of the
+// pivot along with whether the range was partitioned already
+// the comparisons against the pivot are made a block at a time and only
+// record the offsets of the misplaced elements, so that the loop has no
+// data-dependent branches which could be mispredicted
+// requires an element not less than the pivot after it and one not greater
+// than it before it, i.e. the median of three
+__thrust_exec_check_disable__
+template<typename RandomAccessIterator, typename Compare>
+__host__ __device__
+RandomAccessIterator partition_right(RandomAccessIterator begin,
+                                     RandomAccessIterator end,
+                                     Compare comp,
+                                     bool &already_partitioned)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type      value_type;
+  typedef typename thrust::iterator_difference<RandomAccessIterator>::type difference_type;
+
+  value_type pivot = *begin;
+
+  RandomAccessIterator first = begin;
+  RandomAccessIterator last  = end;
+
+  // find the first element not less than the pivot, the median of three guarantees one exists
+  while(comp(*++first, pivot));
+
+  // find the last element less than the pivot, guarded only if nothing was skipped above
+  if(first - 1 == begin)
+  {
+    while(first < last && !comp(*--last, pivot));
+  }
+  else
+  {
+    while(!comp(*--last, pivot));
+  }
+
+  already_partitioned = first >= last;
+
+  if(!already_partitioned)
+  {
+    swap_elements(first, last);
+    ++first;
+
+    unsigned char offsets_l[block_size];
+    unsigned char offsets_r[block_size];
+
+    RandomAccessIterator offsets_l_base = first;
+    RandomAccessIterator offsets_r_base = last;
+
+    int num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+    while(first < last)
+    {
+      // fill whichever offset buffers are empty, splitting the unknown
+      // elements between them if both are
+      const difference_type num_unknown = last - first;
+      const difference_type left_split  = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+      const difference_type right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+
+      const int left_count  = left_split  < block_size ? static_cast<int>(left_split)  : block_size;
+      const int right_count = right_split < block_size ? static_cast<int>(right_split) : block_size;
+
+      for(int i = 0; i < left_count; ++i)
+      {
+        offsets_l[num_l] = static_cast<unsigned char>(i);
+        num_l += !comp(*first, pivot);
+        ++first;
+      }
+
+      for(int i = 0; i < right_count;)
+      {
+        offsets_r[num_r] = static_cast<unsigned char>(++i);
+        num_r += comp(*--last, pivot);
+      }
+
+      // exchange as many misplaced elements as both sides have
+      const int num = num_l < num_r ? num_l : num_r;
+
+      swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+
+      num_l -= num; num_r -= num;
+      start_l += num; start_r += num;
+
+      if(num_l == 0) { start_l = 0; offsets_l_base = first; }
+      if(num_r == 0) { start_r = 0; offsets_r_base = last;  }
+    }
+
+    // at most one side has misplaced elements left, move them next to the split point
+    if(num_l)
+    {
+      while(num_l--)
+      {
+        swap_elements(offsets_l_base + offsets_l[start_l + num_l], --last);
+      }
+
+      first = last;
+    }
+
+    if(num_r)
+    {
+      while(num_r--)
+      {
+        swap_elements(offsets_r_base - offsets_r[start_r + num_r], first);
+        ++first;
+      }
+
+      last = first;
+    }
+  }
+
+  // put the pivot in place
+  RandomAccessIterator pivot_pos = first - 1;
+
+  *begin = *pivot_pos;
+  *pivot_pos = pivot;
+
+  return pivot_pos;
+}
+
+
+// partitions [begin, end) around the pivot *begin so that the elements equal
+// to it precede the others, used when the pivot equals the element before
+// the range, in which case no element of the range is less than the pivot
+__thrust_exec_check_disable__
+template<typename RandomAccessIterator, typename Compare>
+__host__ __device__
+RandomAccessIterator partition_left(RandomAccessIterator begin, RandomAccessIterator end, Compare comp)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type value_type;
+
+  value_type pivot = *begin;
+
+  RandomAccessIterator first = begin;
+  RandomAccessIterator last  = end;
+
+  while(comp(pivot, *--last));
+
+  if(last + 1 == end)
+  {
+    while(first < last && !comp(pivot, *++first));
+  }
+  else
+  {
+    while(!comp(pivot, *++first));
+  }
+
+  while(first < last)
+  {
+    swap_elements(first, last);
+
+    while(comp(pivot, *--last));
+    while(!comp(pivot, *++first));
+  }
+
+  *begin = *last;
+  *last  = pivot;
+
+  return last;
+}
+
+
+__thrust_exec_check_disable__
+template<typename RandomAccessIterator, typename Compare>
+__host__ __device__
+void pdq_sort_loop(RandomAccessIterator begin,
+                   RandomAccessIterator end,
+                   Compare comp,
+                   int bad_allowed,
+                   bool leftmost)
+{
+  typedef typename thrust::iterator_difference<RandomAccessIterator>::type difference_type;
+
+  while(true)
+  {
+    const difference_type size = end - begin;
+
+    if(size < insertion_sort_threshold)
+    {
+      if(leftmost) insertion_sort(begin, end, comp);
+      else         unguarded_insertion_sort(begin, end, comp);
+
+      return;
+    }
+
+    // choose the pivot and move it to begin
+    const difference_type s2 = size / 2;
+
+    if(size > ninther_threshold)
+    {
+      sort3(begin,          begin + s2,       end - 1, comp);
+      sort3(begin + 1,      begin + (s2 - 1), end - 2, comp);
+      sort3(begin + 2,      begin + (s2 + 1), end - 3, comp);
+      sort3(begin + (s2 - 1), begin + s2,     begin + (s2 + 1), comp);
+      swap_elements(begin, begin + s2);
+    }
+    else
+    {
+      sort3(begin + s2, begin, end - 1, comp);
+    }
+
+    // if the pivot equals the element before the range, which was the pivot of
+    // an enclosing partition, the range holds many equal elements: put those
+    // to the left, where they are done, and continue with the rest
+    if(!leftmost && !comp(*(begin - 1), *begin))
+    {
+      begin = partition_left(begin, end, comp) + 1;
+      continue;
+    }
+
+    bool already_partitioned = false;
+
+    RandomAccessIterator pivot_pos = partition_right(begin, end, comp, already_partitioned);
+
+    const difference_type l_size = pivot_pos - begin;
+    const difference_type r_size = end - (pivot_pos + 1);
+
+    if(l_size < size / 8 || r_size < size / 8)
+    {
+      // after log2(n) bad partitions give up on quicksort
+      if(--bad_allowed == 0)
+      {
+        heap_sort(begin, end, comp);
+        return;
+      }
+
+      // otherwise shuffle a few elements of either side to break up the pattern
+      if(l_size >= insertion_sort_threshold)
+      {
+        swap_elements(begin,         begin + l_size / 4);
+        swap_elements(pivot_pos - 1, pivot_pos - l_size / 4);
+
+        if(l_size > ninther_threshold)
+        {
+          swap_elements(begin + 1,     begin + (l_size / 4 + 1));
+          swap_elements(begin + 2,     begin + (l_size / 4 + 2));
+          swap_elements(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+          swap_elements(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+      }
+
+      if(r_size >= insertion_sort_threshold)
+      {
+        swap_elements(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        swap_elements(end - 1,       end - r_size / 4);
+
+        if(r_size > ninther_threshold)
+        {
+          swap_elements(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+          swap_elements(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+          swap_elements(end - 2,       end - (1 + r_size / 4));
+          swap_elements(end - 3,       end - (2 + r_size / 4));
+        }
+      }
+    }
+    else if(already_partitioned &&
+            partial_insertion_sort(begin, pivot_pos, comp) &&
+            partial_insertion_sort(pivot_pos + 1, end, comp))
+    {
+      // a balanced partition which moved nothing suggests the input is
+      // (nearly) sorted, which the insertion sorts confirmed
+      return;
+    }
+
+    // recurse into the smaller side and loop on the larger one to bound the stack depth
+    if(l_size < r_size)
+    {
+      pdq_sort_loop(begin, pivot_pos, comp, bad_allowed, leftmost);
+
+      begin    = pivot_pos + 1;
+      leftmost = false;
+    }
+    else
+    {
+      pdq_sort_loop(pivot_pos + 1, end, comp, bad_allowed, false);
+
+      end = pivot_pos;
+    }
+  }
+}
+
+
+template<typename Size>
+__host__ __device__
+int floor_log2(Size n)
+{
+  int result = 0;
+
+  while(n >>= 1) ++result;
+
+  return result;
+}
+
+
+} // end namespace pdq_sort_detail
+
+
+__thrust_exec_check_disable__
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+__host__ __device__
+void pdq_sort(sequential::execution_policy<DerivedPolicy> &,
+              RandomAccessIterator begin,
+              RandomAccessIterator end,
+              StrictWeakOrdering comp)
+{
+  if(end - begin < 2) return;
+
+  // wrap comp
+  thrust::detail::wrapped_function<
+    StrictWeakOrdering,
+    bool
+  > wrapped_comp(comp);
+
+  pdq_sort_detail::pdq_sort_loop(begin, end, wrapped_comp, pdq_sort_detail::floor_log2(end - begin), true);
+}
+
+
+__thrust_exec_check_disable__
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+__host__ __device__
+void pdq_sort_by_key(sequential::execution_policy<DerivedPolicy> &exec,
+                     RandomAccessIterator1 keys_begin,
+                     RandomAccessIterator1 keys_end,
+                     RandomAccessIterator2 values_begin,
+                     StrictWeakOrdering comp)
+{
+  // sort the keys and values as pairs ordered by the keys
+  thrust::detail::compare_first<StrictWeakOrdering> comp_first(comp);
+
+  sequential::pdq_sort(exec,
+                       thrust::make_zip_iterator(thrust::make_tuple(keys_begin, values_begin)),
+                       thrust::make_zip_iterator(thrust::make_tuple(keys_end, values_begin + (keys_end - keys_begin))),
+                       comp_first);
+}
+
+
+} // end namespace sequential
+} // end namespace detail
+} // end namespace system
+THRUST_NAMESPACE_END
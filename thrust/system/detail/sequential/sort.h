@@ -32,6 +32,28 @@ namespace sequential
 {
 
 
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+__host__ __device__
+void sort(sequential::execution_policy<DerivedPolicy> &exec,
+          RandomAccessIterator first,
+          RandomAccessIterator last,
+          StrictWeakOrdering comp);
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+__host__ __device__
+void sort_by_key(sequential::execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator1 first1,
+                 RandomAccessIterator1 last1,
+                 RandomAccessIterator2 first2,
+                 StrictWeakOrdering comp);
+
+
 template<typename DerivedPolicy,
          typename RandomAccessIterator,
          typename StrictWeakOrdering>
@@ -1,6 +1,6 @@
 /*
  *  Copyright 2008-2021 NVIDIA Corporation
- *  Modifications Copyright© 2019-2023 Advanced Micro Devices, Inc. All rights reserved.
+ *  Modifications Copyright© 2019-2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -24,6 +24,8 @@
 #include <thrust/iterator/iterator_traits.h>
 #include <thrust/system/detail/sequential/stable_merge_sort.h>
 #include <thrust/system/detail/sequential/stable_primitive_sort.h>
+#include <thrust/system/detail/sequential/pdq_sort.h>
+#include <thrust/system/detail/internal/sort_columns_by_key.h>
 
 #include <thrust/detail/nv_target.h>
 
@@ -153,9 +155,197 @@ struct use_primitive_sort
 {};
 
 
+///////////////////
+// Unstable Sort //
+///////////////////
+
+
+// arithmetic keys compared with less or greater are radix sorted, which is stable anyway
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+__host__ __device__
+void sort(sequential::execution_policy<DerivedPolicy> &exec,
+          RandomAccessIterator first,
+          RandomAccessIterator last,
+          StrictWeakOrdering comp,
+          thrust::detail::true_type)
+{
+  sort_detail::stable_sort(exec, first, last, comp, thrust::detail::true_type());
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+__host__ __device__
+void sort_by_key(sequential::execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator1 first1,
+                 RandomAccessIterator1 last1,
+                 RandomAccessIterator2 first2,
+                 StrictWeakOrdering comp,
+                 thrust::detail::true_type)
+{
+  sort_detail::stable_sort_by_key(exec, first1, last1, first2, comp, thrust::detail::true_type());
+}
+
+
+// everything else is sorted in place with pattern-defeating quicksort
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+__host__ __device__
+void sort(sequential::execution_policy<DerivedPolicy> &exec,
+          RandomAccessIterator first,
+          RandomAccessIterator last,
+          StrictWeakOrdering comp,
+          thrust::detail::false_type)
+{
+  thrust::system::detail::sequential::pdq_sort(exec, first, last, comp);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+__host__ __device__
+void sort_by_key(sequential::execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator1 first1,
+                 RandomAccessIterator1 last1,
+                 RandomAccessIterator2 first2,
+                 StrictWeakOrdering comp,
+                 thrust::detail::false_type)
+{
+  thrust::system::detail::sequential::pdq_sort_by_key(exec, first1, last1, first2, comp);
+}
+
+
+// values stored as columns, such as those of a soa_vector, are sorted on the
+// host through a sort of their indices, and gathered once
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+__host__ __device__
+void dispatch_sort_by_key(sequential::execution_policy<DerivedPolicy> &exec,
+                          RandomAccessIterator1 first1,
+                          RandomAccessIterator1 last1,
+                          RandomAccessIterator2 first2,
+                          StrictWeakOrdering comp,
+                          thrust::detail::false_type /* columns */)
+{
+  using KeyType = thrust::iterator_value_t<RandomAccessIterator1>;
+  sort_detail::use_primitive_sort<KeyType, StrictWeakOrdering> use_primitive_sort;
+  sort_detail::sort_by_key(exec, first1, last1, first2, comp, use_primitive_sort);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+__host__ __device__
+void dispatch_sort_by_key(sequential::execution_policy<DerivedPolicy> &exec,
+                          RandomAccessIterator1 first1,
+                          RandomAccessIterator1 last1,
+                          RandomAccessIterator2 first2,
+                          StrictWeakOrdering comp,
+                          thrust::detail::true_type /* columns */)
+{
+  thrust::system::detail::internal::sort_columns_by_key(exec, first1, last1, first2, comp, thrust::detail::false_type());
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+__host__ __device__
+void dispatch_stable_sort_by_key(sequential::execution_policy<DerivedPolicy> &exec,
+                                 RandomAccessIterator1 first1,
+                                 RandomAccessIterator1 last1,
+                                 RandomAccessIterator2 first2,
+                                 StrictWeakOrdering comp,
+                                 thrust::detail::false_type /* columns */)
+{
+  using KeyType = thrust::iterator_value_t<RandomAccessIterator1>;
+  sort_detail::use_primitive_sort<KeyType, StrictWeakOrdering> use_primitive_sort;
+  sort_detail::stable_sort_by_key(exec, first1, last1, first2, comp, use_primitive_sort);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+__host__ __device__
+void dispatch_stable_sort_by_key(sequential::execution_policy<DerivedPolicy> &exec,
+                                 RandomAccessIterator1 first1,
+                                 RandomAccessIterator1 last1,
+                                 RandomAccessIterator2 first2,
+                                 StrictWeakOrdering comp,
+                                 thrust::detail::true_type /* columns */)
+{
+  thrust::system::detail::internal::sort_columns_by_key(exec, first1, last1, first2, comp, thrust::detail::true_type());
+}
+
+
 } // end namespace sort_detail
 
 
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+__host__ __device__
+void sort(sequential::execution_policy<DerivedPolicy> &exec,
+          RandomAccessIterator first,
+          RandomAccessIterator last,
+          StrictWeakOrdering comp)
+{
+
+  // a single CUDA or HIP thread keeps the merge sort, whose stack depth is bounded
+  NV_IF_TARGET(NV_IS_HOST, (
+    using KeyType = thrust::iterator_value_t<RandomAccessIterator>;
+    sort_detail::use_primitive_sort<KeyType, StrictWeakOrdering> use_primitive_sort;
+    sort_detail::sort(exec, first, last, comp, use_primitive_sort);
+  ), ( // NV_IS_DEVICE:
+    thrust::detail::false_type use_primitive_sort;
+    sort_detail::stable_sort(exec, first, last, comp, use_primitive_sort);
+  ));
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+__host__ __device__
+void sort_by_key(sequential::execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator1 first1,
+                 RandomAccessIterator1 last1,
+                 RandomAccessIterator2 first2,
+                 StrictWeakOrdering comp)
+{
+
+  // a single CUDA or HIP thread keeps the merge sort, whose stack depth is bounded
+  NV_IF_TARGET(NV_IS_HOST, (
+    thrust::system::detail::internal::is_sort_by_key_columns<RandomAccessIterator2> columns;
+    sort_detail::dispatch_sort_by_key(exec, first1, last1, first2, comp, columns);
+  ), ( // NV_IS_DEVICE:
+    thrust::detail::false_type use_primitive_sort;
+    sort_detail::stable_sort_by_key(exec, first1, last1, first2, comp, use_primitive_sort);
+  ));
+}
+
+
 template<typename DerivedPolicy,
          typename RandomAccessIterator,
          typename StrictWeakOrdering>
@@ -192,9 +382,8 @@ void stable_sort_by_key(sequential::execution_policy<DerivedPolicy> &exec,
 
   // the compilation time of stable_primitive_sort_by_key is too expensive to use within a single CUDA or HIP thread
   NV_IF_TARGET(NV_IS_HOST, (
-    using KeyType = thrust::iterator_value_t<RandomAccessIterator1>;
-    sort_detail::use_primitive_sort<KeyType, StrictWeakOrdering> use_primitive_sort;
-    sort_detail::stable_sort_by_key(exec, first1, last1, first2, comp, use_primitive_sort);
+    thrust::system::detail::internal::is_sort_by_key_columns<RandomAccessIterator2> columns;
+    sort_detail::dispatch_stable_sort_by_key(exec, first1, last1, first2, comp, columns);
   ), ( // NV_IS_DEVICE:
     thrust::detail::false_type use_primitive_sort;
     sort_detail::stable_sort_by_key(exec, first1, last1, first2, comp, use_primitive_sort);
@@ -1,5 +1,6 @@
 /*
  *  Copyright 2008-2021 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -21,11 +22,11 @@
 #include <thrust/copy.h>
 #include <thrust/functional.h>
 #include <thrust/iterator/iterator_traits.h>
-#include <thrust/iterator/transform_iterator.h>
-#include <thrust/iterator/zip_iterator.h>
 #include <thrust/detail/temporary_array.h>
 #include <thrust/detail/cstdint.h>
-#include <thrust/scatter.h>
+#include <thrust/detail/raw_pointer_cast.h>
+#include <thrust/detail/raw_reference_cast.h>
+#include <thrust/detail/type_traits.h>
 
 #include <limits>
 
@@ -140,106 +141,177 @@ struct RadixEncoder<double> : public thrust::unary_function<double, thrust::deta
 };
 
 
-// this functor returns a key's to its histogram bucket count and post-increments the bucket
-template<unsigned int RadixBits, typename KeyType>
-  struct bucket_functor
+// the raw bits of a T, for the types that fit an unsigned integer
+template<size_t Size> struct unsigned_of_size;
+template<> struct unsigned_of_size<1> { typedef thrust::detail::uint8_t  type; };
+template<> struct unsigned_of_size<2> { typedef thrust::detail::uint16_t type; };
+template<> struct unsigned_of_size<4> { typedef thrust::detail::uint32_t type; };
+
+
+// a key and a value packed into one 64-bit word, the key in the low bits,
+// so that every pass moves a single array instead of two
+template<typename KeyType, typename ValueType>
+struct packed_pair
 {
-  typedef RadixEncoder<KeyType> Encoder;
-  typedef typename Encoder::result_type EncodedType;
-  typedef size_t result_type;
-  static const EncodedType BitMask = static_cast<EncodedType>((1 << RadixBits) - 1);
+  typedef thrust::detail::uint64_t word_type;
 
-  Encoder encode;
-  EncodedType bit_shift;
-  size_t *histogram;
+  typedef typename unsigned_of_size<sizeof(KeyType)>::type   key_bits_type;
+  typedef typename unsigned_of_size<sizeof(ValueType)>::type value_bits_type;
+
+  static const unsigned int ValueShift = 8 * sizeof(KeyType);
 
   __host__ __device__
-  bucket_functor(EncodedType bit_shift, size_t *histogram)
-    : encode(),
-      bit_shift(bit_shift),
-      histogram(histogram)
-  {}
-
-  inline __host__ __device__
-  size_t operator()(KeyType key)
+  static word_type pack(KeyType key, ValueType value)
   {
-    const EncodedType x = encode(key);
+    union { KeyType   k; key_bits_type   i; } uk;
+    union { ValueType v; value_bits_type i; } uv;
+    uk.k = key;
+    uv.v = value;
+    return static_cast<word_type>(uk.i) | (static_cast<word_type>(uv.i) << ValueShift);
+  }
+
+  __host__ __device__
+  static KeyType key(word_type w)
+  {
+    union { KeyType k; key_bits_type i; } u;
+    u.i = static_cast<key_bits_type>(w);
+    return u.k;
+  }
+
+  __host__ __device__
+  static ValueType value(word_type w)
+  {
+    union { ValueType v; value_bits_type i; } u;
+    u.i = static_cast<value_bits_type>(w >> ValueShift);
+    return u.v;
+  }
+};
+
+
+template<typename KeyType, typename ValueType>
+struct packed_pair_encoder : public thrust::unary_function<thrust::detail::uint64_t, typename RadixEncoder<KeyType>::result_type>
+{
+  RadixEncoder<KeyType> encode;
 
-    // note that we mutate the histogram here
-    return histogram[(x >> bit_shift) & BitMask]++;
+  __host__ __device__
+  typename RadixEncoder<KeyType>::result_type operator()(thrust::detail::uint64_t w) const
+  {
+    return encode(packed_pair<KeyType,ValueType>::key(w));
   }
 };
 
 
+// 4-byte keys are worth packing with values of up to 4 bytes: they take three
+// or four passes, so the packing and unpacking passes pay for themselves
+template<typename KeyType, typename ValueType>
+struct can_pack
+  : thrust::detail::integral_constant<
+      bool,
+      sizeof(KeyType) == 4 &&
+      (sizeof(ValueType) == 1 || sizeof(ValueType) == 2 || sizeof(ValueType) == 4) &&
+      thrust::detail::has_trivial_constructor<ValueType>::value &&
+      thrust::detail::has_trivial_copy_constructor<ValueType>::value
+    >
+{};
+
+
+// 11-bit digits save a pass over 8-bit ones while both buffers the passes
+// alternate between stay in cache, beyond that the 2048 output streams of
+// each pass thrash it and 8-bit digits are faster
+// the histograms of 11-bit digits are not worth clearing for small inputs
+template<size_t ElementSize>
+__host__ __device__
+bool use_wide_digits(const size_t N)
+{
+  return N >= (1 << 12) && N * ElementSize < (1 << 22);
+}
+
+
+// scatters [first, first + n) by the digit of their keys at bit_shift and
+// post-increments the digits' offsets in histogram
 template<unsigned int RadixBits,
-         typename DerivedPolicy,
          typename RandomAccessIterator1,
          typename RandomAccessIterator2,
+         typename Encoder,
          typename Integer>
 inline __host__ __device__
-void radix_shuffle_n(sequential::execution_policy<DerivedPolicy> &exec,
-                     RandomAccessIterator1 first,
+void radix_shuffle_n(RandomAccessIterator1 first,
                      const size_t n,
                      RandomAccessIterator2 result,
+                     Encoder encode,
                      Integer bit_shift,
                      size_t *histogram)
 {
   typedef typename thrust::iterator_value<RandomAccessIterator1>::type KeyType;
+  typedef typename Encoder::result_type EncodedType;
+
+  const EncodedType BitMask = static_cast<EncodedType>((1 << RadixBits) - 1);
 
-  // note that we are going to mutate the histogram during this sequential scatter
-  thrust::scatter(exec,
-                  first, first + n,
-                  thrust::make_transform_iterator(first, bucket_functor<RadixBits,KeyType>(bit_shift, histogram)),
-                  result);
+  for(size_t i = 0; i < n; i++)
+  {
+    const KeyType key = first[i];
+    const EncodedType x = encode(key);
+
+    // the writes go through raw references, as the sequences may be tagged with a
+    // system other than the host system, such as those of a cpp::vector with OpenMP
+    // as the host system
+    thrust::raw_reference_cast(result[histogram[(x >> bit_shift) & BitMask]++]) = key;
+  }
 }
 
 
 template<unsigned int RadixBits,
-         typename DerivedPolicy,
          typename RandomAccessIterator1,
          typename RandomAccessIterator2,
          typename RandomAccessIterator3,
          typename RandomAccessIterator4,
+         typename Encoder,
          typename Integer>
 __host__ __device__
-void radix_shuffle_n(sequential::execution_policy<DerivedPolicy> &exec,
-                     RandomAccessIterator1 keys_first,
+void radix_shuffle_n(RandomAccessIterator1 keys_first,
                      RandomAccessIterator2 values_first,
                      const size_t n,
                      RandomAccessIterator3 keys_result,
                      RandomAccessIterator4 values_result,
+                     Encoder encode,
                      Integer bit_shift,
                      size_t *histogram)
 {
   typedef typename thrust::iterator_value<RandomAccessIterator1>::type KeyType;
+  typedef typename Encoder::result_type EncodedType;
 
-  // note that we are going to mutate the histogram during this sequential scatter
-  thrust::scatter(exec,
-                  thrust::make_zip_iterator(thrust::make_tuple(keys_first, values_first)),
-                  thrust::make_zip_iterator(thrust::make_tuple(keys_first + n, values_first + n)),
-                  thrust::make_transform_iterator(keys_first, bucket_functor<RadixBits,KeyType>(bit_shift, histogram)),
-                  thrust::make_zip_iterator(thrust::make_tuple(keys_result, values_result)));
+  const EncodedType BitMask = static_cast<EncodedType>((1 << RadixBits) - 1);
+
+  for(size_t i = 0; i < n; i++)
+  {
+    const KeyType key = keys_first[i];
+    const EncodedType x = encode(key);
+
+    const size_t j = histogram[(x >> bit_shift) & BitMask]++;
+
+    thrust::raw_reference_cast(keys_result[j])   = key;
+    thrust::raw_reference_cast(values_result[j]) = values_first[i];
+  }
 }
 
 
+// sorts by the digits of encode(key) and returns true if the result ended up
+// in (keys2,vals2) rather than in (keys1,vals1)
 template<unsigned int RadixBits,
          bool HasValues,
-         typename DerivedPolicy,
          typename RandomAccessIterator1,
          typename RandomAccessIterator2,
          typename RandomAccessIterator3,
-         typename RandomAccessIterator4>
+         typename RandomAccessIterator4,
+         typename Encoder>
 __host__ __device__
-void radix_sort(sequential::execution_policy<DerivedPolicy> &exec,
-                RandomAccessIterator1 keys1,
-                RandomAccessIterator2 keys2,
-                RandomAccessIterator3 vals1,
-                RandomAccessIterator4 vals2,
-                const size_t N)
+bool radix_sort_passes(RandomAccessIterator1 keys1,
+                       RandomAccessIterator2 keys2,
+                       RandomAccessIterator3 vals1,
+                       RandomAccessIterator4 vals2,
+                       const size_t N,
+                       Encoder encode)
 {
-  typedef typename thrust::iterator_value<RandomAccessIterator1>::type KeyType;
-
-  typedef RadixEncoder<KeyType> Encoder;
   typedef typename Encoder::result_type EncodedType;
 
   const unsigned int NumHistograms = (8 * sizeof(EncodedType) + (RadixBits - 1)) / RadixBits;
@@ -247,8 +319,6 @@ void radix_sort(sequential::execution_policy<DerivedPolicy> &exec,
 
   const EncodedType BitMask = static_cast<EncodedType>((1 << RadixBits) - 1);
 
-  Encoder encode;
-
   // storage for histograms
   size_t histograms[NumHistograms][HistogramSize] = {{0}};
 
@@ -299,22 +369,22 @@ void radix_sort(sequential::execution_policy<DerivedPolicy> &exec,
       {
         if(HasValues)
         {
-          radix_shuffle_n<RadixBits>(exec, keys2, vals2, N, keys1, vals1, BitShift, histograms[i]);
+          radix_shuffle_n<RadixBits>(keys2, vals2, N, keys1, vals1, encode, BitShift, histograms[i]);
         }
         else
         {
-          radix_shuffle_n<RadixBits>(exec, keys2, N, keys1, BitShift, histograms[i]);
+          radix_shuffle_n<RadixBits>(keys2, N, keys1, encode, BitShift, histograms[i]);
         }
       }
       else
       {
         if(HasValues)
         {
-          radix_shuffle_n<RadixBits>(exec, keys1, vals1, N, keys2, vals2, BitShift, histograms[i]);
+          radix_shuffle_n<RadixBits>(keys1, vals1, N, keys2, vals2, encode, BitShift, histograms[i]);
         }
         else
         {
-          radix_shuffle_n<RadixBits>(exec, keys1, N, keys2, BitShift, histograms[i]);
+          radix_shuffle_n<RadixBits>(keys1, N, keys2, encode, BitShift, histograms[i]);
         }
       }
 
@@ -322,6 +392,29 @@ void radix_sort(sequential::execution_policy<DerivedPolicy> &exec,
     }
   }
 
+  return flip;
+}
+
+
+template<unsigned int RadixBits,
+         bool HasValues,
+         typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename RandomAccessIterator3,
+         typename RandomAccessIterator4>
+__host__ __device__
+void radix_sort(sequential::execution_policy<DerivedPolicy> &exec,
+                RandomAccessIterator1 keys1,
+                RandomAccessIterator2 keys2,
+                RandomAccessIterator3 vals1,
+                RandomAccessIterator4 vals2,
+                const size_t N)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator1>::type KeyType;
+
+  const bool flip = radix_sort_passes<RadixBits,HasValues>(keys1, keys2, vals1, vals2, N, RadixEncoder<KeyType>());
+
   // ensure final values are in (keys1,vals1)
   if(flip)
   {
@@ -335,8 +428,51 @@ void radix_sort(sequential::execution_policy<DerivedPolicy> &exec,
 }
 
 
+// sorts the keys and values as packed 64-bit words, which are unpacked
+// straight from the buffer holding the result
+// the two word buffers take 16 bytes per pair, up to twice the temporary
+// storage of sorting the keys and values apart
+template<unsigned int RadixBits,
+         typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2>
+__host__ __device__
+void radix_sort_packed(sequential::execution_policy<DerivedPolicy> &exec,
+                       RandomAccessIterator1 keys,
+                       RandomAccessIterator2 vals,
+                       const size_t N)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator1>::type KeyType;
+  typedef typename thrust::iterator_value<RandomAccessIterator2>::type ValueType;
+
+  typedef packed_pair<KeyType,ValueType> Pair;
+  typedef typename Pair::word_type       WordType;
+
+  thrust::detail::temporary_array<WordType, DerivedPolicy> words(exec, 2 * N);
+
+  WordType *words1 = thrust::raw_pointer_cast(&*words.begin());
+  WordType *words2 = words1 + N;
+
+  for(size_t i = 0; i < N; i++)
+  {
+    words1[i] = Pair::pack(keys[i], vals[i]);
+  }
+
+  const bool flip = radix_sort_passes<RadixBits,false>(words1, words2, static_cast<int *>(0), static_cast<int *>(0),
+                                                       N, packed_pair_encoder<KeyType,ValueType>());
+
+  const WordType *result = flip ? words2 : words1;
+
+  for(size_t i = 0; i < N; i++)
+  {
+    thrust::raw_reference_cast(keys[i]) = Pair::key(result[i]);
+    thrust::raw_reference_cast(vals[i]) = Pair::value(result[i]);
+  }
+}
+
+
 // Select best radix sort parameters based on sizeof(T) and input size
-// These particular values were determined through empirical testing on a Core i7 950 CPU
+// The 1- and 2-byte values were determined through empirical testing on a Core i7 950 CPU
 template <size_t KeySize>
 struct radix_sort_dispatcher
 {
@@ -440,13 +576,13 @@ struct radix_sort_dispatcher<4>
                   RandomAccessIterator1 keys1, RandomAccessIterator2 keys2,
                   const size_t N)
   {
-    if(N < (1 << 22))
+    if(use_wide_digits<4>(N))
     {
-      radix_sort_detail::radix_sort<8,false>(exec, keys1, keys2, static_cast<int *>(0), static_cast<int *>(0), N);
+      radix_sort_detail::radix_sort<11,false>(exec, keys1, keys2, static_cast<int *>(0), static_cast<int *>(0), N);
     }
     else
     {
-      radix_sort_detail::radix_sort<4,false>(exec, keys1, keys2, static_cast<int *>(0), static_cast<int *>(0), N);
+      radix_sort_detail::radix_sort<8,false>(exec, keys1, keys2, static_cast<int *>(0), static_cast<int *>(0), N);
     }
   }
 
@@ -461,13 +597,15 @@ struct radix_sort_dispatcher<4>
                   RandomAccessIterator3 vals1, RandomAccessIterator4 vals2,
                   const size_t N)
   {
-    if(N < (1 << 22))
+    typedef typename thrust::iterator_value<RandomAccessIterator3>::type ValueType;
+
+    if(use_wide_digits<4 + sizeof(ValueType)>(N))
     {
-      radix_sort_detail::radix_sort<8,true>(exec, keys1, keys2, vals1, vals2, N);
+      radix_sort_detail::radix_sort<11,true>(exec, keys1, keys2, vals1, vals2, N);
     }
     else
     {
-      radix_sort_detail::radix_sort<3,true>(exec, keys1, keys2, vals1, vals2, N);
+      radix_sort_detail::radix_sort<8,true>(exec, keys1, keys2, vals1, vals2, N);
     }
   }
 };
@@ -484,13 +622,13 @@ struct radix_sort_dispatcher<8>
                   RandomAccessIterator1 keys1, RandomAccessIterator2 keys2,
                   const size_t N)
   {
-    if(N < (1 << 21))
+    if(use_wide_digits<8>(N))
     {
-      radix_sort_detail::radix_sort<8,false>(exec, keys1, keys2, static_cast<int *>(0), static_cast<int *>(0), N);
+      radix_sort_detail::radix_sort<11,false>(exec, keys1, keys2, static_cast<int *>(0), static_cast<int *>(0), N);
     }
     else
     {
-      radix_sort_detail::radix_sort<4,false>(exec, keys1, keys2, static_cast<int *>(0), static_cast<int *>(0), N);
+      radix_sort_detail::radix_sort<8,false>(exec, keys1, keys2, static_cast<int *>(0), static_cast<int *>(0), N);
     }
   }
 
@@ -505,13 +643,15 @@ struct radix_sort_dispatcher<8>
                   RandomAccessIterator3 vals1, RandomAccessIterator4 vals2,
                   const size_t N)
   {
-    if(N < (1 << 21))
+    typedef typename thrust::iterator_value<RandomAccessIterator3>::type ValueType;
+
+    if(use_wide_digits<8 + sizeof(ValueType)>(N))
     {
-      radix_sort_detail::radix_sort<8,true>(exec, keys1, keys2, vals1, vals2, N);
+      radix_sort_detail::radix_sort<11,true>(exec, keys1, keys2, vals1, vals2, N);
     }
     else
     {
-      radix_sort_detail::radix_sort<3,true>(exec, keys1, keys2, vals1, vals2, N);
+      radix_sort_detail::radix_sort<8,true>(exec, keys1, keys2, vals1, vals2, N);
     }
   }
 };
@@ -548,6 +688,50 @@ void radix_sort(sequential::execution_policy<DerivedPolicy> &exec,
   radix_sort_dispatcher<sizeof(KeyType)>()(exec, keys1, keys2, vals1, vals2, N);
 }
 
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2>
+__host__ __device__
+void radix_sort_by_key(sequential::execution_policy<DerivedPolicy> &exec,
+                       RandomAccessIterator1 keys,
+                       RandomAccessIterator2 vals,
+                       const size_t N,
+                       thrust::detail::false_type)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator1>::type KeyType;
+  typedef typename thrust::iterator_value<RandomAccessIterator2>::type ValueType;
+
+  thrust::detail::temporary_array<KeyType, DerivedPolicy>   temp1(exec, N);
+  thrust::detail::temporary_array<ValueType, DerivedPolicy> temp2(exec, N);
+
+  radix_sort(exec, keys, temp1.begin(), vals, temp2.begin(), N);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2>
+__host__ __device__
+void radix_sort_by_key(sequential::execution_policy<DerivedPolicy> &exec,
+                       RandomAccessIterator1 keys,
+                       RandomAccessIterator2 vals,
+                       const size_t N,
+                       thrust::detail::true_type)
+{
+  if(N < (1 << 12))
+  {
+    radix_sort_by_key(exec, keys, vals, N, thrust::detail::false_type());
+  }
+  else if(use_wide_digits<8>(N))
+  {
+    radix_sort_packed<11>(exec, keys, vals, N);
+  }
+  else
+  {
+    radix_sort_packed<8>(exec, keys, vals, N);
+  }
+}
+
 
 } // namespace radix_sort_detail
 
@@ -583,10 +767,10 @@ void stable_radix_sort_by_key(sequential::execution_policy<DerivedPolicy> &exec,
 
   size_t N = last1 - first1;
 
-  thrust::detail::temporary_array<KeyType, DerivedPolicy>   temp1(exec, N);
-  thrust::detail::temporary_array<ValueType, DerivedPolicy> temp2(exec, N);
+  // pack small pairs into single words rather than shuffle keys and values apart
+  radix_sort_detail::can_pack<KeyType,ValueType> can_pack;
 
-  radix_sort_detail::radix_sort(exec, first1, temp1.begin(), first2, temp2.begin(), N);
+  radix_sort_detail::radix_sort_by_key(exec, first1, first2, N, can_pack);
 }
 
 
@@ -18,7 +18,16 @@
 
 #include <thrust/detail/config.h>
 #include <thrust/system/omp/detail/copy_if.h>
-#include <thrust/system/detail/generic/copy_if.h>
+#include <thrust/system/omp/detail/default_decomposition.h>
+#include <thrust/system/omp/detail/execution_config.h>
+#include <thrust/system/omp/detail/pragma_omp.h>
+#include <thrust/system/detail/sequential/copy_if.h>
+#include <thrust/detail/temporary_array.h>
+#include <thrust/detail/raw_pointer_cast.h>
+#include <thrust/detail/static_assert.h>
+#include <thrust/detail/function.h>
+#include <thrust/detail/cstdint.h>
+#include <thrust/distance.h>
 
 THRUST_NAMESPACE_BEGIN
 namespace system
@@ -29,6 +38,20 @@ namespace detail
 {
 
 
+namespace copy_if_detail
+{
+
+
+// the predicate results of a tile are kept as one bit per element between
+// the counting and the writing pass
+typedef thrust::detail::uint64_t MaskType;
+
+const static int mask_bits = 64;
+
+
+} // end namespace copy_if_detail
+
+
 template<typename DerivedPolicy,
          typename InputIterator1,
          typename InputIterator2,
@@ -41,8 +64,119 @@ template<typename DerivedPolicy,
                          OutputIterator result,
                          Predicate pred)
 {
-  // omp prefers generic::copy_if to cpp::copy_if
-  return thrust::system::detail::generic::copy_if(exec, first, last, stencil, result, pred);
+  // we're attempting to launch an omp kernel, assert we're compiling with omp support
+  // ========================================================================
+  // X Note to the user: If you've found this line due to a compiler error, X
+  // X you need to enable OpenMP support in your compiler.                  X
+  // ========================================================================
+  THRUST_STATIC_ASSERT_MSG(
+    (thrust::detail::depend_on_instantiation<
+      InputIterator1, (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+    >::value)
+  , "OpenMP compiler support is not enabled"
+  );
+
+  using copy_if_detail::MaskType;
+  using copy_if_detail::mask_bits;
+
+  typedef thrust::detail::intptr_t index_type;
+
+  const index_type n = thrust::distance(first, last);
+
+  thrust::system::detail::internal::uniform_decomposition<index_type> decomp = thrust::system::omp::detail::default_decomposition(exec, n);
+
+  const index_type num_tiles = decomp.size();
+
+  // a single tile gains nothing from the two pass algorithm
+  if(num_tiles <= 1)
+  {
+    return thrust::system::detail::sequential::copy_if(exec, first, last, stencil, result, pred);
+  }
+
+  index_type num_selected = 0;
+
+#if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+  thrust::detail::wrapped_function<Predicate,bool> wrapped_pred(pred);
+
+  // offsets[i] is the output position of tile i, masks[i] the first mask word of tile i
+  thrust::detail::temporary_array<index_type,DerivedPolicy> temp(exec, 2 * (num_tiles + 1));
+
+  index_type *offsets = thrust::raw_pointer_cast(&*temp.begin());
+  index_type *masks   = offsets + (num_tiles + 1);
+
+  masks[0] = 0;
+
+  for(index_type i = 0; i < num_tiles; i++)
+  {
+    masks[i + 1] = masks[i] + (decomp[i].size() + mask_bits - 1) / mask_bits;
+  }
+
+  thrust::detail::temporary_array<MaskType,DerivedPolicy> mask_words(exec, masks[num_tiles]);
+
+  MaskType *mask = thrust::raw_pointer_cast(&*mask_words.begin());
+
+  scoped_schedule loop_schedule(exec);
+
+  // evaluate the predicate of every element once and count the selected elements of each tile
+  THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
+  for(index_type i = 0; i < num_tiles; i++)
+  {
+    InputIterator2 s         = stencil + decomp[i].begin();
+    MaskType      *tile_mask = mask + masks[i];
+
+    const index_type size = decomp[i].size();
+
+    index_type count = 0;
+    MaskType   bits  = 0;
+
+    for(index_type j = 0; j < size; ++j, ++s)
+    {
+      if(wrapped_pred(*s))
+      {
+        bits |= MaskType(1) << (j % mask_bits);
+        ++count;
+      }
+
+      if(j % mask_bits == mask_bits - 1 || j == size - 1)
+      {
+        tile_mask[j / mask_bits] = bits;
+        bits = 0;
+      }
+    }
+
+    offsets[i] = count;
+  }
+
+  // scan the counts into output offsets
+  for(index_type i = 0; i < num_tiles; i++)
+  {
+    index_type count = offsets[i];
+    offsets[i] = num_selected;
+    num_selected += count;
+  }
+
+  // write the selected elements of each tile at its offset
+  THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
+  for(index_type i = 0; i < num_tiles; i++)
+  {
+    InputIterator1  src       = first + decomp[i].begin();
+    OutputIterator  dst       = result + offsets[i];
+    const MaskType *tile_mask = mask + masks[i];
+
+    const index_type size = decomp[i].size();
+
+    for(index_type j = 0; j < size; ++j, ++src)
+    {
+      if((tile_mask[j / mask_bits] >> (j % mask_bits)) & 1)
+      {
+        *dst = *src;
+        ++dst;
+      }
+    }
+  }
+#endif // THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE
+
+  return result + num_selected;
 } // end copy_if()
 
 
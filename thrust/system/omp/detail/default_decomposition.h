@@ -23,6 +23,7 @@
 
 #include <thrust/detail/config.h>
 #include <thrust/system/detail/internal/decompose.h>
+#include <thrust/system/omp/detail/execution_policy.h>
 
 THRUST_NAMESPACE_BEGIN
 namespace system
@@ -35,6 +36,10 @@ namespace detail
 template <typename IndexType>
 thrust::system::detail::internal::uniform_decomposition<IndexType> default_decomposition(IndexType n);
 
+// one tile per thread of exec when its thread count is set, otherwise as above
+template <typename DerivedPolicy, typename IndexType>
+thrust::system::detail::internal::uniform_decomposition<IndexType> default_decomposition(execution_policy<DerivedPolicy> &exec, IndexType n);
+
 } // end namespace detail
 } // end namespace omp
 } // end namespace system
@@ -18,6 +18,7 @@
 
 #include <thrust/detail/config.h>
 #include <thrust/system/omp/detail/default_decomposition.h>
+#include <thrust/system/omp/detail/execution_config.h>
 
 // don't attempt to #include this file without omp support
 #if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
@@ -54,6 +55,19 @@ thrust::system::detail::internal::uniform_decomposition<IndexType> default_decom
 #endif
 }
 
+template <typename DerivedPolicy, typename IndexType>
+thrust::system::detail::internal::uniform_decomposition<IndexType> default_decomposition(execution_policy<DerivedPolicy> &exec, IndexType n)
+{
+  const execution_config config = config_of(exec);
+
+  if(config.num_threads > 0)
+  {
+    return thrust::system::detail::internal::uniform_decomposition<IndexType>(n, 1, config.num_threads);
+  }
+
+  return thrust::system::omp::detail::default_decomposition(n);
+}
+
 } // end namespace detail
 } // end namespace omp
 } // end namespace system
@@ -0,0 +1,150 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file execution_config.h
+ *  \brief The thread count and loop schedule attached to an OpenMP
+ *         execution policy.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/system/omp/detail/execution_policy.h>
+#include <thrust/detail/execution_policy.h>
+
+// don't attempt to #include this file without omp support
+#if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+#include <omp.h>
+#endif // omp support
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace omp
+{
+
+
+// the loop schedules selectable with par.schedule(), see OpenMP's schedule clause
+enum class schedule_kind
+{
+  static_,
+  dynamic,
+  guided,
+  auto_
+};
+
+
+namespace detail
+{
+
+
+struct execution_config
+{
+  // the number of threads of every parallel region, or 0 for OpenMP's default
+  int num_threads;
+
+  schedule_kind schedule;
+
+  // the chunk size of the schedule, or 0 for the schedule's default
+  int chunk_size;
+
+  execution_config()
+    : num_threads(0), schedule(schedule_kind::static_), chunk_size(0)
+  {}
+};
+
+
+// policies without modifiers use OpenMP's default team size and a static schedule
+template<typename DerivedPolicy>
+execution_config get_config(const execution_policy<DerivedPolicy> &)
+{
+  return execution_config();
+}
+
+
+template<typename DerivedPolicy>
+execution_config config_of(execution_policy<DerivedPolicy> &exec)
+{
+  return get_config(thrust::detail::derived_cast(exec));
+}
+
+
+// the number of threads of the parallel regions launched for exec
+template<typename DerivedPolicy>
+int max_threads(execution_policy<DerivedPolicy> &exec)
+{
+  const execution_config config = config_of(exec);
+
+#if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+  return config.num_threads > 0 ? config.num_threads : omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+
+// applies exec's schedule to the schedule(runtime) loops of the enclosing
+// scope and restores the caller's schedule on exit
+class scoped_schedule
+{
+public:
+  template<typename DerivedPolicy>
+  explicit scoped_schedule(execution_policy<DerivedPolicy> &exec)
+  {
+#if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+    const execution_config config = config_of(exec);
+
+    omp_get_schedule(&saved_kind, &saved_chunk_size);
+
+    omp_sched_t kind = omp_sched_static;
+
+    switch(config.schedule)
+    {
+      case schedule_kind::dynamic: kind = omp_sched_dynamic; break;
+      case schedule_kind::guided:  kind = omp_sched_guided;  break;
+      case schedule_kind::auto_:   kind = omp_sched_auto;    break;
+      default:                     kind = omp_sched_static;  break;
+    }
+
+    omp_set_schedule(kind, config.chunk_size);
+#else
+    (void) exec;
+#endif
+  }
+
+  ~scoped_schedule()
+  {
+#if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+    omp_set_schedule(saved_kind, saved_chunk_size);
+#endif
+  }
+
+private:
+#if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+  omp_sched_t saved_kind;
+  int saved_chunk_size;
+#endif
+
+  scoped_schedule(const scoped_schedule &);
+  scoped_schedule &operator=(const scoped_schedule &);
+};
+
+
+} // end detail
+} // end omp
+} // end system
+THRUST_NAMESPACE_END
+
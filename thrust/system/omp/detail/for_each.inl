@@ -22,6 +22,7 @@
 #include <thrust/distance.h>
 #include <thrust/for_each.h>
 #include <thrust/iterator/iterator_traits.h>
+#include <thrust/system/omp/detail/execution_config.h>
 #include <thrust/system/omp/detail/pragma_omp.h>
 
 THRUST_NAMESPACE_BEGIN
@@ -36,7 +37,7 @@ template<typename DerivedPolicy,
          typename RandomAccessIterator,
          typename Size,
          typename UnaryFunction>
-RandomAccessIterator for_each_n(execution_policy<DerivedPolicy> &,
+RandomAccessIterator for_each_n(execution_policy<DerivedPolicy> &exec,
                                 RandomAccessIterator first,
                                 Size n,
                                 UnaryFunction f)
@@ -62,7 +63,10 @@ RandomAccessIterator for_each_n(execution_policy<DerivedPolicy> &,
   typedef typename thrust::iterator_difference<RandomAccessIterator>::type DifferenceType;
   DifferenceType signed_n = n;
 
-  THRUST_PRAGMA_OMP(parallel for)
+  // run with the thread count and schedule of exec
+  scoped_schedule loop_schedule(exec);
+
+  THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
   for(DifferenceType i = 0;
       i < signed_n;
       ++i)
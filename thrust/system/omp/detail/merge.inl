@@ -0,0 +1,223 @@
+/*
+ *  Copyright 2008-2013 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/system/omp/detail/merge.h>
+#include <thrust/system/omp/detail/default_decomposition.h>
+#include <thrust/system/omp/detail/execution_config.h>
+#include <thrust/system/omp/detail/pragma_omp.h>
+#include <thrust/system/detail/internal/merge_path.h>
+#include <thrust/iterator/iterator_traits.h>
+#include <thrust/detail/static_assert.h>
+#include <thrust/detail/cstdint.h>
+#include <thrust/distance.h>
+#include <thrust/merge.h>
+#include <thrust/detail/seq.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace omp
+{
+namespace detail
+{
+namespace merge_detail
+{
+
+
+// merges the elements of [first1, first1 + n1) and [first2, first2 + n2)
+// which land in [result + begin, result + end) of the merged output
+template<typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename RandomAccessIterator3,
+         typename Size,
+         typename StrictWeakOrdering>
+void merge_diagonals(RandomAccessIterator1 first1, Size n1,
+                     RandomAccessIterator2 first2, Size n2,
+                     RandomAccessIterator3 result,
+                     Size begin, Size end,
+                     StrictWeakOrdering comp)
+{
+  using thrust::system::detail::internal::merge_path;
+
+  Size begin1 = merge_path(first1, n1, first2, n2, begin, comp);
+  Size end1   = merge_path(first1, n1, first2, n2, end,   comp);
+
+  thrust::merge(thrust::seq,
+                first1 + begin1, first1 + end1,
+                first2 + (begin - begin1), first2 + (end - end1),
+                result + begin,
+                comp);
+}
+
+
+// merges the keys and values of [keys_first1, keys_first1 + n1) and
+// [keys_first2, keys_first2 + n2) which land in [begin, end) of the merged output
+template<typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename RandomAccessIterator3,
+         typename RandomAccessIterator4,
+         typename RandomAccessIterator5,
+         typename RandomAccessIterator6,
+         typename Size,
+         typename StrictWeakOrdering>
+void merge_by_key_diagonals(RandomAccessIterator1 keys_first1, Size n1,
+                            RandomAccessIterator2 keys_first2, Size n2,
+                            RandomAccessIterator3 values_first1,
+                            RandomAccessIterator4 values_first2,
+                            RandomAccessIterator5 keys_result,
+                            RandomAccessIterator6 values_result,
+                            Size begin, Size end,
+                            StrictWeakOrdering comp)
+{
+  using thrust::system::detail::internal::merge_path;
+
+  Size begin1 = merge_path(keys_first1, n1, keys_first2, n2, begin, comp);
+  Size end1   = merge_path(keys_first1, n1, keys_first2, n2, end,   comp);
+
+  thrust::merge_by_key(thrust::seq,
+                       keys_first1 + begin1, keys_first1 + end1,
+                       keys_first2 + (begin - begin1), keys_first2 + (end - end1),
+                       values_first1 + begin1,
+                       values_first2 + (begin - begin1),
+                       keys_result + begin,
+                       values_result + begin,
+                       comp);
+}
+
+
+} // end namespace merge_detail
+
+
+template<typename DerivedPolicy,
+         typename InputIterator1,
+         typename InputIterator2,
+         typename OutputIterator,
+         typename StrictWeakOrdering>
+OutputIterator merge(execution_policy<DerivedPolicy> &exec,
+                     InputIterator1 first1,
+                     InputIterator1 last1,
+                     InputIterator2 first2,
+                     InputIterator2 last2,
+                     OutputIterator result,
+                     StrictWeakOrdering comp)
+{
+  // we're attempting to launch an omp kernel, assert we're compiling with omp support
+  // ========================================================================
+  // X Note to the user: If you've found this line due to a compiler error, X
+  // X you need to enable OpenMP support in your compiler.                  X
+  // ========================================================================
+  THRUST_STATIC_ASSERT_MSG(
+    (thrust::detail::depend_on_instantiation<
+      InputIterator1, (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+    >::value)
+  , "OpenMP compiler support is not enabled"
+  );
+
+  typedef thrust::detail::intptr_t index_type;
+
+  const index_type n1 = thrust::distance(first1, last1);
+  const index_type n2 = thrust::distance(first2, last2);
+
+#if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+  // split the output into tiles along the merge path
+  thrust::system::detail::internal::uniform_decomposition<index_type> decomp = thrust::system::omp::detail::default_decomposition(exec, n1 + n2);
+
+  const index_type num_tiles = decomp.size();
+
+  scoped_schedule loop_schedule(exec);
+
+  THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
+  for(index_type i = 0; i < num_tiles; i++)
+  {
+    merge_detail::merge_diagonals(first1, n1, first2, n2, result,
+                                  decomp[i].begin(), decomp[i].end(),
+                                  comp);
+  }
+#endif // THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE
+
+  return result + (n1 + n2);
+} // end merge()
+
+
+template<typename DerivedPolicy,
+         typename InputIterator1,
+         typename InputIterator2,
+         typename InputIterator3,
+         typename InputIterator4,
+         typename OutputIterator1,
+         typename OutputIterator2,
+         typename StrictWeakOrdering>
+thrust::pair<OutputIterator1,OutputIterator2>
+  merge_by_key(execution_policy<DerivedPolicy> &exec,
+               InputIterator1 keys_first1,
+               InputIterator1 keys_last1,
+               InputIterator2 keys_first2,
+               InputIterator2 keys_last2,
+               InputIterator3 values_first1,
+               InputIterator4 values_first2,
+               OutputIterator1 keys_result,
+               OutputIterator2 values_result,
+               StrictWeakOrdering comp)
+{
+  // we're attempting to launch an omp kernel, assert we're compiling with omp support
+  // ========================================================================
+  // X Note to the user: If you've found this line due to a compiler error, X
+  // X you need to enable OpenMP support in your compiler.                  X
+  // ========================================================================
+  THRUST_STATIC_ASSERT_MSG(
+    (thrust::detail::depend_on_instantiation<
+      InputIterator1, (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+    >::value)
+  , "OpenMP compiler support is not enabled"
+  );
+
+  typedef thrust::detail::intptr_t index_type;
+
+  const index_type n1 = thrust::distance(keys_first1, keys_last1);
+  const index_type n2 = thrust::distance(keys_first2, keys_last2);
+
+#if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+  // split the output into tiles along the merge path
+  thrust::system::detail::internal::uniform_decomposition<index_type> decomp = thrust::system::omp::detail::default_decomposition(exec, n1 + n2);
+
+  const index_type num_tiles = decomp.size();
+
+  scoped_schedule loop_schedule(exec);
+
+  THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
+  for(index_type i = 0; i < num_tiles; i++)
+  {
+    merge_detail::merge_by_key_diagonals(keys_first1, n1, keys_first2, n2,
+                                         values_first1, values_first2,
+                                         keys_result, values_result,
+                                         decomp[i].begin(), decomp[i].end(),
+                                         comp);
+  }
+#endif // THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE
+
+  return thrust::make_pair(keys_result + (n1 + n2), values_result + (n1 + n2));
+} // end merge_by_key()
+
+
+} // end namespace detail
+} // end namespace omp
+} // end namespace system
+THRUST_NAMESPACE_END
+
@@ -19,6 +19,8 @@
 #include <thrust/detail/config.h>
 #include <thrust/detail/allocator_aware_execution_policy.h>
 #include <thrust/system/omp/detail/execution_policy.h>
+#include <thrust/system/omp/detail/execution_config.h>
+#include <thrust/detail/execution_policy.h>
 
 THRUST_NAMESPACE_BEGIN
 namespace system
@@ -29,12 +31,67 @@ namespace detail
 {
 
 
+// a policy carrying the thread count and schedule set by the
+// num_threads() and schedule() modifiers
+template<typename Derived>
+struct execute_with_config_base : thrust::system::omp::detail::execution_policy<Derived>
+{
+private:
+  execution_config config;
+
+public:
+  execute_with_config_base()
+    : config()
+  {}
+
+  // the number of threads of every parallel region, and the number of tiles
+  // of the tiled algorithms
+  Derived num_threads(int count) const
+  {
+    Derived result = thrust::detail::derived_cast(*this);
+    result.config.num_threads = count;
+    return result;
+  }
+
+  // the schedule of the parallel loops, a chunk_size of 0 selects the schedule's default
+  Derived schedule(schedule_kind kind, int chunk_size = 0) const
+  {
+    Derived result = thrust::detail::derived_cast(*this);
+    result.config.schedule   = kind;
+    result.config.chunk_size = chunk_size;
+    return result;
+  }
+
+private:
+  friend execution_config get_config(const execute_with_config_base &exec)
+  {
+    return exec.config;
+  }
+
+  template<typename> friend struct execute_with_config_base;
+};
+
+
+struct execute_with_config : execute_with_config_base<execute_with_config>
+{};
+
+
 struct par_t : thrust::system::omp::detail::execution_policy<par_t>,
   thrust::detail::allocator_aware_execution_policy<
-    thrust::system::omp::detail::execution_policy>
+    execute_with_config_base>
 {
   __host__ __device__
   constexpr par_t() : thrust::system::omp::detail::execution_policy<par_t>() {}
+
+  execute_with_config num_threads(int count) const
+  {
+    return execute_with_config().num_threads(count);
+  }
+
+  execute_with_config schedule(schedule_kind kind, int chunk_size = 0) const
+  {
+    return execute_with_config().schedule(kind, chunk_size);
+  }
 };
 
 
@@ -54,6 +111,7 @@ namespace omp
 
 
 using thrust::system::omp::par;
+using thrust::system::omp::schedule_kind;
 
 
 } // end omp
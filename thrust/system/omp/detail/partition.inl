@@ -24,6 +24,10 @@
 #include <thrust/detail/config.h>
 #include <thrust/system/omp/detail/partition.h>
 #include <thrust/system/detail/generic/partition.h>
+#include <thrust/system/omp/detail/default_decomposition.h>
+#include <thrust/system/detail/internal/parallel_partition.h>
+#include <thrust/system/detail/internal/parallel_stable_partition.h>
+#include <thrust/distance.h>
 
 THRUST_NAMESPACE_BEGIN
 namespace system
@@ -34,6 +38,50 @@ namespace detail
 {
 
 
+namespace partition_detail
+{
+
+
+// one tile per tile of the default decomposition
+template<typename DerivedPolicy, typename Size>
+Size max_tiles(execution_policy<DerivedPolicy> &exec, Size n)
+{
+  return thrust::system::omp::detail::default_decomposition(exec, n).size();
+}
+
+
+} // end namespace partition_detail
+
+
+template<typename DerivedPolicy,
+         typename ForwardIterator,
+         typename Predicate>
+  ForwardIterator partition(execution_policy<DerivedPolicy> &exec,
+                            ForwardIterator first,
+                            ForwardIterator last,
+                            Predicate pred)
+{
+  // partition in place rather than through a stable partition of a copy
+  return thrust::system::detail::internal::parallel_partition(exec, first, last, pred,
+                                                              partition_detail::max_tiles(exec, thrust::distance(first, last)));
+} // end partition()
+
+
+template<typename DerivedPolicy,
+         typename ForwardIterator,
+         typename InputIterator,
+         typename Predicate>
+  ForwardIterator partition(execution_policy<DerivedPolicy> &exec,
+                            ForwardIterator first,
+                            ForwardIterator last,
+                            InputIterator stencil,
+                            Predicate pred)
+{
+  return thrust::system::detail::internal::parallel_partition(exec, first, last, stencil, pred,
+                                                              partition_detail::max_tiles(exec, thrust::distance(first, last)));
+} // end partition()
+
+
 template<typename DerivedPolicy,
          typename ForwardIterator,
          typename Predicate>
@@ -42,8 +90,9 @@ template<typename DerivedPolicy,
                                    ForwardIterator last,
                                    Predicate pred)
 {
-  // omp prefers generic::stable_partition to cpp::stable_partition
-  return thrust::system::detail::generic::stable_partition(exec, first, last, pred);
+  // partition in place rather than through a copy of the input
+  return thrust::system::detail::internal::parallel_stable_partition(exec, first, last, pred,
+                                                                     partition_detail::max_tiles(exec, thrust::distance(first, last)));
 } // end stable_partition()
 
 
@@ -57,8 +106,8 @@ template<typename DerivedPolicy,
                                    InputIterator stencil,
                                    Predicate pred)
 {
-  // omp prefers generic::stable_partition to cpp::stable_partition
-  return thrust::system::detail::generic::stable_partition(exec, first, last, stencil, pred);
+  return thrust::system::detail::internal::parallel_stable_partition(exec, first, last, stencil, pred,
+                                                                     partition_detail::max_tiles(exec, thrust::distance(first, last)));
 } // end stable_partition()
 
 
@@ -75,8 +124,9 @@ template<typename DerivedPolicy,
                           OutputIterator2 out_false,
                           Predicate pred)
 {
-  // omp prefers generic::stable_partition_copy to cpp::stable_partition_copy
-  return thrust::system::detail::generic::stable_partition_copy(exec, first, last, out_true, out_false, pred);
+  // a single pass which evaluates pred once per element, rather than one remove_copy_if per output
+  return thrust::system::detail::internal::parallel_stable_partition_copy(exec, first, last, first, out_true, out_false, pred,
+                                                                          partition_detail::max_tiles(exec, thrust::distance(first, last)));
 } // end stable_partition_copy()
 
 
@@ -95,8 +145,8 @@ template<typename DerivedPolicy,
                           OutputIterator2 out_false,
                           Predicate pred)
 {
-  // omp prefers generic::stable_partition_copy to cpp::stable_partition_copy
-  return thrust::system::detail::generic::stable_partition_copy(exec, first, last, stencil, out_true, out_false, pred);
+  return thrust::system::detail::internal::parallel_stable_partition_copy(exec, first, last, stencil, out_true, out_false, pred,
+                                                                          partition_detail::max_tiles(exec, thrust::distance(first, last)));
 } // end stable_partition_copy()
 
 
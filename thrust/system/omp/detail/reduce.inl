@@ -46,7 +46,7 @@ template<typename DerivedPolicy,
   const difference_type n = thrust::distance(first,last);
 
   // determine first and second level decomposition
-  thrust::system::detail::internal::uniform_decomposition<difference_type> decomp1 = thrust::system::omp::detail::default_decomposition(n);
+  thrust::system::detail::internal::uniform_decomposition<difference_type> decomp1 = thrust::system::omp::detail::default_decomposition(exec, n);
   thrust::system::detail::internal::uniform_decomposition<difference_type> decomp2(decomp1.size() + 1, 1, 1);
 
   // allocate storage for the initializer and partial sums
@@ -21,6 +21,8 @@
 #include <thrust/iterator/iterator_traits.h>
 #include <thrust/detail/function.h>
 #include <thrust/detail/cstdint.h>
+#include <thrust/system/omp/detail/execution_config.h>
+#include <thrust/system/omp/detail/pragma_omp.h>
 
 THRUST_NAMESPACE_BEGIN
 namespace system
@@ -35,7 +37,7 @@ template <typename DerivedPolicy,
           typename OutputIterator,
           typename BinaryFunction,
           typename Decomposition>
-void reduce_intervals(execution_policy<DerivedPolicy> &,
+void reduce_intervals(execution_policy<DerivedPolicy> &exec,
                       InputIterator input,
                       OutputIterator output,
                       BinaryFunction binary_op,
@@ -63,7 +65,9 @@ void reduce_intervals(execution_policy<DerivedPolicy> &,
 
   index_type n = static_cast<index_type>(decomp.size());
 
-  THRUST_PRAGMA_OMP(parallel for)
+  scoped_schedule loop_schedule(exec);
+
+  THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
   for(index_type i = 0; i < n; i++)
   {
     InputIterator begin = input + decomp[i].begin();
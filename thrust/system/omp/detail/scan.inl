@@ -0,0 +1,223 @@
+/*
+ *  Copyright 2008-2013 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/system/omp/detail/scan.h>
+#include <thrust/system/omp/detail/default_decomposition.h>
+#include <thrust/system/omp/detail/reduce_intervals.h>
+#include <thrust/system/omp/detail/execution_config.h>
+#include <thrust/system/omp/detail/pragma_omp.h>
+#include <thrust/system/detail/sequential/scan.h>
+#include <thrust/detail/temporary_array.h>
+#include <thrust/detail/function.h>
+#include <thrust/detail/cstdint.h>
+#include <thrust/distance.h>
+#include <thrust/iterator/iterator_traits.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace omp
+{
+namespace detail
+{
+namespace scan_detail
+{
+
+
+// scans each interval of decomp independently, seeding interval i > 0
+// with carries[i - 1], the inclusive sum of all preceding intervals
+template<typename DerivedPolicy,
+         typename InputIterator,
+         typename OutputIterator,
+         typename CarryIterator,
+         typename BinaryFunction,
+         typename Decomposition>
+  void inclusive_scan_intervals(execution_policy<DerivedPolicy> &exec,
+                                InputIterator input,
+                                OutputIterator output,
+                                CarryIterator carries,
+                                BinaryFunction binary_op,
+                                Decomposition decomp)
+{
+#if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+  typedef typename thrust::iterator_value<CarryIterator>::type ValueType;
+
+  // wrap binary_op
+  thrust::detail::wrapped_function<BinaryFunction,ValueType> wrapped_binary_op(binary_op);
+
+  typedef thrust::detail::intptr_t index_type;
+
+  index_type n = static_cast<index_type>(decomp.size());
+
+  scoped_schedule loop_schedule(exec);
+
+  THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
+  for(index_type i = 0; i < n; i++)
+  {
+    InputIterator  first  = input  + decomp[i].begin();
+    InputIterator  last   = input  + decomp[i].end();
+    OutputIterator result = output + decomp[i].begin();
+
+    if (first != last)
+    {
+      ValueType sum = (i == 0) ? ValueType(*first) : wrapped_binary_op(carries[i - 1], *first);
+
+      *result = sum;
+
+      for(++first, ++result; first != last; ++first, ++result)
+        *result = sum = wrapped_binary_op(sum, *first);
+    }
+  }
+#endif // THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE
+}
+
+
+// scans each interval of decomp independently, seeding interval i
+// with carries[i], the exclusive sum of all preceding intervals
+template<typename DerivedPolicy,
+         typename InputIterator,
+         typename OutputIterator,
+         typename CarryIterator,
+         typename BinaryFunction,
+         typename Decomposition>
+  void exclusive_scan_intervals(execution_policy<DerivedPolicy> &exec,
+                                InputIterator input,
+                                OutputIterator output,
+                                CarryIterator carries,
+                                BinaryFunction binary_op,
+                                Decomposition decomp)
+{
+#if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+  typedef typename thrust::iterator_value<CarryIterator>::type ValueType;
+
+  typedef thrust::detail::intptr_t index_type;
+
+  index_type n = static_cast<index_type>(decomp.size());
+
+  scoped_schedule loop_schedule(exec);
+
+  THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
+  for(index_type i = 0; i < n; i++)
+  {
+    InputIterator  first  = input  + decomp[i].begin();
+    InputIterator  last   = input  + decomp[i].end();
+    OutputIterator result = output + decomp[i].begin();
+
+    ValueType sum = carries[i];
+
+    for(; first != last; ++first, ++result)
+    {
+      ValueType tmp = *first;  // temporary value allows in-situ scan
+      *result = sum;
+      sum = binary_op(sum, tmp);
+    }
+  }
+#endif // THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE
+}
+
+
+} // end namespace scan_detail
+
+
+template<typename DerivedPolicy,
+         typename InputIterator,
+         typename OutputIterator,
+         typename BinaryFunction>
+  OutputIterator inclusive_scan(execution_policy<DerivedPolicy> &exec,
+                                InputIterator first,
+                                InputIterator last,
+                                OutputIterator result,
+                                BinaryFunction binary_op)
+{
+  // Use the input iterator's value type per https://wg21.link/P0571
+  typedef typename thrust::iterator_value<InputIterator>::type      ValueType;
+  typedef typename thrust::iterator_difference<InputIterator>::type difference_type;
+
+  const difference_type n = thrust::distance(first, last);
+
+  thrust::system::detail::internal::uniform_decomposition<difference_type> decomp = thrust::system::omp::detail::default_decomposition(exec, n);
+
+  // a single interval gains nothing from the two pass algorithm
+  if (decomp.size() <= 1)
+  {
+    return thrust::system::detail::sequential::inclusive_scan(exec, first, last, result, binary_op);
+  }
+
+  // reduce each interval (first pass)
+  thrust::detail::temporary_array<ValueType,DerivedPolicy> partial_sums(exec, decomp.size());
+
+  thrust::system::omp::detail::reduce_intervals(exec, first, partial_sums.begin(), binary_op, decomp);
+
+  // scan the partial sums to produce the carry into each interval
+  thrust::system::detail::sequential::inclusive_scan(exec, partial_sums.begin(), partial_sums.end(), partial_sums.begin(), binary_op);
+
+  // scan each interval starting from its carry (second pass)
+  scan_detail::inclusive_scan_intervals(exec, first, result, partial_sums.begin(), binary_op, decomp);
+
+  return result + n;
+} // end inclusive_scan()
+
+
+template<typename DerivedPolicy,
+         typename InputIterator,
+         typename OutputIterator,
+         typename InitialValueType,
+         typename BinaryFunction>
+  OutputIterator exclusive_scan(execution_policy<DerivedPolicy> &exec,
+                                InputIterator first,
+                                InputIterator last,
+                                OutputIterator result,
+                                InitialValueType init,
+                                BinaryFunction binary_op)
+{
+  // Use the initial value type per https://wg21.link/P0571
+  typedef InitialValueType                                          ValueType;
+  typedef typename thrust::iterator_difference<InputIterator>::type difference_type;
+
+  const difference_type n = thrust::distance(first, last);
+
+  thrust::system::detail::internal::uniform_decomposition<difference_type> decomp = thrust::system::omp::detail::default_decomposition(exec, n);
+
+  // a single interval gains nothing from the two pass algorithm
+  if (decomp.size() <= 1)
+  {
+    return thrust::system::detail::sequential::exclusive_scan(exec, first, last, result, init, binary_op);
+  }
+
+  // reduce each interval (first pass)
+  thrust::detail::temporary_array<ValueType,DerivedPolicy> partial_sums(exec, decomp.size());
+
+  thrust::system::omp::detail::reduce_intervals(exec, first, partial_sums.begin(), binary_op, decomp);
+
+  // scan the partial sums to produce the carry into each interval
+  thrust::system::detail::sequential::exclusive_scan(exec, partial_sums.begin(), partial_sums.end(), partial_sums.begin(), init, binary_op);
+
+  // scan each interval starting from its carry (second pass)
+  scan_detail::exclusive_scan_intervals(exec, first, result, partial_sums.begin(), binary_op, decomp);
+
+  return result + n;
+} // end exclusive_scan()
+
+
+} // end namespace detail
+} // end namespace omp
+} // end namespace system
+THRUST_NAMESPACE_END
+
@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2008-2013 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/system/omp/detail/set_operations.h>
+#include <thrust/system/omp/detail/default_decomposition.h>
+#include <thrust/system/detail/internal/parallel_set_operations.h>
+#include <thrust/distance.h>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace omp
+{
+namespace detail
+{
+namespace set_operations_detail
+{
+
+
+// one partition per tile of the default decomposition
+template<typename DerivedPolicy, typename Size>
+Size max_partitions(execution_policy<DerivedPolicy> &exec, Size n)
+{
+  return thrust::system::omp::detail::default_decomposition(exec, n).size();
+}
+
+
+} // end namespace set_operations_detail
+
+
+template<typename DerivedPolicy,
+         typename InputIterator1,
+         typename InputIterator2,
+         typename OutputIterator,
+         typename StrictWeakOrdering>
+  OutputIterator set_difference(execution_policy<DerivedPolicy> &exec,
+                                InputIterator1 first1,
+                                InputIterator1 last1,
+                                InputIterator2 first2,
+                                InputIterator2 last2,
+                                OutputIterator result,
+                                StrictWeakOrdering comp)
+{
+  return thrust::system::detail::internal::parallel_set_operation(exec, first1, last1, first2, last2, result, comp,
+                                                                  thrust::system::detail::internal::set_difference_op(),
+                                                                  set_operations_detail::max_partitions(exec, thrust::distance(first1, last1) + thrust::distance(first2, last2)));
+} // end set_difference()
+
+
+template<typename DerivedPolicy,
+         typename InputIterator1,
+         typename InputIterator2,
+         typename OutputIterator,
+         typename StrictWeakOrdering>
+  OutputIterator set_intersection(execution_policy<DerivedPolicy> &exec,
+                                  InputIterator1 first1,
+                                  InputIterator1 last1,
+                                  InputIterator2 first2,
+                                  InputIterator2 last2,
+                                  OutputIterator result,
+                                  StrictWeakOrdering comp)
+{
+  return thrust::system::detail::internal::parallel_set_operation(exec, first1, last1, first2, last2, result, comp,
+                                                                  thrust::system::detail::internal::set_intersection_op(),
+                                                                  set_operations_detail::max_partitions(exec, thrust::distance(first1, last1) + thrust::distance(first2, last2)));
+} // end set_intersection()
+
+
+template<typename DerivedPolicy,
+         typename InputIterator1,
+         typename InputIterator2,
+         typename OutputIterator,
+         typename StrictWeakOrdering>
+  OutputIterator set_symmetric_difference(execution_policy<DerivedPolicy> &exec,
+                                          InputIterator1 first1,
+                                          InputIterator1 last1,
+                                          InputIterator2 first2,
+                                          InputIterator2 last2,
+                                          OutputIterator result,
+                                          StrictWeakOrdering comp)
+{
+  return thrust::system::detail::internal::parallel_set_operation(exec, first1, last1, first2, last2, result, comp,
+                                                                  thrust::system::detail::internal::set_symmetric_difference_op(),
+                                                                  set_operations_detail::max_partitions(exec, thrust::distance(first1, last1) + thrust::distance(first2, last2)));
+} // end set_symmetric_difference()
+
+
+template<typename DerivedPolicy,
+         typename InputIterator1,
+         typename InputIterator2,
+         typename OutputIterator,
+         typename StrictWeakOrdering>
+  OutputIterator set_union(execution_policy<DerivedPolicy> &exec,
+                           InputIterator1 first1,
+                           InputIterator1 last1,
+                           InputIterator2 first2,
+                           InputIterator2 last2,
+                           OutputIterator result,
+                           StrictWeakOrdering comp)
+{
+  return thrust::system::detail::internal::parallel_set_operation(exec, first1, last1, first2, last2, result, comp,
+                                                                  thrust::system::detail::internal::set_union_op(),
+                                                                  set_operations_detail::max_partitions(exec, thrust::distance(first1, last1) + thrust::distance(first2, last2)));
+} // end set_union()
+
+
+} // end namespace detail
+} // end namespace omp
+} // end namespace system
+THRUST_NAMESPACE_END
+
@@ -27,6 +27,24 @@ namespace omp
 namespace detail
 {
 
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+void sort(execution_policy<DerivedPolicy> &exec,
+          RandomAccessIterator first,
+          RandomAccessIterator last,
+          StrictWeakOrdering comp);
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+void sort_by_key(execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator1 keys_first,
+                 RandomAccessIterator1 keys_last,
+                 RandomAccessIterator2 values_first,
+                 StrictWeakOrdering comp);
+
 template<typename DerivedPolicy,
          typename RandomAccessIterator,
          typename StrictWeakOrdering>
@@ -1,5 +1,6 @@
 /*
  *  Copyright 2008-2013 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -25,9 +26,17 @@
 
 #include <thrust/iterator/iterator_traits.h>
 #include <thrust/system/omp/detail/default_decomposition.h>
+#include <thrust/system/omp/detail/merge.h>
+#include <thrust/system/omp/detail/execution_config.h>
+#include <thrust/system/omp/detail/pragma_omp.h>
 #include <thrust/system/detail/generic/select_system.h>
+#include <thrust/system/detail/internal/parallel_radix_sort.h>
+#include <thrust/system/detail/internal/sort_columns_by_key.h>
+#include <thrust/system/detail/sequential/sort.h>
+#include <thrust/detail/type_traits.h>
+#include <thrust/functional.h>
 #include <thrust/sort.h>
-#include <thrust/merge.h>
+#include <thrust/copy.h>
 #include <thrust/detail/seq.h>
 #include <thrust/detail/temporary_array.h>
 
@@ -42,65 +51,165 @@ namespace sort_detail
 {
 
 
+// returns the index of the first element of run r, where each run
+// covers width consecutive tiles of decomp
+template<typename Decomposition>
+typename Decomposition::index_type
+  run_begin(const Decomposition &decomp,
+            typename Decomposition::index_type width,
+            typename Decomposition::index_type r)
+{
+  typedef typename Decomposition::index_type IndexType;
+
+  IndexType tile = r * width;
+
+  return (tile < decomp.size()) ? decomp[tile].begin() : decomp[decomp.size() - 1].end();
+}
+
+
+// merges each pair of adjacent sorted runs of src into dst
+// every pair is split along its merge path into enough pieces to occupy
+// all tiles, so the final levels of the merge tree do not collapse to a
+// single thread
 template<typename DerivedPolicy,
-         typename RandomAccessIterator,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename Decomposition,
          typename StrictWeakOrdering>
-void inplace_merge(execution_policy<DerivedPolicy> &exec,
-                   RandomAccessIterator first,
-                   RandomAccessIterator middle,
-                   RandomAccessIterator last,
-                   StrictWeakOrdering comp)
+void merge_runs(execution_policy<DerivedPolicy> &exec,
+                RandomAccessIterator1 src,
+                RandomAccessIterator2 dst,
+                const Decomposition &decomp,
+                typename Decomposition::index_type width,
+                StrictWeakOrdering comp)
 {
-  typedef typename thrust::iterator_value<RandomAccessIterator>::type value_type;
+  typedef typename Decomposition::index_type IndexType;
 
-  thrust::detail::temporary_array<value_type,DerivedPolicy> a(exec, first, middle);
-  thrust::detail::temporary_array<value_type,DerivedPolicy> b(exec, middle, last);
+  const IndexType num_runs   = (decomp.size() + width - 1) / width;
+  const IndexType num_pairs  = (num_runs + 1) / 2;
+  const IndexType num_pieces = (decomp.size() + num_pairs - 1) / num_pairs;
 
-  thrust::merge(thrust::seq, a.begin(), a.end(), b.begin(), b.end(), first, comp);
+  scoped_schedule loop_schedule(exec);
+
+  THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
+  for(IndexType i = 0; i < num_pairs * num_pieces; i++)
+  {
+    IndexType pair  = i / num_pieces;
+    IndexType piece = i % num_pieces;
+
+    IndexType begin  = run_begin(decomp, width, 2 * pair);
+    IndexType middle = run_begin(decomp, width, 2 * pair + 1);
+    IndexType end    = run_begin(decomp, width, 2 * pair + 2);
+
+    thrust::system::detail::internal::uniform_decomposition<IndexType> pieces(end - begin, 1, num_pieces);
+
+    if(piece < pieces.size())
+    {
+      merge_detail::merge_diagonals(src + begin, middle - begin,
+                                    src + middle, end - middle,
+                                    dst + begin,
+                                    pieces[piece].begin(), pieces[piece].end(),
+                                    comp);
+    }
+  }
 }
 
 
 template<typename DerivedPolicy,
          typename RandomAccessIterator1,
          typename RandomAccessIterator2,
+         typename RandomAccessIterator3,
+         typename RandomAccessIterator4,
+         typename Decomposition,
          typename StrictWeakOrdering>
-void inplace_merge_by_key(execution_policy<DerivedPolicy> &exec,
-                          RandomAccessIterator1 first1,
-                          RandomAccessIterator1 middle1,
-                          RandomAccessIterator1 last1,
-                          RandomAccessIterator2 first2,
-                          StrictWeakOrdering comp)
+void merge_runs_by_key(execution_policy<DerivedPolicy> &exec,
+                       RandomAccessIterator1 keys_src,
+                       RandomAccessIterator2 values_src,
+                       RandomAccessIterator3 keys_dst,
+                       RandomAccessIterator4 values_dst,
+                       const Decomposition &decomp,
+                       typename Decomposition::index_type width,
+                       StrictWeakOrdering comp)
 {
-  typedef typename thrust::iterator_value<RandomAccessIterator1>::type value_type1;
-  typedef typename thrust::iterator_value<RandomAccessIterator2>::type value_type2;
-
-  RandomAccessIterator2 middle2 = first2 + (middle1 - first1);
-  RandomAccessIterator2 last2   = first2 + (last1   - first1);
-
-  thrust::detail::temporary_array<value_type1,DerivedPolicy> lhs1(exec, first1, middle1);
-  thrust::detail::temporary_array<value_type1,DerivedPolicy> rhs1(exec, middle1, last1);
-  thrust::detail::temporary_array<value_type2,DerivedPolicy> lhs2(exec, first2, middle2);
-  thrust::detail::temporary_array<value_type2,DerivedPolicy> rhs2(exec, middle2, last2);
-
-  thrust::merge_by_key(thrust::seq,
-                       lhs1.begin(), lhs1.end(),
-                       rhs1.begin(), rhs1.end(),
-                       lhs2.begin(), rhs2.begin(),
-                       first1, first2,
-                       comp);
+  typedef typename Decomposition::index_type IndexType;
+
+  const IndexType num_runs   = (decomp.size() + width - 1) / width;
+  const IndexType num_pairs  = (num_runs + 1) / 2;
+  const IndexType num_pieces = (decomp.size() + num_pairs - 1) / num_pairs;
+
+  scoped_schedule loop_schedule(exec);
+
+  THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
+  for(IndexType i = 0; i < num_pairs * num_pieces; i++)
+  {
+    IndexType pair  = i / num_pieces;
+    IndexType piece = i % num_pieces;
+
+    IndexType begin  = run_begin(decomp, width, 2 * pair);
+    IndexType middle = run_begin(decomp, width, 2 * pair + 1);
+    IndexType end    = run_begin(decomp, width, 2 * pair + 2);
+
+    thrust::system::detail::internal::uniform_decomposition<IndexType> pieces(end - begin, 1, num_pieces);
+
+    if(piece < pieces.size())
+    {
+      merge_detail::merge_by_key_diagonals(keys_src + begin, middle - begin,
+                                           keys_src + middle, end - middle,
+                                           values_src + begin,
+                                           values_src + middle,
+                                           keys_dst + begin,
+                                           values_dst + begin,
+                                           pieces[piece].begin(), pieces[piece].end(),
+                                           comp);
+    }
+  }
 }
 
 
-} // end sort_detail
+// the sequential sorts of the individual tiles, the merges above them are
+// stable, so the result is stable if the tiles are sorted stably
+struct stable_sort_tile
+{
+  template<typename RandomAccessIterator, typename StrictWeakOrdering>
+  void operator()(RandomAccessIterator first, RandomAccessIterator last, StrictWeakOrdering comp) const
+  {
+    thrust::stable_sort(thrust::seq, first, last, comp);
+  }
+
+  template<typename RandomAccessIterator1, typename RandomAccessIterator2, typename StrictWeakOrdering>
+  void operator()(RandomAccessIterator1 keys_first, RandomAccessIterator1 keys_last, RandomAccessIterator2 values_first, StrictWeakOrdering comp) const
+  {
+    thrust::stable_sort_by_key(thrust::seq, keys_first, keys_last, values_first, comp);
+  }
+};
+
+
+// sorts the tiles in place with the sequential unstable sort
+struct sort_tile
+{
+  template<typename RandomAccessIterator, typename StrictWeakOrdering>
+  void operator()(RandomAccessIterator first, RandomAccessIterator last, StrictWeakOrdering comp) const
+  {
+    thrust::sort(thrust::seq, first, last, comp);
+  }
+
+  template<typename RandomAccessIterator1, typename RandomAccessIterator2, typename StrictWeakOrdering>
+  void operator()(RandomAccessIterator1 keys_first, RandomAccessIterator1 keys_last, RandomAccessIterator2 values_first, StrictWeakOrdering comp) const
+  {
+    thrust::sort_by_key(thrust::seq, keys_first, keys_last, values_first, comp);
+  }
+};
 
 
 template<typename DerivedPolicy,
          typename RandomAccessIterator,
-         typename StrictWeakOrdering>
-void stable_sort(execution_policy<DerivedPolicy> &exec,
-                 RandomAccessIterator first,
-                 RandomAccessIterator last,
-                 StrictWeakOrdering comp)
+         typename StrictWeakOrdering,
+         typename TileSort>
+void merge_sort(execution_policy<DerivedPolicy> &exec,
+                RandomAccessIterator first,
+                RandomAccessIterator last,
+                StrictWeakOrdering comp,
+                TileSort tile_sort)
 {
   // we're attempting to launch an omp kernel, assert we're compiling with omp support
   // ========================================================================
@@ -114,67 +223,167 @@ void stable_sort(execution_policy<DerivedPolicy> &exec,
   , "OpenMP compiler support is not enabled"
   );
 
-  // Avoid issues on compilers that don't provide `omp_get_num_threads()`.
+  // Avoid issues on compilers that don't provide `omp_get_max_threads()`.
 #if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type      value_type;
   typedef typename thrust::iterator_difference<RandomAccessIterator>::type IndexType;
 
   if(first == last)
     return;
 
-  THRUST_PRAGMA_OMP(parallel)
+  thrust::system::detail::internal::uniform_decomposition<IndexType> decomp(last - first, 1, max_threads(exec));
+
+  const IndexType num_tiles = decomp.size();
+
+  scoped_schedule loop_schedule(exec);
+
+  // every thread sorts its own tile
+  THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
+  for(IndexType i = 0; i < num_tiles; i++)
+  {
+    tile_sort(first + decomp[i].begin(),
+              first + decomp[i].end(),
+              comp);
+  }
+
+  if(num_tiles == 1)
+    return;
+
+  // merge runs of tiles pairwise, alternating between the input and a buffer
+  thrust::detail::temporary_array<value_type,DerivedPolicy> buffer(exec, last - first);
+
+  bool result_in_buffer = false;
+
+  for(IndexType width = 1; width < num_tiles; width *= 2)
   {
-    thrust::system::detail::internal::uniform_decomposition<IndexType> decomp(last - first, 1, omp_get_num_threads());
+    if(result_in_buffer)
+      sort_detail::merge_runs(exec, buffer.begin(), first, decomp, width, comp);
+    else
+      sort_detail::merge_runs(exec, first, buffer.begin(), decomp, width, comp);
 
-    // process id
-    IndexType p_i = omp_get_thread_num();
+    result_in_buffer = !result_in_buffer;
+  }
 
-    // every thread sorts its own tile
-    if(p_i < decomp.size())
+  if(result_in_buffer)
+  {
+    THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
+    for(IndexType i = 0; i < num_tiles; i++)
     {
-      thrust::stable_sort(thrust::seq,
-                          first + decomp[p_i].begin(),
-                          first + decomp[p_i].end(),
-                          comp);
+      thrust::copy(thrust::seq,
+                   buffer.begin() + decomp[i].begin(),
+                   buffer.begin() + decomp[i].end(),
+                   first + decomp[i].begin());
     }
+  }
+#endif // THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering,
+         typename TileSort>
+void merge_sort_by_key(execution_policy<DerivedPolicy> &exec,
+                       RandomAccessIterator1 keys_first,
+                       RandomAccessIterator1 keys_last,
+                       RandomAccessIterator2 values_first,
+                       StrictWeakOrdering comp,
+                       TileSort tile_sort)
+{
+  // we're attempting to launch an omp kernel, assert we're compiling with omp support
+  // ========================================================================
+  // X Note to the user: If you've found this line due to a compiler error, X
+  // X you need to enable OpenMP support in your compiler.                  X
+  // ========================================================================
+  THRUST_STATIC_ASSERT_MSG(
+    (thrust::detail::depend_on_instantiation<
+      RandomAccessIterator1, (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+    >::value)
+  , "OpenMP compiler support is not enabled"
+  );
+
+  // Avoid issues on compilers that don't provide `omp_get_max_threads()`.
+#if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+  typedef typename thrust::iterator_value<RandomAccessIterator1>::type      value_type1;
+  typedef typename thrust::iterator_value<RandomAccessIterator2>::type      value_type2;
+  typedef typename thrust::iterator_difference<RandomAccessIterator1>::type IndexType;
 
-    THRUST_PRAGMA_OMP(barrier)
+  if(keys_first == keys_last)
+    return;
 
-    // XXX For some reason, MSVC 2015 yields an error unless we include this meaningless semicolon here
-    ;
+  thrust::system::detail::internal::uniform_decomposition<IndexType> decomp(keys_last - keys_first, 1, max_threads(exec));
 
-    IndexType nseg = decomp.size();
-    IndexType h = 2;
+  const IndexType num_tiles = decomp.size();
 
-    // keep track of which sub-range we're processing
-    IndexType a=p_i, b=p_i, c=p_i+1;
+  scoped_schedule loop_schedule(exec);
 
-    while(nseg>1)
-    {
-      if(c >= decomp.size())
-        c = decomp.size() - 1;
+  // every thread sorts its own tile
+  THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
+  for(IndexType i = 0; i < num_tiles; i++)
+  {
+    tile_sort(keys_first + decomp[i].begin(),
+              keys_first + decomp[i].end(),
+              values_first + decomp[i].begin(),
+              comp);
+  }
 
-      if((p_i % h) == 0 && c > b)
-      {
-        sort_detail::inplace_merge(exec,
-                                   first + decomp[a].begin(),
-                                   first + decomp[b].end(),
-                                   first + decomp[c].end(),
-                                   comp);
+  if(num_tiles == 1)
+    return;
 
-        b = c;
-        c += h;
-      }
+  // merge runs of tiles pairwise, alternating between the input and a buffer
+  thrust::detail::temporary_array<value_type1,DerivedPolicy> keys_buffer(exec, keys_last - keys_first);
+  thrust::detail::temporary_array<value_type2,DerivedPolicy> values_buffer(exec, keys_last - keys_first);
 
-      nseg = (nseg + 1) / 2;
-      h *= 2;
+  bool result_in_buffer = false;
 
-      THRUST_PRAGMA_OMP(barrier)
+  for(IndexType width = 1; width < num_tiles; width *= 2)
+  {
+    if(result_in_buffer)
+      sort_detail::merge_runs_by_key(exec, keys_buffer.begin(), values_buffer.begin(),
+                                     keys_first, values_first,
+                                     decomp, width, comp);
+    else
+      sort_detail::merge_runs_by_key(exec, keys_first, values_first,
+                                     keys_buffer.begin(), values_buffer.begin(),
+                                     decomp, width, comp);
+
+    result_in_buffer = !result_in_buffer;
+  }
+
+  if(result_in_buffer)
+  {
+    THRUST_PRAGMA_OMP(parallel for num_threads(max_threads(exec)) schedule(runtime))
+    for(IndexType i = 0; i < num_tiles; i++)
+    {
+      thrust::copy(thrust::seq,
+                   keys_buffer.begin() + decomp[i].begin(),
+                   keys_buffer.begin() + decomp[i].end(),
+                   keys_first + decomp[i].begin());
+
+      thrust::copy(thrust::seq,
+                   values_buffer.begin() + decomp[i].begin(),
+                   values_buffer.begin() + decomp[i].end(),
+                   values_first + decomp[i].begin());
     }
   }
 #endif // THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE
 }
 
 
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+void stable_sort(execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator first,
+                 RandomAccessIterator last,
+                 StrictWeakOrdering comp,
+                 thrust::detail::false_type)
+{
+  sort_detail::merge_sort(exec, first, last, comp, stable_sort_tile());
+}
+
+
 template<typename DerivedPolicy,
          typename RandomAccessIterator1,
          typename RandomAccessIterator2,
@@ -183,7 +392,25 @@ void stable_sort_by_key(execution_policy<DerivedPolicy> &exec,
                         RandomAccessIterator1 keys_first,
                         RandomAccessIterator1 keys_last,
                         RandomAccessIterator2 values_first,
-                        StrictWeakOrdering comp)
+                        StrictWeakOrdering comp,
+                        thrust::detail::false_type)
+{
+  sort_detail::merge_sort_by_key(exec, keys_first, keys_last, values_first, comp, stable_sort_tile());
+}
+
+
+// below this size the sequential radix sort beats the parallel one
+const static int radix_sort_threshold = 64 * 1024;
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+void stable_sort(execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator first,
+                 RandomAccessIterator last,
+                 StrictWeakOrdering comp,
+                 thrust::detail::true_type)
 {
   // we're attempting to launch an omp kernel, assert we're compiling with omp support
   // ========================================================================
@@ -192,74 +419,273 @@ void stable_sort_by_key(execution_policy<DerivedPolicy> &exec,
   // ========================================================================
   THRUST_STATIC_ASSERT_MSG(
     (thrust::detail::depend_on_instantiation<
-      RandomAccessIterator1, (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+      RandomAccessIterator, (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
     >::value)
   , "OpenMP compiler support is not enabled"
   );
 
-  // Avoid issues on compilers that don't provide `omp_get_num_threads()`.
+  // Avoid issues on compilers that don't provide `omp_get_max_threads()`.
 #if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
-  typedef typename thrust::iterator_difference<RandomAccessIterator1>::type IndexType;
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type      KeyType;
+  typedef typename thrust::iterator_difference<RandomAccessIterator>::type IndexType;
 
-  if(keys_first == keys_last)
-    return;
+  const IndexType num_threads = max_threads(exec);
 
-  THRUST_PRAGMA_OMP(parallel)
+  if(last - first < radix_sort_threshold || num_threads == 1)
   {
-    thrust::system::detail::internal::uniform_decomposition<IndexType> decomp(keys_last - keys_first, 1, omp_get_num_threads());
+    thrust::stable_sort(thrust::seq, first, last, comp);
+    return;
+  }
 
-    // process id
-    IndexType p_i = omp_get_thread_num();
+  const bool descending = thrust::detail::is_same<StrictWeakOrdering, thrust::greater<KeyType> >::value;
 
-    // every thread sorts its own tile
-    if(p_i < decomp.size())
-    {
-      thrust::stable_sort_by_key(thrust::seq,
-                                 keys_first + decomp[p_i].begin(),
-                                 keys_first + decomp[p_i].end(),
-                                 values_first + decomp[p_i].begin(),
-                                 comp);
-    }
+  thrust::system::detail::internal::parallel_radix_sort<descending>(exec, first, last, num_threads);
+#endif // THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE
+}
 
-    THRUST_PRAGMA_OMP(barrier)
 
-    // XXX For some reason, MSVC 2015 yields an error unless we include this meaningless semicolon here
-    ;
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+void stable_sort_by_key(execution_policy<DerivedPolicy> &exec,
+                        RandomAccessIterator1 keys_first,
+                        RandomAccessIterator1 keys_last,
+                        RandomAccessIterator2 values_first,
+                        StrictWeakOrdering comp,
+                        thrust::detail::true_type)
+{
+  // we're attempting to launch an omp kernel, assert we're compiling with omp support
+  // ========================================================================
+  // X Note to the user: If you've found this line due to a compiler error, X
+  // X you need to enable OpenMP support in your compiler.                  X
+  // ========================================================================
+  THRUST_STATIC_ASSERT_MSG(
+    (thrust::detail::depend_on_instantiation<
+      RandomAccessIterator1, (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+    >::value)
+  , "OpenMP compiler support is not enabled"
+  );
 
-    IndexType nseg = decomp.size();
-    IndexType h = 2;
+  // Avoid issues on compilers that don't provide `omp_get_max_threads()`.
+#if (THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE == THRUST_TRUE)
+  typedef typename thrust::iterator_value<RandomAccessIterator1>::type      KeyType;
+  typedef typename thrust::iterator_difference<RandomAccessIterator1>::type IndexType;
 
-    // keep track of which sub-range we're processing
-    IndexType a=p_i, b=p_i, c=p_i+1;
+  const IndexType num_threads = max_threads(exec);
 
-    while(nseg>1)
-    {
-      if(c >= decomp.size())
-        c = decomp.size() - 1;
-
-      if((p_i % h) == 0 && c > b)
-      {
-        sort_detail::inplace_merge_by_key(exec,
-                                          keys_first + decomp[a].begin(),
-                                          keys_first + decomp[b].end(),
-                                          keys_first + decomp[c].end(),
-                                          values_first + decomp[a].begin(),
-                                          comp);
-
-        b = c;
-        c += h;
-      }
-
-      nseg = (nseg + 1) / 2;
-      h *= 2;
-
-      THRUST_PRAGMA_OMP(barrier)
-    }
+  if(keys_last - keys_first < radix_sort_threshold || num_threads == 1)
+  {
+    thrust::stable_sort_by_key(thrust::seq, keys_first, keys_last, values_first, comp);
+    return;
   }
+
+  const bool descending = thrust::detail::is_same<StrictWeakOrdering, thrust::greater<KeyType> >::value;
+
+  thrust::system::detail::internal::parallel_radix_sort_by_key<descending>(exec, keys_first, keys_last, values_first, num_threads);
 #endif // THRUST_DEVICE_COMPILER_IS_OMP_CAPABLE
 }
 
 
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+void sort(execution_policy<DerivedPolicy> &exec,
+          RandomAccessIterator first,
+          RandomAccessIterator last,
+          StrictWeakOrdering comp,
+          thrust::detail::true_type)
+{
+  sort_detail::stable_sort(exec, first, last, comp, thrust::detail::true_type());
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+void sort_by_key(execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator1 keys_first,
+                 RandomAccessIterator1 keys_last,
+                 RandomAccessIterator2 values_first,
+                 StrictWeakOrdering comp,
+                 thrust::detail::true_type)
+{
+  sort_detail::stable_sort_by_key(exec, keys_first, keys_last, values_first, comp, thrust::detail::true_type());
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+void sort(execution_policy<DerivedPolicy> &exec,
+          RandomAccessIterator first,
+          RandomAccessIterator last,
+          StrictWeakOrdering comp,
+          thrust::detail::false_type)
+{
+  sort_detail::merge_sort(exec, first, last, comp, sort_tile());
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+void sort_by_key(execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator1 keys_first,
+                 RandomAccessIterator1 keys_last,
+                 RandomAccessIterator2 values_first,
+                 StrictWeakOrdering comp,
+                 thrust::detail::false_type)
+{
+  sort_detail::merge_sort_by_key(exec, keys_first, keys_last, values_first, comp, sort_tile());
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+void dispatch_stable_sort_by_key(execution_policy<DerivedPolicy> &exec,
+                                 RandomAccessIterator1 keys_first,
+                                 RandomAccessIterator1 keys_last,
+                                 RandomAccessIterator2 values_first,
+                                 StrictWeakOrdering comp,
+                                 thrust::detail::false_type /* columns */)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator1>::type KeyType;
+
+  // radix sort arithmetic keys compared with less or greater, merge sort everything else
+  thrust::system::detail::sequential::sort_detail::use_primitive_sort<KeyType,StrictWeakOrdering> use_primitive_sort;
+
+  sort_detail::stable_sort_by_key(exec, keys_first, keys_last, values_first, comp, use_primitive_sort);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+void dispatch_stable_sort_by_key(execution_policy<DerivedPolicy> &exec,
+                                 RandomAccessIterator1 keys_first,
+                                 RandomAccessIterator1 keys_last,
+                                 RandomAccessIterator2 values_first,
+                                 StrictWeakOrdering comp,
+                                 thrust::detail::true_type /* columns */)
+{
+  thrust::system::detail::internal::sort_columns_by_key(exec, keys_first, keys_last, values_first, comp, thrust::detail::true_type());
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+void dispatch_sort_by_key(execution_policy<DerivedPolicy> &exec,
+                          RandomAccessIterator1 keys_first,
+                          RandomAccessIterator1 keys_last,
+                          RandomAccessIterator2 values_first,
+                          StrictWeakOrdering comp,
+                          thrust::detail::false_type /* columns */)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator1>::type KeyType;
+
+  // radix sort arithmetic keys compared with less or greater, merge tiles sorted with quicksort otherwise
+  thrust::system::detail::sequential::sort_detail::use_primitive_sort<KeyType,StrictWeakOrdering> use_primitive_sort;
+
+  sort_detail::sort_by_key(exec, keys_first, keys_last, values_first, comp, use_primitive_sort);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+void dispatch_sort_by_key(execution_policy<DerivedPolicy> &exec,
+                          RandomAccessIterator1 keys_first,
+                          RandomAccessIterator1 keys_last,
+                          RandomAccessIterator2 values_first,
+                          StrictWeakOrdering comp,
+                          thrust::detail::true_type /* columns */)
+{
+  thrust::system::detail::internal::sort_columns_by_key(exec, keys_first, keys_last, values_first, comp, thrust::detail::false_type());
+}
+
+
+} // end sort_detail
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+void stable_sort(execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator first,
+                 RandomAccessIterator last,
+                 StrictWeakOrdering comp)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type KeyType;
+
+  // radix sort arithmetic keys compared with less or greater, merge sort everything else
+  thrust::system::detail::sequential::sort_detail::use_primitive_sort<KeyType,StrictWeakOrdering> use_primitive_sort;
+
+  sort_detail::stable_sort(exec, first, last, comp, use_primitive_sort);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+void stable_sort_by_key(execution_policy<DerivedPolicy> &exec,
+                        RandomAccessIterator1 keys_first,
+                        RandomAccessIterator1 keys_last,
+                        RandomAccessIterator2 values_first,
+                        StrictWeakOrdering comp)
+{
+  // values stored as columns, such as those of a soa_vector, are sorted through
+  // a sort of their indices, and gathered once
+  thrust::system::detail::internal::is_sort_by_key_columns<RandomAccessIterator2> columns;
+
+  sort_detail::dispatch_stable_sort_by_key(exec, keys_first, keys_last, values_first, comp, columns);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+void sort(execution_policy<DerivedPolicy> &exec,
+          RandomAccessIterator first,
+          RandomAccessIterator last,
+          StrictWeakOrdering comp)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type KeyType;
+
+  // radix sort arithmetic keys compared with less or greater, merge tiles sorted with quicksort otherwise
+  thrust::system::detail::sequential::sort_detail::use_primitive_sort<KeyType,StrictWeakOrdering> use_primitive_sort;
+
+  sort_detail::sort(exec, first, last, comp, use_primitive_sort);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+void sort_by_key(execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator1 keys_first,
+                 RandomAccessIterator1 keys_last,
+                 RandomAccessIterator2 values_first,
+                 StrictWeakOrdering comp)
+{
+  // values stored as columns, such as those of a soa_vector, are sorted through
+  // a sort of their indices, and gathered once
+  thrust::system::detail::internal::is_sort_by_key_columns<RandomAccessIterator2> columns;
+
+  sort_detail::dispatch_sort_by_key(exec, keys_first, keys_last, values_first, comp, columns);
+}
+
+
 } // end namespace detail
 } // end namespace omp
 } // end namespace system
@@ -19,6 +19,9 @@
 #include <thrust/detail/config.h>
 #include <thrust/system/omp/detail/unique.h>
 #include <thrust/system/detail/generic/unique.h>
+#include <thrust/system/omp/detail/default_decomposition.h>
+#include <thrust/system/detail/internal/parallel_compact.h>
+#include <thrust/distance.h>
 #include <thrust/pair.h>
 
 THRUST_NAMESPACE_BEGIN
@@ -28,6 +31,19 @@ namespace omp
 {
 namespace detail
 {
+namespace unique_detail
+{
+
+
+// one tile per tile of the default decomposition
+template<typename DerivedPolicy, typename Size>
+Size max_tiles(execution_policy<DerivedPolicy> &exec, Size n)
+{
+  return thrust::system::omp::detail::default_decomposition(exec, n).size();
+}
+
+
+} // end namespace unique_detail
 
 
 template<typename DerivedPolicy,
@@ -38,8 +54,9 @@ template<typename DerivedPolicy,
                          ForwardIterator last,
                          BinaryPredicate binary_pred)
 {
-  // omp prefers generic::unique to cpp::unique
-  return thrust::system::detail::generic::unique(exec,first,last,binary_pred);
+  // compact in place rather than through a copy of the input
+  return thrust::system::detail::internal::parallel_unique(exec, first, last, binary_pred,
+                                                           unique_detail::max_tiles(exec, thrust::distance(first, last)));
 } // end unique()
 
 
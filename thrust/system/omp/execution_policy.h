@@ -139,6 +139,21 @@ struct tag : thrust::system::omp::execution_policy<tag> { unspecified };
  *
  *  // 0 1 2 is printed to standard output in some unspecified order
  *  \endcode
+ *
+ *  \p thrust::omp::par may be tuned with modifiers, each of which returns a new policy and may be
+ *  chained, also after attaching an allocator with <tt>thrust::omp::par(alloc)</tt>:
+ *
+ *  - <tt>.num_threads(k)</tt> runs every parallel region of the algorithm with \p k threads and
+ *    splits the tiled algorithms into at most \p k tiles. By default the regions use OpenMP's
+ *    default team size and the tiled algorithms one tile per processor.
+ *  - <tt>.schedule(kind, chunk)</tt> selects the schedule of the parallel loops, one of
+ *    \p thrust::omp::schedule_kind::static_ (the default), \p dynamic, \p guided or \p auto_,
+ *    with an optional chunk size. The schedule set with \p omp_set_schedule is left untouched.
+ *
+ *  \code
+ *  thrust::for_each(thrust::omp::par.num_threads(4).schedule(thrust::omp::schedule_kind::dynamic, 64),
+ *                   vec.begin(), vec.end(), printf_functor());
+ *  \endcode
  */
 static const unspecified par;
 
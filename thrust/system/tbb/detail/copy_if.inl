@@ -19,6 +19,7 @@
 #include <thrust/detail/config.h>
 #include <thrust/detail/function.h>
 #include <thrust/system/tbb/detail/copy_if.h>
+#include <thrust/system/tbb/detail/execution_config.h>
 #include <thrust/iterator/iterator_traits.h>
 #include <thrust/distance.h>
 #include <tbb/blocked_range.h>
@@ -97,11 +98,12 @@ struct body
 
 } // end copy_if_detail
 
-template<typename InputIterator1,
+template<typename DerivedPolicy,
+         typename InputIterator1,
          typename InputIterator2,
          typename OutputIterator,
          typename Predicate>
-  OutputIterator copy_if(tag,
+  OutputIterator copy_if(execution_policy<DerivedPolicy> &exec,
                          InputIterator1 first,
                          InputIterator1 last,
                          InputIterator2 stencil,
@@ -116,7 +118,7 @@ template<typename InputIterator1,
   if (n != 0)
   {
     Body body(first, stencil, result, pred);
-    ::tbb::parallel_scan(::tbb::blocked_range<Size>(0,n), body);
+    thrust::system::tbb::detail::parallel_scan(exec, thrust::system::tbb::detail::make_blocked_range(exec, n), body);
     thrust::advance(result, body.sum);
   }
 
@@ -0,0 +1,192 @@
+/*
+ *  Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*! \file execution_config.h
+ *  \brief The task arena, grain size and partitioner attached to a TBB
+ *         execution policy, and the TBB entry points which honour them.
+ */
+
+#pragma once
+
+#include <thrust/detail/config.h>
+#include <thrust/system/tbb/detail/execution_policy.h>
+#include <thrust/detail/execution_policy.h>
+#include <thrust/detail/minmax.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_scan.h>
+#include <tbb/partitioner.h>
+#include <tbb/task_arena.h>
+
+#include <cstddef>
+
+THRUST_NAMESPACE_BEGIN
+namespace system
+{
+namespace tbb
+{
+namespace detail
+{
+
+
+enum partitioner_kind
+{
+  auto_partitioner_kind,
+  simple_partitioner_kind,
+  static_partitioner_kind,
+  affinity_partitioner_kind
+};
+
+
+struct execution_config
+{
+  // the arena to run in, or null for the calling thread's arena
+  ::tbb::task_arena *arena;
+
+  std::size_t grain_size;
+
+  partitioner_kind partitioner;
+
+  // the state of affinity_partitioner_kind, owned by the caller
+  ::tbb::affinity_partitioner *affinity;
+
+  execution_config()
+    : arena(0), grain_size(1), partitioner(auto_partitioner_kind), affinity(0)
+  {}
+};
+
+
+// policies without modifiers run in the calling thread's arena with TBB's defaults
+template<typename DerivedPolicy>
+execution_config get_config(const execution_policy<DerivedPolicy> &)
+{
+  return execution_config();
+}
+
+
+template<typename DerivedPolicy>
+execution_config config_of(execution_policy<DerivedPolicy> &exec)
+{
+  return get_config(thrust::detail::derived_cast(exec));
+}
+
+
+// the number of workers available to exec
+template<typename DerivedPolicy>
+int max_concurrency(execution_policy<DerivedPolicy> &exec)
+{
+  const execution_config config = config_of(exec);
+
+  return config.arena ? config.arena->max_concurrency() : ::tbb::this_task_arena::max_concurrency();
+}
+
+
+// invokes f inside exec's arena
+template<typename DerivedPolicy, typename Function>
+void execute(execution_policy<DerivedPolicy> &exec, const Function &f)
+{
+  const execution_config config = config_of(exec);
+
+  if(config.arena)
+  {
+    config.arena->execute(f);
+  }
+  else
+  {
+    f();
+  }
+}
+
+
+// [0, n) split no finer than exec's grain size
+// the grain size is capped so that the loop still spreads over every worker,
+// otherwise it would serialize the per-tile loops of the tiled algorithms
+template<typename DerivedPolicy, typename Size>
+::tbb::blocked_range<Size> make_blocked_range(execution_policy<DerivedPolicy> &exec, Size n)
+{
+  const std::size_t workers = static_cast<std::size_t>(thrust::max<int>(1, max_concurrency(exec)));
+  const std::size_t per_worker = (static_cast<std::size_t>(n) + workers - 1) / workers;
+
+  const std::size_t grain_size = thrust::max<std::size_t>(1, thrust::min<std::size_t>(config_of(exec).grain_size, per_worker));
+
+  return ::tbb::blocked_range<Size>(0, n, grain_size);
+}
+
+
+template<typename DerivedPolicy, typename Range, typename Body>
+void parallel_for(execution_policy<DerivedPolicy> &exec, const Range &range, const Body &body)
+{
+  const execution_config config = config_of(exec);
+
+  execute(exec, [&]
+  {
+    switch(config.partitioner)
+    {
+      case simple_partitioner_kind:   ::tbb::parallel_for(range, body, ::tbb::simple_partitioner()); break;
+      case static_partitioner_kind:   ::tbb::parallel_for(range, body, ::tbb::static_partitioner()); break;
+      case affinity_partitioner_kind: ::tbb::parallel_for(range, body, *config.affinity);            break;
+      default:                        ::tbb::parallel_for(range, body, ::tbb::auto_partitioner());   break;
+    }
+  });
+}
+
+
+template<typename DerivedPolicy, typename Range, typename Body>
+void parallel_reduce(execution_policy<DerivedPolicy> &exec, const Range &range, Body &body)
+{
+  const execution_config config = config_of(exec);
+
+  execute(exec, [&]
+  {
+    switch(config.partitioner)
+    {
+      case simple_partitioner_kind:   ::tbb::parallel_reduce(range, body, ::tbb::simple_partitioner()); break;
+      case static_partitioner_kind:   ::tbb::parallel_reduce(range, body, ::tbb::static_partitioner()); break;
+      case affinity_partitioner_kind: ::tbb::parallel_reduce(range, body, *config.affinity);            break;
+      default:                        ::tbb::parallel_reduce(range, body, ::tbb::auto_partitioner());   break;
+    }
+  });
+}
+
+
+// tbb::parallel_scan only accepts the simple and auto partitioners,
+// the static and affinity partitioners fall back to auto
+template<typename DerivedPolicy, typename Range, typename Body>
+void parallel_scan(execution_policy<DerivedPolicy> &exec, const Range &range, Body &body)
+{
+  const execution_config config = config_of(exec);
+
+  execute(exec, [&]
+  {
+    if(config.partitioner == simple_partitioner_kind)
+    {
+      ::tbb::parallel_scan(range, body, ::tbb::simple_partitioner());
+    }
+    else
+    {
+      ::tbb::parallel_scan(range, body, ::tbb::auto_partitioner());
+    }
+  });
+}
+
+
+} // end detail
+} // end tbb
+} // end system
+THRUST_NAMESPACE_END
+
@@ -1,5 +1,6 @@
 /*
  *  Copyright 2008-2013 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -21,7 +22,9 @@
 #include <thrust/distance.h>
 #include <thrust/iterator/iterator_traits.h>
 #include <thrust/distance.h>
+#include <thrust/for_each.h>
 #include <thrust/system/detail/sequential/execution_policy.h>
+#include <thrust/system/tbb/detail/execution_config.h>
 
 #include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
@@ -71,12 +74,12 @@ template<typename DerivedPolicy,
          typename RandomAccessIterator,
          typename Size,
          typename UnaryFunction>
-RandomAccessIterator for_each_n(execution_policy<DerivedPolicy> &,
+RandomAccessIterator for_each_n(execution_policy<DerivedPolicy> &exec,
                                 RandomAccessIterator first,
                                 Size n,
                                 UnaryFunction f)
 {
-  ::tbb::parallel_for(::tbb::blocked_range<Size>(0,n), for_each_detail::make_body<Size>(first,f));
+  thrust::system::tbb::detail::parallel_for(exec, thrust::system::tbb::detail::make_blocked_range(exec, n), for_each_detail::make_body<Size>(first,f));
 
   // return the end of the range
   return first + n;
@@ -19,6 +19,10 @@
 #include <thrust/detail/config.h>
 #include <thrust/detail/allocator_aware_execution_policy.h>
 #include <thrust/system/tbb/detail/execution_policy.h>
+#include <thrust/system/tbb/detail/execution_config.h>
+#include <thrust/detail/execution_policy.h>
+
+#include <cstddef>
 
 THRUST_NAMESPACE_BEGIN
 namespace system
@@ -29,12 +33,105 @@ namespace detail
 {
 
 
+// a policy carrying the arena, grain size and partitioner set by the
+// on(), grain() and partitioner() modifiers
+template<typename Derived>
+struct execute_with_config_base : thrust::system::tbb::detail::execution_policy<Derived>
+{
+private:
+  execution_config config;
+
+public:
+  execute_with_config_base()
+    : config()
+  {}
+
+  // runs the algorithm inside arena, which must outlive the call
+  Derived on(::tbb::task_arena &arena) const
+  {
+    Derived result = thrust::detail::derived_cast(*this);
+    result.config.arena = &arena;
+    return result;
+  }
+
+  // the minimum number of elements per task
+  Derived grain(std::size_t grain_size) const
+  {
+    Derived result = thrust::detail::derived_cast(*this);
+    result.config.grain_size = grain_size;
+    return result;
+  }
+
+  Derived partitioner(const ::tbb::auto_partitioner &) const
+  {
+    return with_partitioner(auto_partitioner_kind, 0);
+  }
+
+  Derived partitioner(const ::tbb::simple_partitioner &) const
+  {
+    return with_partitioner(simple_partitioner_kind, 0);
+  }
+
+  Derived partitioner(const ::tbb::static_partitioner &) const
+  {
+    return with_partitioner(static_partitioner_kind, 0);
+  }
+
+  // affinity must outlive the call, reuse it across calls to replay the mapping of tasks to threads
+  Derived partitioner(::tbb::affinity_partitioner &affinity) const
+  {
+    return with_partitioner(affinity_partitioner_kind, &affinity);
+  }
+
+private:
+  Derived with_partitioner(partitioner_kind kind, ::tbb::affinity_partitioner *affinity) const
+  {
+    Derived result = thrust::detail::derived_cast(*this);
+    result.config.partitioner = kind;
+    result.config.affinity    = affinity;
+    return result;
+  }
+
+  friend execution_config get_config(const execute_with_config_base &exec)
+  {
+    return exec.config;
+  }
+
+  template<typename> friend struct execute_with_config_base;
+};
+
+
+struct execute_with_config : execute_with_config_base<execute_with_config>
+{};
+
+
 struct par_t : thrust::system::tbb::detail::execution_policy<par_t>,
   thrust::detail::allocator_aware_execution_policy<
-    thrust::system::tbb::detail::execution_policy>
+    execute_with_config_base>
 {
   __host__ __device__
   constexpr par_t() : thrust::system::tbb::detail::execution_policy<par_t>() {}
+
+  execute_with_config on(::tbb::task_arena &arena) const
+  {
+    return execute_with_config().on(arena);
+  }
+
+  execute_with_config grain(std::size_t grain_size) const
+  {
+    return execute_with_config().grain(grain_size);
+  }
+
+  template<typename Partitioner>
+  execute_with_config partitioner(const Partitioner &p) const
+  {
+    return execute_with_config().partitioner(p);
+  }
+
+  execute_with_config partitioner(::tbb::affinity_partitioner &affinity) const
+  {
+    return execute_with_config().partitioner(affinity);
+  }
 };
 
 
@@ -23,6 +23,7 @@
 #include <thrust/iterator/iterator_traits.h>
 #include <thrust/distance.h>
 #include <thrust/reduce.h>
+#include <thrust/system/tbb/detail/execution_config.h>
 #include <tbb/blocked_range.h>
 #include <tbb/parallel_reduce.h>
 
@@ -99,7 +100,7 @@ template<typename DerivedPolicy,
          typename InputIterator, 
          typename OutputType,
          typename BinaryFunction>
-  OutputType reduce(execution_policy<DerivedPolicy> &,
+  OutputType reduce(execution_policy<DerivedPolicy> &exec,
                     InputIterator begin,
                     InputIterator end,
                     OutputType init,
@@ -117,7 +118,7 @@ template<typename DerivedPolicy,
   {
     typedef typename reduce_detail::body<InputIterator,OutputType,BinaryFunction> Body;
     Body reduce_body(begin, init, binary_op);
-    ::tbb::parallel_reduce(::tbb::blocked_range<Size>(0,n), reduce_body);
+    thrust::system::tbb::detail::parallel_reduce(exec, thrust::system::tbb::detail::make_blocked_range(exec, n), reduce_body);
     return binary_op(init, reduce_body.sum);
   }
 }
@@ -22,6 +22,7 @@
 #include <thrust/detail/seq.h>
 #include <thrust/system/tbb/detail/execution_policy.h>
 #include <thrust/system/tbb/detail/reduce_intervals.h>
+#include <thrust/system/tbb/detail/execution_config.h>
 #include <thrust/detail/minmax.h>
 #include <thrust/detail/temporary_array.h>
 #include <thrust/detail/range/tail_flags.h>
@@ -29,7 +30,6 @@
 #include <tbb/parallel_for.h>
 
 #include <cassert>
-#include <thread>
 
 
 THRUST_NAMESPACE_BEGIN
@@ -281,7 +281,7 @@ template<typename DerivedPolicy, typename Iterator1, typename Iterator2, typenam
   }
 
   // count the number of processors
-  const unsigned int p = thrust::max<unsigned int>(1u, std::thread::hardware_concurrency());
+  const unsigned int p = thrust::max<int>(1, thrust::system::tbb::detail::max_concurrency(exec));
 
   // generate O(P) intervals of sequential work
   // XXX oversubscribing is a tuning opportunity
@@ -309,9 +309,12 @@ template<typename DerivedPolicy, typename Iterator1, typename Iterator2, typenam
   thrust::detail::temporary_array<carry_type, DerivedPolicy> carries(0, exec, num_intervals - 1);
 
   // force grainsize == 1 with simple_partioner()
-  ::tbb::parallel_for(::tbb::blocked_range<difference_type>(0, num_intervals, 1),
-    reduce_by_key_detail::make_serial_reduce_by_key_body(keys_first, values_first, interval_output_offsets.begin(), keys_result, values_result, carries.begin(), n, interval_size, num_intervals, binary_pred, binary_op),
-    ::tbb::simple_partitioner());
+  thrust::system::tbb::detail::execute(exec, [&]
+  {
+    ::tbb::parallel_for(::tbb::blocked_range<difference_type>(0, num_intervals, 1),
+      reduce_by_key_detail::make_serial_reduce_by_key_body(keys_first, values_first, interval_output_offsets.begin(), keys_result, values_result, carries.begin(), n, interval_size, num_intervals, binary_pred, binary_op),
+      ::tbb::simple_partitioner());
+  });
 
   difference_type size_of_result = interval_output_offsets[num_intervals];
 
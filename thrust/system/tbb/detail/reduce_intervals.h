@@ -18,6 +18,7 @@
 
 #include <thrust/detail/config.h>
 #include <thrust/system/tbb/detail/execution_policy.h>
+#include <thrust/system/tbb/detail/execution_config.h>
 #include <thrust/detail/seq.h>
 
 #include <tbb/parallel_for.h>
@@ -89,7 +90,7 @@ template<typename RandomAccessIterator1, typename RandomAccessIterator2, typenam
 
 
 template<typename DerivedPolicy, typename RandomAccessIterator1, typename Size, typename RandomAccessIterator2, typename BinaryFunction>
-  void reduce_intervals(thrust::tbb::execution_policy<DerivedPolicy> &,
+  void reduce_intervals(thrust::tbb::execution_policy<DerivedPolicy> &exec,
                         RandomAccessIterator1 first,
                         RandomAccessIterator1 last,
                         Size interval_size,
@@ -100,7 +101,11 @@ template<typename DerivedPolicy, typename RandomAccessIterator1, typename Size,
 
   Size num_intervals = reduce_intervals_detail::divide_ri(n, interval_size);
 
-  ::tbb::parallel_for(::tbb::blocked_range<Size>(0, num_intervals, 1), reduce_intervals_detail::make_body(first, result, Size(n), interval_size, binary_op), ::tbb::simple_partitioner());
+  // one task per interval, whatever exec's grain size and partitioner
+  thrust::system::tbb::detail::execute(exec, [&]
+  {
+    ::tbb::parallel_for(::tbb::blocked_range<Size>(0, num_intervals, 1), reduce_intervals_detail::make_body(first, result, Size(n), interval_size, binary_op), ::tbb::simple_partitioner());
+  });
 }
 
 
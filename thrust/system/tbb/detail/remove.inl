@@ -19,6 +19,9 @@
 #include <thrust/detail/config.h>
 #include <thrust/system/tbb/detail/remove.h>
 #include <thrust/system/detail/generic/remove.h>
+#include <thrust/system/detail/internal/parallel_compact.h>
+#include <thrust/distance.h>
+#include <thrust/system/tbb/detail/execution_config.h>
 
 THRUST_NAMESPACE_BEGIN
 namespace system
@@ -27,6 +30,20 @@ namespace tbb
 {
 namespace detail
 {
+namespace remove_detail
+{
+
+
+// one tile per worker of exec's arena
+template<typename DerivedPolicy, typename Size>
+Size max_tiles(execution_policy<DerivedPolicy> &exec, Size)
+{
+  return static_cast<Size>(thrust::system::tbb::detail::max_concurrency(exec));
+}
+
+
+} // end namespace remove_detail
+
 
 template<typename DerivedPolicy,
          typename ForwardIterator,
@@ -36,8 +53,10 @@ template<typename DerivedPolicy,
                             ForwardIterator last,
                             Predicate pred)
 {
-  // tbb prefers generic::remove_if to cpp::remove_if
-  return thrust::system::detail::generic::remove_if(exec, first, last, pred);
+  // compact in place rather than through a copy of the input
+  return thrust::system::detail::internal::parallel_compact(exec, first, last,
+                                                            thrust::system::detail::internal::remove_if_op<Predicate>(pred),
+                                                            remove_detail::max_tiles(exec, thrust::distance(first, last)));
 }
 
 
@@ -51,8 +70,10 @@ template<typename DerivedPolicy,
                             InputIterator stencil,
                             Predicate pred)
 {
-  // tbb prefers generic::remove_if to cpp::remove_if
-  return thrust::system::detail::generic::remove_if(exec, first, last, stencil, pred);
+  // compact in place rather than through a copy of the input
+  return thrust::system::detail::internal::parallel_compact(exec, first, last,
+                                                            thrust::system::detail::internal::remove_if_stencil_op<InputIterator,Predicate>(stencil, pred),
+                                                            remove_detail::max_tiles(exec, thrust::distance(first, last)));
 }
 
 
@@ -18,6 +18,7 @@
 
 #include <thrust/detail/config.h>
 #include <thrust/system/tbb/detail/scan.h>
+#include <thrust/system/tbb/detail/execution_config.h>
 #include <thrust/distance.h>
 #include <thrust/advance.h>
 #include <thrust/iterator/iterator_traits.h>
@@ -192,10 +193,11 @@ struct exclusive_body
 
 } // end scan_detail
 
-template<typename InputIterator,
+template<typename DerivedPolicy,
+         typename InputIterator,
          typename OutputIterator,
          typename BinaryFunction>
-  OutputIterator inclusive_scan(tag,
+  OutputIterator inclusive_scan(execution_policy<DerivedPolicy> &exec,
                                 InputIterator first,
                                 InputIterator last,
                                 OutputIterator result,
@@ -213,7 +215,7 @@ template<typename InputIterator,
   {
     typedef typename scan_detail::inclusive_body<InputIterator,OutputIterator,BinaryFunction,ValueType> Body;
     Body scan_body(first, result, binary_op, *first);
-    ::tbb::parallel_scan(::tbb::blocked_range<Size>(0,n), scan_body);
+    thrust::system::tbb::detail::parallel_scan(exec, thrust::system::tbb::detail::make_blocked_range(exec, n), scan_body);
   }
 
   thrust::advance(result, n);
@@ -221,11 +223,12 @@ template<typename InputIterator,
   return result;
 }
 
-template<typename InputIterator,
+template<typename DerivedPolicy,
+         typename InputIterator,
          typename OutputIterator,
          typename InitialValueType,
          typename BinaryFunction>
-  OutputIterator exclusive_scan(tag,
+  OutputIterator exclusive_scan(execution_policy<DerivedPolicy> &exec,
                                 InputIterator first,
                                 InputIterator last,
                                 OutputIterator result,
@@ -244,7 +247,7 @@ template<typename InputIterator,
   {
     typedef typename scan_detail::exclusive_body<InputIterator,OutputIterator,BinaryFunction,ValueType> Body;
     Body scan_body(first, result, binary_op, init);
-    ::tbb::parallel_scan(::tbb::blocked_range<Size>(0,n), scan_body);
+    thrust::system::tbb::detail::parallel_scan(exec, thrust::system::tbb::detail::make_blocked_range(exec, n), scan_body);
   }
 
   thrust::advance(result, n);
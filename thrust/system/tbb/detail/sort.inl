@@ -1,5 +1,6 @@
 /*
  *  Copyright 2008-2013 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in compliance with the License.
@@ -24,6 +25,12 @@
 #include <thrust/merge.h>
 #include <thrust/sort.h>
 #include <thrust/detail/seq.h>
+#include <thrust/detail/type_traits.h>
+#include <thrust/functional.h>
+#include <thrust/system/detail/internal/parallel_radix_sort.h>
+#include <thrust/system/detail/internal/sort_columns_by_key.h>
+#include <thrust/system/detail/sequential/sort.h>
+#include <thrust/system/tbb/detail/execution_config.h>
 #include <tbb/parallel_invoke.h>
 
 THRUST_NAMESPACE_BEGIN
@@ -41,32 +48,68 @@ namespace sort_detail
 const static int threshold = 128 * 1024;
 
 
-template<typename DerivedPolicy, typename Iterator1, typename Iterator2, typename StrictWeakOrdering>
-void merge_sort(execution_policy<DerivedPolicy> &exec, Iterator1 first1, Iterator1 last1, Iterator2 first2, StrictWeakOrdering comp, bool inplace);
+// the sequential sorts of the leaves of the merge sorts below, the merges
+// above them are stable, so the result is stable if the leaves are sorted stably
+struct stable_sort_leaf
+{
+  template<typename RandomAccessIterator, typename StrictWeakOrdering>
+  void operator()(RandomAccessIterator first, RandomAccessIterator last, StrictWeakOrdering comp) const
+  {
+    thrust::stable_sort(thrust::seq, first, last, comp);
+  }
+
+  template<typename RandomAccessIterator1, typename RandomAccessIterator2, typename StrictWeakOrdering>
+  void operator()(RandomAccessIterator1 keys_first, RandomAccessIterator1 keys_last, RandomAccessIterator2 values_first, StrictWeakOrdering comp) const
+  {
+    thrust::stable_sort_by_key(thrust::seq, keys_first, keys_last, values_first, comp);
+  }
+};
 
 
-template<typename DerivedPolicy, typename Iterator1, typename Iterator2, typename StrictWeakOrdering>
+// sorts the leaves in place with the sequential unstable sort
+struct sort_leaf
+{
+  template<typename RandomAccessIterator, typename StrictWeakOrdering>
+  void operator()(RandomAccessIterator first, RandomAccessIterator last, StrictWeakOrdering comp) const
+  {
+    thrust::sort(thrust::seq, first, last, comp);
+  }
+
+  template<typename RandomAccessIterator1, typename RandomAccessIterator2, typename StrictWeakOrdering>
+  void operator()(RandomAccessIterator1 keys_first, RandomAccessIterator1 keys_last, RandomAccessIterator2 values_first, StrictWeakOrdering comp) const
+  {
+    thrust::sort_by_key(thrust::seq, keys_first, keys_last, values_first, comp);
+  }
+};
+
+
+template<typename DerivedPolicy, typename Iterator1, typename Iterator2, typename StrictWeakOrdering, typename LeafSort>
+void merge_sort(execution_policy<DerivedPolicy> &exec, Iterator1 first1, Iterator1 last1, Iterator2 first2, StrictWeakOrdering comp, LeafSort leaf_sort, bool inplace);
+
+
+template<typename DerivedPolicy, typename Iterator1, typename Iterator2, typename StrictWeakOrdering, typename LeafSort>
 struct merge_sort_closure
 {
   execution_policy<DerivedPolicy> &exec;
   Iterator1 first1, last1;
   Iterator2 first2;
   StrictWeakOrdering comp;
+  LeafSort leaf_sort;
   bool inplace;
 
-  merge_sort_closure(execution_policy<DerivedPolicy> &exec, Iterator1 first1, Iterator1 last1, Iterator2 first2, StrictWeakOrdering comp, bool inplace)
-    : exec(exec), first1(first1), last1(last1), first2(first2), comp(comp), inplace(inplace)
+  merge_sort_closure(execution_policy<DerivedPolicy> &exec, Iterator1 first1, Iterator1 last1, Iterator2 first2, StrictWeakOrdering comp, LeafSort leaf_sort, bool inplace)
+    : exec(exec), first1(first1), last1(last1), first2(first2), comp(comp), leaf_sort(leaf_sort), inplace(inplace)
   {}
 
   void operator()(void) const
   {
-    merge_sort(exec, first1, last1, first2, comp, inplace);
+    merge_sort(exec, first1, last1, first2, comp, leaf_sort, inplace);
   }
 };
 
 
-template<typename DerivedPolicy, typename Iterator1, typename Iterator2, typename StrictWeakOrdering>
-void merge_sort(execution_policy<DerivedPolicy> &exec, Iterator1 first1, Iterator1 last1, Iterator2 first2, StrictWeakOrdering comp, bool inplace)
+template<typename DerivedPolicy, typename Iterator1, typename Iterator2, typename StrictWeakOrdering, typename LeafSort>
+void merge_sort(execution_policy<DerivedPolicy> &exec, Iterator1 first1, Iterator1 last1, Iterator2 first2, StrictWeakOrdering comp, LeafSort leaf_sort, bool inplace)
 {
   typedef typename thrust::iterator_difference<Iterator1>::type difference_type;
 
@@ -74,7 +117,7 @@ void merge_sort(execution_policy<DerivedPolicy> &exec, Iterator1 first1, Iterato
 
   if (n < threshold)
   {
-    thrust::stable_sort(thrust::seq, first1, last1, comp);
+    leaf_sort(first1, last1, comp);
 
     if(!inplace)
     {
@@ -88,10 +131,10 @@ void merge_sort(execution_policy<DerivedPolicy> &exec, Iterator1 first1, Iterato
   Iterator2 mid2  = first2 + (n / 2);
   Iterator2 last2 = first2 + n;
 
-  typedef merge_sort_closure<DerivedPolicy,Iterator1,Iterator2,StrictWeakOrdering> Closure;
+  typedef merge_sort_closure<DerivedPolicy,Iterator1,Iterator2,StrictWeakOrdering,LeafSort> Closure;
 
-  Closure left (exec, first1, mid1,  first2, comp, !inplace);
-  Closure right(exec, mid1,   last1, mid2,   comp, !inplace);
+  Closure left (exec, first1, mid1,  first2, comp, leaf_sort, !inplace);
+  Closure right(exec, mid1,   last1, mid2,   comp, leaf_sort, !inplace);
 
   ::tbb::parallel_invoke(left, right);
 
@@ -116,7 +159,8 @@ template<typename DerivedPolicy,
          typename Iterator2,
          typename Iterator3,
          typename Iterator4,
-         typename StrictWeakOrdering>
+         typename StrictWeakOrdering,
+         typename LeafSort>
 void merge_sort_by_key(execution_policy<DerivedPolicy> &exec,
                        Iterator1 first1,
                        Iterator1 last1,
@@ -124,6 +168,7 @@ void merge_sort_by_key(execution_policy<DerivedPolicy> &exec,
                        Iterator3 first3,
                        Iterator4 first4,
                        StrictWeakOrdering comp,
+                       LeafSort leaf_sort,
                        bool inplace);
 
 
@@ -132,7 +177,8 @@ template<typename DerivedPolicy,
          typename Iterator2,
          typename Iterator3,
          typename Iterator4,
-         typename StrictWeakOrdering>
+         typename StrictWeakOrdering,
+         typename LeafSort>
 struct merge_sort_by_key_closure
 {
   execution_policy<DerivedPolicy> &exec;
@@ -141,6 +187,7 @@ struct merge_sort_by_key_closure
   Iterator3 first3;
   Iterator4 first4;
   StrictWeakOrdering comp;
+  LeafSort leaf_sort;
   bool inplace;
 
   merge_sort_by_key_closure(execution_policy<DerivedPolicy> &exec,
@@ -150,13 +197,14 @@ struct merge_sort_by_key_closure
                             Iterator3 first3,
                             Iterator4 first4,
                             StrictWeakOrdering comp,
+                            LeafSort leaf_sort,
                             bool inplace)
-    : exec(exec), first1(first1), last1(last1), first2(first2), first3(first3), first4(first4), comp(comp), inplace(inplace)
+    : exec(exec), first1(first1), last1(last1), first2(first2), first3(first3), first4(first4), comp(comp), leaf_sort(leaf_sort), inplace(inplace)
   {}
 
   void operator()(void) const
   {
-    merge_sort_by_key(exec, first1, last1, first2, first3, first4, comp, inplace);
+    merge_sort_by_key(exec, first1, last1, first2, first3, first4, comp, leaf_sort, inplace);
   }
 };
 
@@ -166,7 +214,8 @@ template<typename DerivedPolicy,
          typename Iterator2,
          typename Iterator3,
          typename Iterator4,
-         typename StrictWeakOrdering>
+         typename StrictWeakOrdering,
+         typename LeafSort>
 void merge_sort_by_key(execution_policy<DerivedPolicy> &exec,
                        Iterator1 first1,
                        Iterator1 last1,
@@ -174,6 +223,7 @@ void merge_sort_by_key(execution_policy<DerivedPolicy> &exec,
                        Iterator3 first3,
                        Iterator4 first4,
                        StrictWeakOrdering comp,
+                       LeafSort leaf_sort,
                        bool inplace)
 {
   typedef typename thrust::iterator_difference<Iterator1>::type difference_type;
@@ -189,7 +239,7 @@ void merge_sort_by_key(execution_policy<DerivedPolicy> &exec,
 
   if (n < threshold)
   {
-    thrust::stable_sort_by_key(thrust::seq, first1, last1, first2, comp);
+    leaf_sort(first1, last1, first2, comp);
 
     if(!inplace)
     {
@@ -200,10 +250,10 @@ void merge_sort_by_key(execution_policy<DerivedPolicy> &exec,
     return;
   }
 
-  typedef merge_sort_by_key_closure<DerivedPolicy,Iterator1,Iterator2,Iterator3,Iterator4,StrictWeakOrdering> Closure;
+  typedef merge_sort_by_key_closure<DerivedPolicy,Iterator1,Iterator2,Iterator3,Iterator4,StrictWeakOrdering,LeafSort> Closure;
 
-  Closure left (exec, first1, mid1,  first2, first3, first4, comp, !inplace);
-  Closure right(exec, mid1,   last1, mid2,   mid3,   mid4,   comp, !inplace);
+  Closure left (exec, first1, mid1,  first2, first3, first4, comp, leaf_sort, !inplace);
+  Closure right(exec, mid1,   last1, mid2,   mid3,   mid4,   comp, leaf_sort, !inplace);
 
   ::tbb::parallel_invoke(left, right);
 
@@ -221,19 +271,50 @@ void merge_sort_by_key(execution_policy<DerivedPolicy> &exec,
 } // end namespace sort_detail
 
 
+namespace sort_detail
+{
+
+
 template<typename DerivedPolicy,
          typename RandomAccessIterator,
          typename StrictWeakOrdering>
 void stable_sort(execution_policy<DerivedPolicy> &exec,
                  RandomAccessIterator first,
                  RandomAccessIterator last,
-                 StrictWeakOrdering comp)
+                 StrictWeakOrdering comp,
+                 thrust::detail::false_type)
 {
   typedef typename thrust::iterator_value<RandomAccessIterator>::type key_type;
 
   thrust::detail::temporary_array<key_type, DerivedPolicy> temp(exec, first, last);
 
-  sort_detail::merge_sort(exec, first, last, temp.begin(), comp, true);
+  sort_detail::merge_sort(exec, first, last, temp.begin(), comp, stable_sort_leaf(), true);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+void stable_sort(execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator first,
+                 RandomAccessIterator last,
+                 StrictWeakOrdering comp,
+                 thrust::detail::true_type)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type      key_type;
+  typedef typename thrust::iterator_difference<RandomAccessIterator>::type difference_type;
+
+  const difference_type num_tiles = thrust::system::tbb::detail::max_concurrency(exec);
+
+  if(last - first < threshold || num_tiles == 1)
+  {
+    thrust::stable_sort(thrust::seq, first, last, comp);
+    return;
+  }
+
+  const bool descending = thrust::detail::is_same<StrictWeakOrdering, thrust::greater<key_type> >::value;
+
+  thrust::system::detail::internal::parallel_radix_sort<descending>(exec, first, last, num_tiles);
 }
 
 
@@ -245,7 +326,8 @@ template<typename DerivedPolicy,
                           RandomAccessIterator1 first1,
                           RandomAccessIterator1 last1,
                           RandomAccessIterator2 first2,
-                          StrictWeakOrdering comp)
+                          StrictWeakOrdering comp,
+                          thrust::detail::false_type)
 {
   typedef typename thrust::iterator_value<RandomAccessIterator1>::type key_type;
   typedef typename thrust::iterator_value<RandomAccessIterator2>::type val_type;
@@ -255,7 +337,274 @@ template<typename DerivedPolicy,
   thrust::detail::temporary_array<key_type, DerivedPolicy> temp1(exec, first1, last1);
   thrust::detail::temporary_array<val_type, DerivedPolicy> temp2(exec, first2, last2);
 
-  sort_by_key_detail::merge_sort_by_key(exec, first1, last1, first2, temp1.begin(), temp2.begin(), comp, true);
+  sort_by_key_detail::merge_sort_by_key(exec, first1, last1, first2, temp1.begin(), temp2.begin(), comp, stable_sort_leaf(), true);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+  void stable_sort_by_key(execution_policy<DerivedPolicy> &exec,
+                          RandomAccessIterator1 first1,
+                          RandomAccessIterator1 last1,
+                          RandomAccessIterator2 first2,
+                          StrictWeakOrdering comp,
+                          thrust::detail::true_type)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator1>::type      key_type;
+  typedef typename thrust::iterator_difference<RandomAccessIterator1>::type difference_type;
+
+  const difference_type num_tiles = thrust::system::tbb::detail::max_concurrency(exec);
+
+  if(last1 - first1 < sort_by_key_detail::threshold || num_tiles == 1)
+  {
+    thrust::stable_sort_by_key(thrust::seq, first1, last1, first2, comp);
+    return;
+  }
+
+  const bool descending = thrust::detail::is_same<StrictWeakOrdering, thrust::greater<key_type> >::value;
+
+  thrust::system::detail::internal::parallel_radix_sort_by_key<descending>(exec, first1, last1, first2, num_tiles);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+void sort(execution_policy<DerivedPolicy> &exec,
+          RandomAccessIterator first,
+          RandomAccessIterator last,
+          StrictWeakOrdering comp,
+          thrust::detail::false_type)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type key_type;
+
+  // a single leaf is sorted in place, without the merge buffer
+  if(last - first < threshold)
+  {
+    thrust::sort(thrust::seq, first, last, comp);
+    return;
+  }
+
+  thrust::detail::temporary_array<key_type, DerivedPolicy> temp(exec, first, last);
+
+  sort_detail::merge_sort(exec, first, last, temp.begin(), comp, sort_leaf(), true);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+void sort(execution_policy<DerivedPolicy> &exec,
+          RandomAccessIterator first,
+          RandomAccessIterator last,
+          StrictWeakOrdering comp,
+          thrust::detail::true_type)
+{
+  sort_detail::stable_sort(exec, first, last, comp, thrust::detail::true_type());
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+  void sort_by_key(execution_policy<DerivedPolicy> &exec,
+                   RandomAccessIterator1 first1,
+                   RandomAccessIterator1 last1,
+                   RandomAccessIterator2 first2,
+                   StrictWeakOrdering comp,
+                   thrust::detail::false_type)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator1>::type key_type;
+  typedef typename thrust::iterator_value<RandomAccessIterator2>::type val_type;
+
+  // a single leaf is sorted in place, without the merge buffers
+  if(last1 - first1 < sort_by_key_detail::threshold)
+  {
+    thrust::sort_by_key(thrust::seq, first1, last1, first2, comp);
+    return;
+  }
+
+  RandomAccessIterator2 last2 = first2 + thrust::distance(first1, last1);
+
+  thrust::detail::temporary_array<key_type, DerivedPolicy> temp1(exec, first1, last1);
+  thrust::detail::temporary_array<val_type, DerivedPolicy> temp2(exec, first2, last2);
+
+  sort_by_key_detail::merge_sort_by_key(exec, first1, last1, first2, temp1.begin(), temp2.begin(), comp, sort_leaf(), true);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+  void sort_by_key(execution_policy<DerivedPolicy> &exec,
+                   RandomAccessIterator1 first1,
+                   RandomAccessIterator1 last1,
+                   RandomAccessIterator2 first2,
+                   StrictWeakOrdering comp,
+                   thrust::detail::true_type)
+{
+  sort_detail::stable_sort_by_key(exec, first1, last1, first2, comp, thrust::detail::true_type());
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+  void dispatch_stable_sort_by_key(execution_policy<DerivedPolicy> &exec,
+                                   RandomAccessIterator1 first1,
+                                   RandomAccessIterator1 last1,
+                                   RandomAccessIterator2 first2,
+                                   StrictWeakOrdering comp,
+                                   thrust::detail::false_type /* columns */)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator1>::type key_type;
+
+  // radix sort arithmetic keys compared with less or greater, merge sort everything else
+  thrust::system::detail::sequential::sort_detail::use_primitive_sort<key_type,StrictWeakOrdering> use_primitive_sort;
+
+  // the recursive merge sort spawns its tasks in exec's arena
+  thrust::system::tbb::detail::execute(exec, [&]
+  {
+    sort_detail::stable_sort_by_key(exec, first1, last1, first2, comp, use_primitive_sort);
+  });
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+  void dispatch_stable_sort_by_key(execution_policy<DerivedPolicy> &exec,
+                                   RandomAccessIterator1 first1,
+                                   RandomAccessIterator1 last1,
+                                   RandomAccessIterator2 first2,
+                                   StrictWeakOrdering comp,
+                                   thrust::detail::true_type /* columns */)
+{
+  thrust::system::detail::internal::sort_columns_by_key(exec, first1, last1, first2, comp, thrust::detail::true_type());
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+  void dispatch_sort_by_key(execution_policy<DerivedPolicy> &exec,
+                            RandomAccessIterator1 first1,
+                            RandomAccessIterator1 last1,
+                            RandomAccessIterator2 first2,
+                            StrictWeakOrdering comp,
+                            thrust::detail::false_type /* columns */)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator1>::type key_type;
+
+  // radix sort arithmetic keys compared with less or greater, merge leaves sorted with quicksort otherwise
+  thrust::system::detail::sequential::sort_detail::use_primitive_sort<key_type,StrictWeakOrdering> use_primitive_sort;
+
+  thrust::system::tbb::detail::execute(exec, [&]
+  {
+    sort_detail::sort_by_key(exec, first1, last1, first2, comp, use_primitive_sort);
+  });
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+  void dispatch_sort_by_key(execution_policy<DerivedPolicy> &exec,
+                            RandomAccessIterator1 first1,
+                            RandomAccessIterator1 last1,
+                            RandomAccessIterator2 first2,
+                            StrictWeakOrdering comp,
+                            thrust::detail::true_type /* columns */)
+{
+  thrust::system::detail::internal::sort_columns_by_key(exec, first1, last1, first2, comp, thrust::detail::false_type());
+}
+
+
+} // end namespace sort_detail
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+void sort(execution_policy<DerivedPolicy> &exec,
+          RandomAccessIterator first,
+          RandomAccessIterator last,
+          StrictWeakOrdering comp)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type key_type;
+
+  // radix sort arithmetic keys compared with less or greater, merge leaves sorted with quicksort otherwise
+  thrust::system::detail::sequential::sort_detail::use_primitive_sort<key_type,StrictWeakOrdering> use_primitive_sort;
+
+  thrust::system::tbb::detail::execute(exec, [&]
+  {
+    sort_detail::sort(exec, first, last, comp, use_primitive_sort);
+  });
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+  void sort_by_key(execution_policy<DerivedPolicy> &exec,
+                   RandomAccessIterator1 first1,
+                   RandomAccessIterator1 last1,
+                   RandomAccessIterator2 first2,
+                   StrictWeakOrdering comp)
+{
+  // values stored as columns, such as those of a soa_vector, are sorted through
+  // a sort of their indices, and gathered once
+  thrust::system::detail::internal::is_sort_by_key_columns<RandomAccessIterator2> columns;
+
+  sort_detail::dispatch_sort_by_key(exec, first1, last1, first2, comp, columns);
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator,
+         typename StrictWeakOrdering>
+void stable_sort(execution_policy<DerivedPolicy> &exec,
+                 RandomAccessIterator first,
+                 RandomAccessIterator last,
+                 StrictWeakOrdering comp)
+{
+  typedef typename thrust::iterator_value<RandomAccessIterator>::type key_type;
+
+  // radix sort arithmetic keys compared with less or greater, merge sort everything else
+  thrust::system::detail::sequential::sort_detail::use_primitive_sort<key_type,StrictWeakOrdering> use_primitive_sort;
+
+  // the recursive merge sort spawns its tasks in exec's arena
+  thrust::system::tbb::detail::execute(exec, [&]
+  {
+    sort_detail::stable_sort(exec, first, last, comp, use_primitive_sort);
+  });
+}
+
+
+template<typename DerivedPolicy,
+         typename RandomAccessIterator1,
+         typename RandomAccessIterator2,
+         typename StrictWeakOrdering>
+  void stable_sort_by_key(execution_policy<DerivedPolicy> &exec,
+                          RandomAccessIterator1 first1,
+                          RandomAccessIterator1 last1,
+                          RandomAccessIterator2 first2,
+                          StrictWeakOrdering comp)
+{
+  // values stored as columns, such as those of a soa_vector, are sorted through
+  // a sort of their indices, and gathered once
+  thrust::system::detail::internal::is_sort_by_key_columns<RandomAccessIterator2> columns;
+
+  sort_detail::dispatch_stable_sort_by_key(exec, first1, last1, first2, comp, columns);
 }
 
 
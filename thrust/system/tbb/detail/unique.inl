@@ -19,7 +19,10 @@
 #include <thrust/detail/config.h>
 #include <thrust/system/tbb/detail/unique.h>
 #include <thrust/system/detail/generic/unique.h>
+#include <thrust/system/detail/internal/parallel_compact.h>
+#include <thrust/distance.h>
 #include <thrust/pair.h>
+#include <thrust/system/tbb/detail/execution_config.h>
 
 THRUST_NAMESPACE_BEGIN
 namespace system
@@ -28,6 +31,19 @@ namespace tbb
 {
 namespace detail
 {
+namespace unique_detail
+{
+
+
+// one tile per worker of exec's arena
+template<typename DerivedPolicy, typename Size>
+Size max_tiles(execution_policy<DerivedPolicy> &exec, Size)
+{
+  return static_cast<Size>(thrust::system::tbb::detail::max_concurrency(exec));
+}
+
+
+} // end namespace unique_detail
 
 
 template<typename DerivedPolicy,
@@ -38,8 +54,9 @@ template<typename DerivedPolicy,
                          ForwardIterator last,
                          BinaryPredicate binary_pred)
 {
-  // tbb prefers generic::unique to cpp::unique
-  return thrust::system::detail::generic::unique(exec,first,last,binary_pred);
+  // compact in place rather than through a copy of the input
+  return thrust::system::detail::internal::parallel_unique(exec, first, last, binary_pred,
+                                                           unique_detail::max_tiles(exec, thrust::distance(first, last)));
 } // end unique()
 
 
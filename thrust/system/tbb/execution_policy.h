@@ -139,6 +139,25 @@ struct tag : thrust::system::tbb::execution_policy<tag> { unspecified };
  *
  *  // 0 1 2 is printed to standard output in some unspecified order
  *  \endcode
+ *
+ *  \p thrust::tbb::par may be tuned with modifiers, each of which returns a new policy and may be
+ *  chained, also after attaching an allocator with <tt>thrust::tbb::par(alloc)</tt>:
+ *
+ *  - <tt>.on(arena)</tt> runs the algorithm inside the \p tbb::task_arena \p arena, which must
+ *    outlive the call.
+ *  - <tt>.grain(size)</tt> sets the minimum number of elements per task. The grain size is capped
+ *    so that every worker of the arena still receives work.
+ *  - <tt>.partitioner(p)</tt> selects \p tbb::auto_partitioner (the default),
+ *    \p tbb::simple_partitioner, \p tbb::static_partitioner or a \p tbb::affinity_partitioner
+ *    owned by the caller. Scans support only the simple and auto partitioners and use the auto
+ *    partitioner otherwise.
+ *
+ *  \code
+ *  tbb::task_arena arena(4);
+ *
+ *  thrust::for_each(thrust::tbb::par.on(arena).grain(4096).partitioner(tbb::static_partitioner()),
+ *                   vec.begin(), vec.end(), printf_functor());
+ *  \endcode
  */
 static const unspecified par;
 
@@ -1,5 +1,6 @@
 /*
  *  Copyright 2008-2018 NVIDIA Corporation
+ *  Modifications Copyright© 2024 Advanced Micro Devices, Inc. All rights reserved.
  *
  *  Licensed under the Apache License, Version 2.0 (the "License");
  *  you may not use this file except in ctbbliance with the License.
@@ -100,3 +101,8 @@ using thrust::system::tbb::universal_allocator;
 THRUST_NAMESPACE_END
 
 #include <thrust/system/tbb/detail/memory.inl>
+
+// containers whose storage comes from the allocators above construct their
+// elements with this system's algorithms
+#include <thrust/system/tbb/detail/for_each.h>
+#include <thrust/system/tbb/detail/copy.h>